@@ -22,6 +22,7 @@ type_map = {
     "uchar": ["unsigned char", "unsigned char", 1, 1],
     "cstr": ["const char *", "const char *", 1, 8],
     "str": ["const std::string &", "std::string_view", 1, 8],
+    "vstr": ["std::string_view", "std::string_view", 4, 4],
 }
 
 # reference: https://en.cppreference.com/w/cpp/language/identifiers
@@ -37,12 +38,71 @@ IDENT_REGEX = re.compile("^[A-Za-z_\u00a8\u00aa\u00ad\u00af\u00b2-\u00b5\u00b7-\
 FIELD_REGEX = re.compile(
     r"^(?P<opt_open>optional\<)?(?P<id>[^\[\>]+)(\[(?P<len>\d+)\])?(?P<opt_close>\>)?$")
 
+RECORD_REGEX = re.compile(r"^(?P<name>[^:\s]+):(?P<options>(\s+\S+)*)$")
+
+KEY_REGEX = re.compile(r"^key:\s*(?P<fields>\S.*)$")
+
+RESOURCE_PARAM = "std::pmr::memory_resource *resource = std::pmr::get_default_resource()"
+
+# keywords allowed after the colon of a record header
+record_options = ["inline", "columns", "tracked"]
+
 
 class Record:
     def __init__(self):
         self.struct_name = ""
         self.comments = []
         self.fields = []
+        self.options = []
+        self.key_fields = []
+        self.buffer_size = 0
+
+    def fingerprint(self):
+        # 64-bit FNV-1a over each field's name, IDL type and offset, then the record size
+        text = "".join(
+            f"{field.field_name}:{field.idl_type}@{field.offset};" for field in self.fields)
+        text += f"size={self.buffer_size}"
+        value = 0xcbf29ce484222325
+        for byte in text.encode("utf-8"):
+            value ^= byte
+            value = (value * 0x100000001b3) & 0xffffffffffffffff
+        return value
+
+    def key_order(self):
+        keys = []
+        for field in self.key_fields:
+            if field.is_cstring or field.is_string:
+                keys.append(f"SeriStruct::StringKey<offset_{field.field_name}, {field.array_size}>")
+            elif field.is_vstr:
+                keys.append(f"SeriStruct::VarStringKey<offset_{field.field_name}>")
+            else:
+                keys.append(f"SeriStruct::ValueKey<{field.field_type}, offset_{field.field_name}>")
+        return f"SeriStruct::KeyOrder<{', '.join(keys)}>"
+
+    def is_inline(self):
+        return "inline" in self.options or all_inline
+
+    def has_columns(self):
+        return "columns" in self.options or all_columns
+
+    def is_tracked(self):
+        return "tracked" in self.options or all_tracked
+
+    def vstr_args(self):
+        # slot offsets of the vstr fields, as passed to Record
+        vstr_fields = self.vstr_fields()
+        return f"vstr_offsets, {len(vstr_fields)}" if vstr_fields else "nullptr, 0"
+
+    def columns_class(self):
+        return f"{self.struct_name}Columns"
+
+    def vstr_fields(self):
+        return [field for field in self.fields if field.is_vstr]
+
+    def base_class(self):
+        if self.is_inline():
+            return f"SeriStruct::InlineRecord<{self.buffer_size}>"
+        return "Record"
 
 
 class RecordField:
@@ -51,17 +111,21 @@ class RecordField:
         self.comments = []
         self.field_type = ""
         self.field_type_return = ""
+        self.idl_type = ""
+        self.offset = 0
         self.field_width = 0
         self.total_width = 0
         self.array_size = 0
         self.is_optional = False
         self.is_cstring = False
         self.is_string = False
+        self.is_vstr = False
         self.is_mutable = False
+        self.padding = 0
 
     def cpp_type(self, assign=False):
         output = ""
-        if self.is_cstring or self.is_string:
+        if self.is_cstring or self.is_string or self.is_vstr:
             if assign:
                 return self.field_type
             else:
@@ -86,17 +150,60 @@ class RecordField:
     def mutable(self):
         return self.is_mutable or all_mutable
 
+    def value_width(self):
+        if self.is_cstring or self.is_string:
+            # text bytes, the presence flag and padding are the same in every byte order
+            return "1"
+        if self.is_vstr:
+            return "sizeof(uint32_t)"
+        return f"sizeof({self.field_type})"
+
+    def value_count(self):
+        if self.is_cstring or self.is_string:
+            return self.total_width
+        if self.is_vstr:
+            # heap offset and length
+            return 2
+        return self.array_size if self.array_size else 1
+
+    def size_expr(self):
+        if self.is_cstring or self.is_string:
+            return str(self.total_width)
+        if self.is_vstr:
+            return "SeriStruct::vstr_slot_size"
+        return f"sizeof({self.cpp_type()})"
+
+    def kind_expr(self):
+        if self.is_cstring or self.is_string or self.is_vstr:
+            return "SeriStruct::ValueKind::other"
+        return f"SeriStruct::value_kind<{self.field_type}>()"
+
+    def getter_args(self):
+        if self.is_string:
+            # the stored length is clamped to the field, so a record read from elsewhere stays inside it
+            return f"offset_{self.field_name}, {self.array_size}"
+        return f"offset_{self.field_name}"
+
+    def column_type(self):
+        if self.is_cstring or self.is_string:
+            # strings are kept in their encoded form, one fixed-size slot per row
+            return f"std::array<unsigned char, {self.total_width}>"
+        return self.cpp_type()
+
 
 def help():
     print("Generates SeriStruct records from IDL\n")
     print(
-        "ssgen.py -i <inputfile> -o <outputdir> [--guard] [-n|--namespace <namespace>] [--ext <extension>] [-m|--mut]\n")
+        "ssgen.py -i <inputfile> -o <outputdir> [--guard] [-n|--namespace <namespace>] [--ext <extension>] [-m|--mut] [--inline] [--columns] [--tracked]\n")
     print("    inputfile    Input IDL file")
     print("    ouputdir     Path to put generated .hpp files")
     print("    --guard      Use DEFINE guard rather than pragma once")
     print("    namespace    A namespace for qualifying the generated records")
     print("    extension    The extension for generated header files (defaults to .gen.hpp)")
     print("    --mut        Make all fields mutable regardless of input")
+    print("    --inline     Store all records inline (no heap allocation) regardless of input")
+    print("    --columns    Generate a <Name>Columns struct-of-arrays class for all records regardless of input")
+    print("    --tracked    Track which fields are set and write patches for all records regardless of input")
 
 
 def error(msg):
@@ -120,6 +227,7 @@ def parse_field(field):
         if groups["id"] in type_map:
             record_field = RecordField()
             record_field.field_name = fields[0]
+            record_field.idl_type = fields[1]
             record_field.field_type = type_map[groups["id"]][0]
             record_field.field_type_return = type_map[groups["id"]][1]
 
@@ -128,8 +236,15 @@ def parse_field(field):
                 record_field.is_cstring = True
             elif groups["id"] == "str":
                 record_field.is_string = True
+            elif groups["id"] == "vstr":
+                record_field.is_vstr = True
             record_field.field_width = type_map[groups["id"]][2]
             record_field.total_width = record_field.field_width
+            if record_field.is_vstr:
+                if groups["len"] or groups["opt_open"]:
+                    return None
+                # slot of heap offset and length, aligned like uint32_t
+                record_field.total_width = 2 * record_field.field_width
 
             if len(fields) == 3 and fields[2] == "mut":
                 record_field.is_mutable = True
@@ -148,7 +263,7 @@ def parse_field(field):
                     # account for optional's internal alignment
                     record_field.total_width += record_field.field_width
                 elif record_field.is_cstring or record_field.is_string:
-                    # for NUL terminator and nullptr flag
+                    # for the header (presence flag and length) and NUL terminator
                     record_field.total_width += 9
                     # pointer alignment (alignof(char *))
                     record_field.field_width = type_map[groups["id"]][3]
@@ -168,13 +283,199 @@ def cpp_assign_buffer(fd, field, spaces=0):
     fd.write(");")
 
 
+def cpp_assign_vstr(fd, field, idl, spaces=0):
+    # setters lay out the heap again; constructors append to it in declaration order
+    fd.write("".rjust(spaces))
+    fd.write(
+        f"replace_vstr(offset_{field.field_name}, {field.field_name}, buffer_size, vstr_offsets, {len(idl.vstr_fields())});")
+
+
+def cpp_view_getter(fd, field, spaces=0):
+    fd.write("".rjust(spaces))
+    # values are returned by copy, since a viewed record need not be aligned
+    fd.write(f"inline {field.cpp_type()} ")
+    fd.write(f"{field.field_name}() const {{ return buffer_at")
+    if field.is_cstring:
+        fd.write("_cstr")
+    elif field.is_string:
+        fd.write("_str")
+    elif field.is_vstr:
+        fd.write("_vstr")
+    else:
+        fd.write(f"<{field.cpp_type()}>")
+    fd.write(f"({field.getter_args()}); }}\n")
+
+
+def compute_layout(record):
+    current_offset = 0
+    previous_field = None
+    for field in record.fields:
+        if previous_field is not None:
+            field.padding = (field.total_width - (current_offset %
+                                                  field.field_width)) % field.field_width
+            current_offset += field.padding
+        field.offset = current_offset
+        current_offset += field.total_width
+        previous_field = field
+    record.buffer_size = current_offset
+
+
 def cpp_prev_field_padding(fd, field):
     if field.is_cstring or field.is_string:
         fd.write(f"{field.total_width} /* max length, null flag, NUL term */")
+    elif field.is_vstr:
+        fd.write("SeriStruct::vstr_slot_size")
     else:
         fd.write(f"sizeof({field.cpp_type()})")
 
 
+def cpp_columns_class(fd, idl):
+    name = idl.struct_name
+    columns = idl.columns_class()
+    if idl.is_inline():
+        row_param = ""
+        row_args = ""
+    else:
+        row_param = f", {RESOURCE_PARAM}"
+        row_args = ", resource"
+
+    fd.write(f"""
+/**
+ * @brief Struct-of-arrays batch of {name}: each field is stored in its own contiguous,
+ * aligned SeriStruct::Column instead of being interleaved record by record.
+ */
+class {columns}
+{{
+public:
+    explicit {columns}({RESOURCE_PARAM})
+        : """)
+    fd.write(", ".join(f"{field.field_name}_column{{resource}}" for field in idl.fields))
+    fd.write(f""" {{}}
+
+    /**
+     * @brief Construct a new {columns} object from a batch of rows.
+     */
+    explicit {columns}(const SeriStruct::RecordArray<{name}> &rows, {RESOURCE_PARAM})
+        : {columns}{{resource}}
+    {{
+        reserve(rows.size());
+        for (auto row : rows)
+        {{
+            push_back(row);
+        }}
+    }}
+
+    /**
+     * @brief Returns the number of rows.
+     */
+    inline size_t size() const {{ return {idl.fields[0].field_name}_column.size(); }}
+
+    /**
+     * @brief Returns true if there are no rows.
+     */
+    inline bool empty() const {{ return size() == 0; }}
+
+    /**
+     * @brief Reserves space for at least \p count rows in every column.
+     */
+    void reserve(const size_t count)
+    {{
+""")
+    for field in idl.fields:
+        fd.write(f"        {field.field_name}_column.reserve(count);\n")
+    fd.write("""    }
+
+    /**
+     * @brief Removes all rows.
+     */
+    void clear()
+    {
+""")
+    for field in idl.fields:
+        fd.write(f"        {field.field_name}_column.clear();\n")
+    fd.write(f"""    }}
+
+    /**
+     * @brief Appends the fields of \p row to the end of each column.
+     */
+    inline void push_back(const {name} &row) {{ append(row.data()); }}
+
+    /**
+     * @brief Appends the fields of the viewed row to the end of each column.
+     */
+    inline void push_back(const {name}::View &row) {{ append(row.data()); }}
+
+    /**
+     * @brief Copies row \p index to \p buffer in the row layout of {name}, with zeroed padding.
+     * Make sure at least {name}::buffer_size bytes are available.
+     */
+    void copy_row_to(const size_t index, unsigned char *buffer) const
+    {{
+        std::memset(buffer, 0, {name}::buffer_size);
+""")
+    for field in idl.fields:
+        fd.write(
+            f"        std::memcpy(buffer + {name}::offset_{field.field_name}, &{field.field_name}_column[index], sizeof({field.column_type()}));\n")
+    fd.write(f"""    }}
+
+    /**
+     * @brief Returns row \p index as an owning {name}.
+     */
+    {name} row(const size_t index{row_param}) const
+    {{
+        unsigned char buffer[{name}::buffer_size];
+        copy_row_to(index, buffer);
+        return {name}{{buffer, {name}::buffer_size{row_args}}};
+    }}
+
+    /**
+     * @brief Appends every row to \p rows in the row layout.
+     */
+    void to_rows(SeriStruct::RecordArray<{name}> &rows) const
+    {{
+        const size_t first = rows.size();
+        rows.resize(first + size());
+        for (size_t i = 0; i < size(); i++)
+        {{
+            copy_row_to(i, rows.data() + (first + i) * {name}::buffer_size);
+        }}
+    }}
+
+""")
+    for field in idl.fields:
+        if len(field.comments):
+            fd.write("    /**\n")
+            for comment in field.comments:
+                fd.write(f"     * {comment}\n")
+            fd.write("     */\n")
+        column_type = f"SeriStruct::Column<{field.column_type()}>"
+        fd.write(
+            f"    inline const {column_type} &{field.field_name}() const {{ return {field.field_name}_column; }}\n")
+        if field.is_cstring:
+            fd.write(
+                f"    inline const char *{field.field_name}(const size_t index) const {{ return SeriStruct::string_field_cstr({field.field_name}_column[index].data()); }}\n")
+        elif field.is_string:
+            fd.write(
+                f"    inline std::string_view {field.field_name}(const size_t index) const {{ return SeriStruct::string_field_str({field.field_name}_column[index].data(), {field.array_size}); }}\n")
+        elif field.mutable():
+            fd.write(
+                f"    inline {column_type} &{field.field_name}() {{ return {field.field_name}_column; }}\n")
+
+    fd.write("""
+private:
+    void append(const unsigned char *row)
+    {
+""")
+    for field in idl.fields:
+        fd.write(
+            f"        {field.field_name}_column.push_back_bytes(row + {name}::offset_{field.field_name});\n")
+    fd.write("    }\n\n")
+    for field in idl.fields:
+        fd.write(
+            f"    SeriStruct::Column<{field.column_type()}> {field.field_name}_column;\n")
+    fd.write("};\n")
+
+
 # Parse arguments
 inputfile = ""
 outputdir = ""
@@ -182,10 +483,13 @@ guard = False
 namespace = ""
 hpp_ext = ".gen.hpp"
 all_mutable = False
+all_inline = False
+all_columns = False
+all_tracked = False
 
 try:
     opts, args = getopt.getopt(sys.argv[1:], "h?mi:o:n:", [
-                               "help", "mut", "guard", "namespace=", "ext="])
+                               "help", "mut", "inline", "columns", "tracked", "guard", "namespace=", "ext="])
 except getopt.GetoptError:
     help()
     sys.exit(2)
@@ -195,6 +499,12 @@ for opt, arg in opts:
         sys.exit(0)
     elif opt in ("-m", "--mut"):
         all_mutable = True
+    elif opt == "--inline":
+        all_inline = True
+    elif opt == "--columns":
+        all_columns = True
+    elif opt == "--tracked":
+        all_tracked = True
     elif opt == "-i":
         inputfile = arg
     elif opt == "-o":
@@ -241,14 +551,22 @@ try:
                 line = line.rstrip()
                 if line[0] == '"' and line[-1] == '"':
                     comments.append(line[1:-1])
-                elif line[-1] == ':':
+                elif RECORD_REGEX.match(line):
+                    record_matches = RECORD_REGEX.match(line)
                     record = Record()
-                    record.struct_name = line[:-1]
+                    record.struct_name = record_matches.group("name")
                     if not is_valid_cpp_identifier(record.struct_name):
                         error(
                             f"Invalid identifier {record.struct_name} in {inputfile} at {line_no}")
+                    record.options = record_matches.group("options").split()
+                    for option in record.options:
+                        if option not in record_options:
+                            error(
+                                f"Unknown record option {option} in {inputfile} at line {line_no}")
                     record.comments = comments.copy()
                     comments.clear()
+                    key_names = []
+                    key_line = line_no
                     for line in fd:
                         line_no += 1
                         if line.isspace():
@@ -259,6 +577,12 @@ try:
                         line = line.strip()
                         if line[0] == '"' and line[-1] == '"':
                             comments.append(line[1:-1])
+                        elif KEY_REGEX.match(line):
+                            if key_names:
+                                error(
+                                    f"Duplicate key in {inputfile} at line {line_no}")
+                            key_names = [name.strip() for name in KEY_REGEX.match(line).group("fields").split(",")]
+                            key_line = line_no
                         else:
                             field = parse_field(line.strip())
                             if field is None:
@@ -276,6 +600,20 @@ try:
                     if len(record.fields) == 0:
                         error(
                             f"Record {record.struct_name} in {inputfile} at line {line_no} has no fields")
+                    fields_by_name = {field.field_name: field for field in record.fields}
+                    for name in key_names:
+                        field = fields_by_name.get(name)
+                        if field is None or field in record.key_fields:
+                            error(
+                                f"Unknown or repeated key field {name} in {inputfile} at line {key_line}")
+                        if field.is_optional or (field.array_size and not (field.is_cstring or field.is_string)):
+                            error(
+                                f"Key field {name} in {inputfile} at line {key_line} must be a single value or a string")
+                        record.key_fields.append(field)
+                    if record.vstr_fields() and (record.is_inline() or record.has_columns()):
+                        error(
+                            f"Record {record.struct_name} in {inputfile} at line {line_no} has vstr fields, which need a heap allocated buffer")
+                    compute_layout(record)
                     parsed_idl.append(record)
                 else:
                     error(f"Syntax error in {inputfile} at line {line_no}")
@@ -297,7 +635,14 @@ for idl in parsed_idl:
                     f"#define SERISTRUCT_RECORD_{idl.struct_name.upper()}_HPP\n\n")
             else:
                 fd.write("#pragma once\n")
-            fd.write("#include <SeriStruct.hpp>\n\n")
+            fd.write("#include <SeriStruct.hpp>\n")
+            fd.write("#include <RecordHash.hpp>\n")
+            if idl.key_fields:
+                fd.write("#include <RecordKey.hpp>\n")
+            if idl.has_columns():
+                fd.write("#include <RecordArray.hpp>\n")
+                fd.write("#include <RecordColumns.hpp>\n")
+            fd.write("\n")
 
             if namespace:
                 fd.write(f"namespace {namespace}\n{{\n")
@@ -308,7 +653,7 @@ for idl in parsed_idl:
                 for comment in idl.comments:
                     fd.write(f" * {comment}\n")
                 fd.write(" */\n")
-            fd.write(f"""class {idl.struct_name} : public Record
+            fd.write(f"""class {idl.struct_name} : public {idl.base_class()}
 {{
 public:
     {idl.struct_name}(""")
@@ -317,31 +662,59 @@ public:
                 if idx > 0:
                     fd.write(", ")
                 fd.write(f"{field.cpp_type(assign=True)} {field.field_name}")
-            fd.write(")\n        : Record{}\n    {\n")
-            fd.write("        alloc(buffer_size);\n")
+            if idl.is_inline():
+                fd.write(f")\n        : {idl.base_class()}{{}}\n    {{\n")
+            else:
+                fd.write(f", {RESOURCE_PARAM})\n        : Record{{resource}}\n    {{\n")
+            vstr_fields = idl.vstr_fields()
+            if vstr_fields:
+                heap_sizes = " + ".join(f"{field.field_name}.size()" for field in vstr_fields)
+                fd.write(f"        alloc(buffer_size + {heap_sizes});\n")
+                fd.write("        size_t heap_offset = buffer_size;\n")
+            else:
+                fd.write("        alloc(buffer_size);\n")
             for field in idl.fields:
-                cpp_assign_buffer(fd, field, spaces=8)
+                if field.is_vstr:
+                    fd.write("        ")
+                    if field is not vstr_fields[-1]:
+                        fd.write("heap_offset = ")
+                    fd.write(f"assign_vstr(offset_{field.field_name}, {field.field_name}, heap_offset);")
+                else:
+                    cpp_assign_buffer(fd, field, spaces=8)
                 fd.write("\n")
             fd.write("    }\n")
 
             # Write remaining boilerplate constructors
-            fd.write(f"""    {idl.struct_name}(std::istream &istr, const size_t read_size) : Record{{istr, read_size, buffer_size}} {{}}
-    {idl.struct_name}(const unsigned char *buffer, const size_t buffer_size) : Record{{buffer, buffer_size, {idl.struct_name}::buffer_size}} {{}}
-    {idl.struct_name}(const {idl.struct_name} &other) : Record{{other}} {{}}
-    {idl.struct_name}({idl.struct_name} &&other) noexcept : Record{{std::move(other)}} {{}}
+            base = idl.base_class()
+            # bytes read from outside must not point the vstr getters outside the record
+            check_vstr = f" SeriStruct::check_vstr_slots(data(), size(), {idl.struct_name}::buffer_size, {idl.vstr_args()}); " if vstr_fields else ""
+            # copies and moves keep the dirty fields of a tracked record
+            copy_dirty = ", dirty{other.dirty}" if idl.is_tracked() else ""
+            assign_dirty = "\n        dirty = other.dirty;" if idl.is_tracked() else ""
+            if idl.is_inline():
+                fd.write(f"""    {idl.struct_name}(std::istream &istr, const size_t read_size) : {base}{{istr, read_size, buffer_size}} {{}}
+    {idl.struct_name}(const unsigned char *buffer, const size_t buffer_size) : {base}{{buffer, buffer_size, {idl.struct_name}::buffer_size}} {{}}
+    {idl.struct_name}(const {idl.struct_name} &other) : {base}{{other}}{copy_dirty} {{}}\n""")
+            else:
+                fd.write(f"""    {idl.struct_name}(std::istream &istr, const size_t read_size, {RESOURCE_PARAM})
+        : Record{{istr, read_size, buffer_size, resource}} {{{check_vstr}}}
+    {idl.struct_name}(const unsigned char *buffer, const size_t buffer_size, {RESOURCE_PARAM})
+        : Record{{buffer, buffer_size, {idl.struct_name}::buffer_size, resource}} {{{check_vstr}}}
+    {idl.struct_name}(const {idl.struct_name} &other, {RESOURCE_PARAM}) : Record{{other, resource}}{copy_dirty} {{}}\n""")
+            fd.write(f"""    {idl.struct_name}({idl.struct_name} &&other) noexcept : {base}{{std::move(other)}}{copy_dirty} {{}}
     ~{idl.struct_name}() noexcept {{}}
     {idl.struct_name} &operator=(const {idl.struct_name} &other)
     {{
-        Record::operator=(other);
+        Record::operator=(other);{assign_dirty}
         return *this;
     }}
     {idl.struct_name}& operator=({idl.struct_name}&& other) noexcept {{
-        Record::operator=(std::move(other));
+        Record::operator=(std::move(other));{assign_dirty}
         return *this;
     }}\n\n""")
 
             # Write field getters and setters
-            for field in idl.fields:
+            for (index, field) in enumerate(idl.fields):
                 if len(field.comments):
                     fd.write("    /**\n")
                     for comment in field.comments:
@@ -349,16 +722,18 @@ public:
                     fd.write("     */\n")
                 fd.write(
                     f"    inline {field.cpp_type()} ")
-                if not field.is_string and not field.is_cstring:
+                if not field.is_string and not field.is_cstring and not field.is_vstr:
                     fd.write("& ")
                 fd.write(f"{field.field_name}() const {{ return buffer_at")
                 if field.is_cstring:
                     fd.write("_cstr")
                 elif field.is_string:
                     fd.write("_str")
+                elif field.is_vstr:
+                    fd.write("_vstr")
                 else:
                     fd.write(f"<{field.cpp_type()}>")
-                fd.write(f"(offset_{field.field_name}); }}\n")
+                fd.write(f"({field.getter_args()}); }}\n")
 
                 if field.mutable():
                     if len(field.comments):
@@ -368,12 +743,93 @@ public:
                             fd.write(f"     * {comment}\n")
                         fd.write("     */\n")
                     fd.write(f"    inline void {field.field_name}({field.cpp_type(assign=True)} {field.field_name}) {{ ")
-                    cpp_assign_buffer(fd, field)
+                    if field.is_vstr:
+                        cpp_assign_vstr(fd, field, idl)
+                    else:
+                        cpp_assign_buffer(fd, field)
+                    if idl.is_tracked():
+                        fd.write(f" dirty.set({index});")
                     fd.write(" }\n")
 
+            # Write zero-copy view
+            fd.write(f"""
+    /**
+     * @brief Non-owning, read-only view of a {idl.struct_name} stored in a caller-owned buffer.
+     */
+    class View : public SeriStruct::RecordView
+    {{
+    public:
+        View(const unsigned char *buffer, const size_t buffer_size) : RecordView{{buffer, buffer_size, {idl.struct_name}::buffer_size}} {{{check_vstr}}}
+
+""")
+            for field in idl.fields:
+                cpp_view_getter(fd, field, spaces=8)
+            fd.write("""
+        inline bool operator==(const View &other) const { return SeriStruct::equal_bytes(*this, other); }
+        inline bool operator!=(const View &other) const { return !(*this == other); }
+""")
+            if idl.key_fields:
+                fd.write("        inline bool operator<(const View &other) const { return key_order::less(data(), other.data()); }\n")
+            fd.write(f"""    }};
+
+    /**
+     * @brief Returns a View over this record's internal buffer. The view is invalidated if
+     * this record is reassigned or destroyed.
+     */
+    inline View view() const {{ return View{{data(), size()}}; }}
+
+    /**
+     * @brief Records are equal when their bytes are, which is when every field holds the same value.
+     * Floating point fields compare by bits, so -0.0 differs from 0.0 and NaNs with the same bits are equal.
+     */
+    inline bool operator==(const {idl.struct_name} &other) const {{ return SeriStruct::equal_bytes(*this, other); }}
+    inline bool operator!=(const {idl.struct_name} &other) const {{ return !(*this == other); }}
+""")
+            if idl.key_fields:
+                key_names = ", ".join(field.field_name for field in idl.key_fields)
+                fd.write(f"""
+    /**
+     * @brief Orders records by their key: {key_names}. Floating point fields order as sort_bits() maps them.
+     */
+    inline bool operator<(const {idl.struct_name} &other) const {{ return key_order::less(data(), other.data()); }}
+""")
+            if idl.is_tracked():
+                field_count = len(idl.fields)
+                fd.write(f"""
+    /**
+     * @brief Returns the fields set since construction or the last clear_dirty(), by index in field_info.
+     */
+    inline const std::bitset<{field_count}> &dirty_fields() const {{ return dirty; }}
+
+    /**
+     * @brief Marks every field as clean, such as after sending a patch.
+     */
+    inline void clear_dirty() {{ dirty.reset(); }}
+
+    /**
+     * @brief Appends a patch with the current value of every dirty field to \\p patch.
+     * @return size_t is the number of bytes appended
+     */
+    inline size_t write_patch(std::vector<unsigned char> &patch) const
+    {{
+        return Record::write_patch(fingerprint, field_info, dirty, {idl.vstr_args()}, patch);
+    }}
+
+    /**
+     * @brief Applies a patch written by write_patch() on another {idl.struct_name}. Fields set by the
+     * patch are not marked dirty.
+     * @return size_t is the size of the patch in bytes
+     */
+    inline size_t apply_patch(const unsigned char *patch, const size_t size)
+    {{
+        return Record::apply_patch(fingerprint, field_info, {field_count}, buffer_size, {idl.vstr_args()}, patch, size);
+    }}
+""")
+
             fd.write("\nprivate:\n")
-            # Calculate offsets and write private fields
-            current_offset = 0
+            if idl.has_columns():
+                fd.write(f"    friend class {idl.columns_class()};\n\n")
+            # Write offsets as private fields
             previous_field = None
             for field in idl.fields:
                 fd.write(
@@ -381,25 +837,73 @@ public:
                 if previous_field is None:
                     fd.write("0")
                 else:
-                    padding = (field.total_width - (current_offset %
-                                                    field.field_width)) % field.field_width
-                    if padding:
-                        current_offset += padding
-                        fd.write(f"{padding} /* padding */ + ")
+                    if field.padding:
+                        fd.write(f"{field.padding} /* padding */ + ")
                     fd.write(f"offset_{previous_field.field_name} + ")
                     cpp_prev_field_padding(fd, previous_field)
                 fd.write(";\n")
-                current_offset += field.total_width
                 previous_field = field
+            if vstr_fields:
+                fd.write("    static constexpr size_t vstr_offsets[] = {")
+                fd.write(", ".join(f"offset_{field.field_name}" for field in vstr_fields))
+                fd.write("};\n")
+            if idl.is_tracked():
+                fd.write(f"\n    std::bitset<{len(idl.fields)}> dirty;\n")
+            fd.write("\npublic:\n")
+            fd.write("    /**\n     * @brief Size of the record layout in bytes\n     */\n")
             fd.write(
                 f"    static constexpr size_t buffer_size = offset_{previous_field.field_name} + ")
             cpp_prev_field_padding(fd, previous_field)
             fd.write(";\n")
+            fd.write("    /**\n     * @brief False if the text of vstr fields follows the fixed layout, so records vary in size\n     */\n")
+            fd.write(f"    static constexpr bool has_fixed_size = {'false' if vstr_fields else 'true'};\n")
+            if idl.is_inline():
+                fd.write(
+                    f"    static_assert(buffer_size == {idl.buffer_size}, \"Inline storage does not match record layout\");\n")
+            fd.write("    /**\n     * @brief Identifies the layout: a hash of each field's name, type and offset\n     */\n")
+            fd.write(f"    static constexpr uint64_t fingerprint = 0x{idl.fingerprint():016x}ull;\n")
+            fd.write("    /**\n     * @brief Offset, value width, value count, size and value kind of each field, in declaration order\n     */\n")
+            fd.write("    static constexpr SeriStruct::FieldInfo field_info[] = {\n")
+            for field in idl.fields:
+                string_flag = "true" if field.is_cstring or field.is_string else "false"
+                fd.write(
+                    f"        {{\"{field.field_name}\", offset_{field.field_name}, {field.value_width()}, {field.value_count()}, {string_flag}, {field.size_expr()}, {field.kind_expr()}}},\n")
+            fd.write("    };\n")
+            if idl.key_fields:
+                key_names = ", ".join(field.field_name for field in idl.key_fields)
+                fd.write(f"""    /**
+     * @brief Order of the key fields {key_names}, compiled for their types
+     */
+    using key_order = {idl.key_order()};
+    /**
+     * @brief Function object ordering records and views by key_order
+     */
+    using key_less = SeriStruct::KeyLess<key_order>;
+""")
 
             # Write close of class
             fd.write("};\n")
+
+            if idl.has_columns():
+                cpp_columns_class(fd, idl)
             if namespace:
                 fd.write(f"}} /* {namespace} */\n")
+
+            # Records and views hash their bytes, which are the same for equal records
+            qualified = f"{namespace}::{idl.struct_name}" if namespace else idl.struct_name
+            fd.write(f"""
+namespace std
+{{
+template <>
+struct hash<{qualified}> : SeriStruct::RecordHasher
+{{
+}};
+template <>
+struct hash<{qualified}::View> : SeriStruct::RecordHasher
+{{
+}};
+}} // namespace std
+""")
             if guard:
                 fd.write("\n#endif\n")
     except IOError as e:
@@ -0,0 +1,558 @@
+#include "AsyncIo.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <deque>
+#include <fcntl.h>
+#include <mutex>
+#include <new>
+#include <sys/stat.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define SERISTRUCT_IO_URING
+#include <cstring>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace SeriStruct
+{
+    namespace
+    {
+        [[noreturn]] void throw_errno(const std::string &what)
+        {
+            throw std::system_error{errno, std::generic_category(), what};
+        }
+    } // namespace
+
+    // One transfer handed to a backend, which reports its result against the slot
+    struct AsyncTransfer
+    {
+        int fd;
+        unsigned char *buffer;
+        size_t size;
+        uint64_t offset;
+        bool is_write;
+    };
+
+    // A source of asynchronous transfers
+    class AsyncEngine
+    {
+    public:
+        virtual ~AsyncEngine() = default;
+        virtual AsyncIo::Backend backend() const = 0;
+        // Starts a transfer that reap() reports for slot. If it throws, the transfer was not started and slot is free.
+        virtual void submit(const size_t slot, const AsyncTransfer &transfer) = 0;
+        // Appends (slot, result) pairs of finished transfers, waiting for at least one if block is set
+        virtual void reap(const bool block, std::vector<std::pair<size_t, int64_t>> &finished) = 0;
+    };
+
+    struct AsyncIo::Request
+    {
+        AsyncTransfer transfer;
+        size_t done;
+        uint64_t tag;
+        Callback callback;
+    };
+
+    struct AsyncIo::Ready
+    {
+        Completion completion;
+        Callback callback;
+    };
+
+    namespace
+    {
+        // Blocking pread/pwrite calls on a pool of threads
+        class ThreadEngine : public AsyncEngine
+        {
+        public:
+            explicit ThreadEngine(const size_t threads) : stopping{false}
+            {
+                for (size_t i = 0; i < std::max<size_t>(threads, 1); i++)
+                {
+                    workers.emplace_back([this] { work(); });
+                }
+            }
+
+            ~ThreadEngine() override
+            {
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    stopping = true;
+                }
+                work_ready.notify_all();
+                for (auto &worker : workers)
+                {
+                    worker.join();
+                }
+            }
+
+            AsyncIo::Backend backend() const override { return AsyncIo::Backend::threads; }
+
+            void submit(const size_t slot, const AsyncTransfer &transfer) override
+            {
+                {
+                    std::lock_guard<std::mutex> lock{mutex};
+                    queue.emplace_back(slot, transfer);
+                }
+                work_ready.notify_one();
+            }
+
+            void reap(const bool block, std::vector<std::pair<size_t, int64_t>> &finished) override
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                if (block)
+                {
+                    done_ready.wait(lock, [this] { return !done.empty(); });
+                }
+                finished.insert(finished.end(), done.begin(), done.end());
+                done.clear();
+            }
+
+        private:
+            std::mutex mutex;
+            std::condition_variable work_ready;
+            std::condition_variable done_ready;
+            std::deque<std::pair<size_t, AsyncTransfer>> queue;
+            std::vector<std::pair<size_t, int64_t>> done;
+            std::vector<std::thread> workers;
+            bool stopping;
+
+            static int64_t transfer_all(const AsyncTransfer &transfer)
+            {
+                size_t total = 0;
+                while (total < transfer.size)
+                {
+                    const off_t offset = static_cast<off_t>(transfer.offset + total);
+                    const ssize_t result = transfer.is_write
+                                               ? ::pwrite(transfer.fd, transfer.buffer + total, transfer.size - total, offset)
+                                               : ::pread(transfer.fd, transfer.buffer + total, transfer.size - total, offset);
+                    if (result < 0)
+                    {
+                        if (errno == EINTR)
+                        {
+                            continue;
+                        }
+                        return -errno;
+                    }
+                    if (result == 0)
+                    {
+                        break;
+                    }
+                    total += static_cast<size_t>(result);
+                }
+                return static_cast<int64_t>(total);
+            }
+
+            void work()
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                while (true)
+                {
+                    work_ready.wait(lock, [this] { return stopping || !queue.empty(); });
+                    if (queue.empty())
+                    {
+                        return;
+                    }
+                    const auto item = queue.front();
+                    queue.pop_front();
+                    lock.unlock();
+                    const int64_t result = transfer_all(item.second);
+                    lock.lock();
+                    done.emplace_back(item.first, result);
+                    done_ready.notify_one();
+                }
+            }
+        };
+
+#if defined(SERISTRUCT_IO_URING)
+        // io_uring driven through the raw system calls, so no library is needed
+        class UringEngine : public AsyncEngine
+        {
+        public:
+            explicit UringEngine(const unsigned entries)
+            {
+                io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+                ring_fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+                if (ring_fd < 0)
+                {
+                    throw_errno("Cannot set up io_uring");
+                }
+                if (!supports_read_write())
+                {
+                    ::close(ring_fd);
+                    throw std::system_error{ENOSYS, std::generic_category(), "io_uring cannot read or write files"};
+                }
+
+                sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+                cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+                if (single_mmap)
+                {
+                    sq_size = cq_size = std::max(sq_size, cq_size);
+                }
+                sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+
+                sq_ring = map(sq_size, IORING_OFF_SQ_RING);
+                cq_ring = single_mmap ? sq_ring : map(cq_size, IORING_OFF_CQ_RING);
+                sqes = static_cast<io_uring_sqe *>(map(sqes_size, IORING_OFF_SQES));
+
+                auto sq = static_cast<unsigned char *>(sq_ring);
+                sq_head = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+                sq_tail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+                sq_mask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+                sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+                auto cq = static_cast<unsigned char *>(cq_ring);
+                cq_head = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+                cq_tail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+                cq_mask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+                cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+            }
+
+            ~UringEngine() override
+            {
+                unmap();
+                ::close(ring_fd);
+            }
+
+            AsyncIo::Backend backend() const override { return AsyncIo::Backend::io_uring; }
+
+            void submit(const size_t slot, const AsyncTransfer &transfer) override
+            {
+                // the engine never has more transfers in flight than submission entries
+                const unsigned tail = *sq_tail;
+                const unsigned index = tail & sq_mask;
+                io_uring_sqe &sqe = sqes[index];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = transfer.is_write ? IORING_OP_WRITE : IORING_OP_READ;
+                sqe.fd = transfer.fd;
+                sqe.addr = reinterpret_cast<uint64_t>(transfer.buffer);
+                sqe.len = static_cast<uint32_t>(std::min<size_t>(transfer.size, 1u << 30));
+                sqe.off = transfer.offset;
+                sqe.user_data = slot;
+                sq_array[index] = index;
+                __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+                try
+                {
+                    enter(1, 0, 0);
+                }
+                catch (...)
+                {
+                    // the kernel only reads the ring when entered, so an entry it did not consume is withdrawn
+                    // before the slot is reused. One it did consume completes through reap() as usual.
+                    if (__atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == tail)
+                    {
+                        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+                        throw;
+                    }
+                }
+            }
+
+            void reap(const bool block, std::vector<std::pair<size_t, int64_t>> &finished) override
+            {
+                unsigned head = *cq_head;
+                if (block && head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+                {
+                    enter(0, 1, IORING_ENTER_GETEVENTS);
+                }
+                const unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+                for (; head != tail; head++)
+                {
+                    const io_uring_cqe &cqe = cqes[head & cq_mask];
+                    finished.emplace_back(static_cast<size_t>(cqe.user_data), cqe.res);
+                }
+                __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+            }
+
+        private:
+            int ring_fd;
+            void *sq_ring = MAP_FAILED;
+            void *cq_ring = MAP_FAILED;
+            io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+            size_t sq_size;
+            size_t cq_size;
+            size_t sqes_size;
+            unsigned *sq_head;
+            unsigned *sq_tail;
+            unsigned sq_mask;
+            unsigned *sq_array;
+            unsigned *cq_head;
+            unsigned *cq_tail;
+            unsigned cq_mask;
+            io_uring_cqe *cqes;
+
+            // Kernels before 5.6 set up a ring but fail every IORING_OP_READ and IORING_OP_WRITE, and also
+            // predate IORING_REGISTER_PROBE, so a failed probe means the ring is of no use
+            bool supports_read_write() const
+            {
+                constexpr unsigned op_count = std::max(IORING_OP_READ, IORING_OP_WRITE) + 1;
+                std::vector<unsigned char> bytes(sizeof(io_uring_probe) + op_count * sizeof(io_uring_probe_op), 0);
+                auto probe = reinterpret_cast<io_uring_probe *>(bytes.data());
+                if (::syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe, op_count) < 0)
+                {
+                    return false;
+                }
+                const auto supported = [probe](const unsigned op) {
+                    return op <= probe->last_op && op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+                };
+                return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+            }
+
+            void *map(const size_t size, const off_t offset)
+            {
+                void *address = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, offset);
+                if (address == MAP_FAILED)
+                {
+                    const int error = errno;
+                    unmap();
+                    ::close(ring_fd);
+                    throw std::system_error{error, std::generic_category(), "Cannot map io_uring"};
+                }
+                return address;
+            }
+
+            void unmap()
+            {
+                if (sqes != MAP_FAILED)
+                {
+                    ::munmap(sqes, sqes_size);
+                }
+                if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+                {
+                    ::munmap(cq_ring, cq_size);
+                }
+                if (sq_ring != MAP_FAILED)
+                {
+                    ::munmap(sq_ring, sq_size);
+                }
+            }
+
+            void enter(const unsigned to_submit, const unsigned min_complete, const unsigned flags)
+            {
+                while (::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0) < 0)
+                {
+                    if (errno != EINTR)
+                    {
+                        throw_errno("Cannot enter io_uring");
+                    }
+                }
+            }
+        };
+#endif
+    } // namespace
+
+    AsyncIo::AsyncIo() : AsyncIo{Options{}} {}
+
+    AsyncIo::AsyncIo(const Options &options) : depth{std::max<size_t>(options.queue_depth, 1)}
+    {
+#if defined(SERISTRUCT_IO_URING)
+        if (options.backend != Backend::threads)
+        {
+            try
+            {
+                engine.reset(new UringEngine{static_cast<unsigned>(depth)});
+            }
+            catch (const std::system_error &)
+            {
+                if (options.backend == Backend::io_uring)
+                {
+                    throw;
+                }
+            }
+        }
+#else
+        if (options.backend == Backend::io_uring)
+        {
+            throw std::system_error{ENOSYS, std::generic_category(), "io_uring is not available"};
+        }
+#endif
+        if (!engine)
+        {
+            engine.reset(new ThreadEngine{options.threads});
+        }
+        requests.resize(depth);
+        free_slots.reserve(depth);
+        for (size_t slot = depth; slot > 0; slot--)
+        {
+            free_slots.push_back(slot - 1);
+        }
+    }
+
+    AsyncIo::~AsyncIo() noexcept
+    {
+        // the kernel or a worker may still be using the buffers
+        try
+        {
+            while (in_flight())
+            {
+                collect(true);
+            }
+        }
+        catch (...)
+        {
+        }
+    }
+
+    AsyncIo::Backend AsyncIo::backend() const
+    {
+        return engine->backend();
+    }
+
+    size_t AsyncIo::pending() const
+    {
+        return in_flight() + ready.size();
+    }
+
+    void AsyncIo::read(const int fd, void *buffer, const size_t size, const uint64_t offset,
+                       const uint64_t tag, Callback callback)
+    {
+        submit(fd, static_cast<unsigned char *>(buffer), size, offset, false, tag, std::move(callback));
+    }
+
+    void AsyncIo::write(const int fd, const void *buffer, const size_t size, const uint64_t offset,
+                        const uint64_t tag, Callback callback)
+    {
+        // the buffer is only read from
+        submit(fd, static_cast<unsigned char *>(const_cast<void *>(buffer)), size, offset, true, tag, std::move(callback));
+    }
+
+    size_t AsyncIo::poll(const size_t min_complete, std::vector<Completion> *completed)
+    {
+        size_t delivered = 0;
+        collect(false);
+        while (true)
+        {
+            // callbacks may submit new requests, which must not disturb the list being delivered
+            std::vector<Ready> batch;
+            batch.swap(ready);
+            for (auto &item : batch)
+            {
+                if (item.callback)
+                {
+                    item.callback(item.completion);
+                }
+                if (completed)
+                {
+                    completed->push_back(item.completion);
+                }
+                delivered++;
+            }
+            if (!ready.empty())
+            {
+                continue;
+            }
+            if (delivered >= min_complete || in_flight() == 0)
+            {
+                return delivered;
+            }
+            collect(true);
+        }
+    }
+
+    void AsyncIo::submit(const int fd, unsigned char *buffer, const size_t size, const uint64_t offset,
+                         const bool is_write, const uint64_t tag, Callback callback)
+    {
+        while (free_slots.empty())
+        {
+            collect(true);
+        }
+        const size_t slot = free_slots.back();
+        Request &request = requests[slot];
+        request.transfer = AsyncTransfer{fd, buffer, size, offset, is_write};
+        request.done = 0;
+        request.tag = tag;
+        request.callback = std::move(callback);
+        free_slots.pop_back();
+        if (size == 0)
+        {
+            ready.push_back(Ready{Completion{tag, 0}, std::move(request.callback)});
+            free_slots.push_back(slot);
+            return;
+        }
+        try
+        {
+            engine->submit(slot, request.transfer);
+        }
+        catch (...)
+        {
+            request.callback = nullptr;
+            free_slots.push_back(slot);
+            throw;
+        }
+    }
+
+    void AsyncIo::collect(const bool block)
+    {
+        std::vector<std::pair<size_t, int64_t>> finished;
+        engine->reap(block, finished);
+        for (const auto &item : finished)
+        {
+            const size_t slot = item.first;
+            int64_t result = item.second;
+            Request &request = requests[slot];
+            if (result > 0)
+            {
+                // continue a partial transfer where it stopped
+                request.done += static_cast<size_t>(result);
+                request.transfer.buffer += result;
+                request.transfer.size -= static_cast<size_t>(result);
+                request.transfer.offset += static_cast<uint64_t>(result);
+            }
+            if (result == -EINTR || result == -EAGAIN || (result > 0 && request.transfer.size))
+            {
+                // a request that cannot be resubmitted finishes with the error, so no reaped slot is lost
+                try
+                {
+                    engine->submit(slot, request.transfer);
+                    continue;
+                }
+                catch (const std::system_error &error)
+                {
+                    result = -error.code().value();
+                }
+                catch (const std::bad_alloc &)
+                {
+                    result = -ENOMEM;
+                }
+            }
+            const int64_t outcome = result < 0 ? result : static_cast<int64_t>(request.done);
+            ready.push_back(Ready{Completion{request.tag, outcome}, std::move(request.callback)});
+            request.callback = nullptr;
+            free_slots.push_back(slot);
+        }
+    }
+
+    AsyncFile::AsyncFile(const std::string &path, const Mode mode, AsyncIo &io)
+        : io{io}, append_offset{0}
+    {
+        const int flags = mode == Mode::read ? O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC;
+        fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            throw_errno("Cannot open " + path);
+        }
+    }
+
+    AsyncFile::~AsyncFile() noexcept
+    {
+        ::close(fd);
+    }
+
+    uint64_t AsyncFile::size_bytes() const
+    {
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            throw_errno("Cannot read file size");
+        }
+        return static_cast<uint64_t>(status.st_size);
+    }
+
+} // namespace SeriStruct
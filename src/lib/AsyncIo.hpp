@@ -0,0 +1,290 @@
+#pragma once
+#include "RecordArray.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SeriStruct
+{
+    class AsyncEngine;
+
+    /**
+     * @brief Asynchronous positional reads and writes with several requests in flight at once.
+     * Requests are submitted to io_uring where the kernel supports it, or otherwise handed to a
+     * pool of threads doing blocking pread/pwrite calls.
+     *
+     * Each request transfers the whole buffer unless an error occurs or a read reaches the end of
+     * the file; partial transfers are resubmitted internally. Finished requests are delivered by
+     * poll(), on the calling thread, both to the request's callback (if any) and to the optional
+     * output list. Buffers must stay valid and untouched until their request is delivered.
+     *
+     * An AsyncIo object is not thread safe. Errors setting up the backend are reported as
+     * std::system_error; errors of individual requests are reported in Completion::result.
+     */
+    class AsyncIo
+    {
+    public:
+        enum class Backend
+        {
+            /** io_uring if available, else threads */
+            automatic,
+            io_uring,
+            threads
+        };
+
+        struct Options
+        {
+            /** Maximum number of requests in flight */
+            size_t queue_depth = 32;
+            /** Which backend to use */
+            Backend backend = Backend::automatic;
+            /** Number of worker threads of the thread backend */
+            size_t threads = 4;
+        };
+
+        /**
+         * @brief A finished request.
+         */
+        struct Completion
+        {
+            /** The tag given when the request was submitted */
+            uint64_t tag;
+            /** Number of bytes transferred, or a negative errno value */
+            int64_t result;
+        };
+
+        using Callback = std::function<void(const Completion &)>;
+
+        /**
+         * @brief Construct a new AsyncIo object with default options
+         */
+        AsyncIo();
+
+        /**
+         * @brief Construct a new AsyncIo object
+         *
+         * @param options configures the queue depth and backend
+         *
+         * @exception std::system_error if the requested backend cannot be set up
+         */
+        explicit AsyncIo(const Options &options);
+        AsyncIo(const AsyncIo &) = delete;
+        AsyncIo &operator=(const AsyncIo &) = delete;
+
+        /**
+         * @brief Destroy the AsyncIo object after waiting for requests in flight. Their callbacks are not called.
+         */
+        ~AsyncIo() noexcept;
+
+        /**
+         * @brief Returns the backend in use, either Backend::io_uring or Backend::threads.
+         *
+         * @return Backend
+         */
+        Backend backend() const;
+
+        /**
+         * @brief Returns the maximum number of requests in flight.
+         *
+         * @return size_t
+         */
+        inline size_t queue_depth() const { return depth; }
+
+        /**
+         * @brief Returns the number of requests submitted but not yet delivered by poll().
+         *
+         * @return size_t
+         */
+        size_t pending() const;
+
+        /**
+         * @brief Submits a read of \p size bytes at \p offset of \p fd into \p buffer. If
+         * queue_depth() requests are already in flight, waits for one of them to finish first.
+         *
+         * @param fd is an open file descriptor
+         * @param buffer receives the bytes
+         * @param size is the number of bytes to read
+         * @param offset is the position in the file
+         * @param tag identifies the request in its Completion
+         * @param callback is called by poll() once the request has finished
+         */
+        void read(const int fd, void *buffer, const size_t size, const uint64_t offset,
+                  const uint64_t tag = 0, Callback callback = nullptr);
+
+        /**
+         * @brief Submits a write of \p size bytes from \p buffer at \p offset of \p fd. If
+         * queue_depth() requests are already in flight, waits for one of them to finish first.
+         *
+         * @param fd is an open file descriptor
+         * @param buffer holds the bytes
+         * @param size is the number of bytes to write
+         * @param offset is the position in the file
+         * @param tag identifies the request in its Completion
+         * @param callback is called by poll() once the request has finished
+         */
+        void write(const int fd, const void *buffer, const size_t size, const uint64_t offset,
+                   const uint64_t tag = 0, Callback callback = nullptr);
+
+        /**
+         * @brief Delivers finished requests, waiting until at least \p min_complete have been
+         * delivered or none are pending.
+         *
+         * @param min_complete is the number of requests to wait for
+         * @param completed receives each delivered request, if not null
+         * @return size_t is the number of requests delivered
+         */
+        size_t poll(const size_t min_complete = 0, std::vector<Completion> *completed = nullptr);
+
+        /**
+         * @brief Waits for and delivers every pending request.
+         *
+         * @param completed receives each delivered request, if not null
+         * @return size_t is the number of requests delivered
+         */
+        inline size_t wait_all(std::vector<Completion> *completed = nullptr) { return poll(pending(), completed); }
+
+    private:
+        struct Request;
+        struct Ready;
+
+        size_t depth;
+        std::unique_ptr<AsyncEngine> engine;
+        std::vector<Request> requests;
+        std::vector<size_t> free_slots;
+        std::vector<Ready> ready;
+
+        void submit(const int fd, unsigned char *buffer, const size_t size, const uint64_t offset,
+                    const bool is_write, const uint64_t tag, Callback callback);
+        void collect(const bool block);
+        inline size_t in_flight() const { return depth - free_slots.size(); }
+    };
+
+    /**
+     * @brief A file descriptor opened for asynchronous reads or writes of record batches.
+     */
+    class AsyncFile
+    {
+    public:
+        enum class Mode
+        {
+            /** Open an existing file for reading */
+            read,
+            /** Create or truncate a file for writing */
+            write
+        };
+
+        /**
+         * @brief Construct a new AsyncFile object by opening \p path.
+         *
+         * @param path is the path of the file
+         * @param mode is how to open the file
+         * @param io is the AsyncIo that will carry the requests, which must outlive this object
+         *
+         * @exception std::system_error if the file cannot be opened
+         */
+        AsyncFile(const std::string &path, const Mode mode, AsyncIo &io);
+        AsyncFile(const AsyncFile &) = delete;
+        AsyncFile &operator=(const AsyncFile &) = delete;
+
+        /**
+         * @brief Destroy the AsyncFile object, closing the file. Requests for the file must have been delivered.
+         */
+        ~AsyncFile() noexcept;
+
+        /**
+         * @brief Returns the current size of the file in bytes.
+         *
+         * @return uint64_t
+         *
+         * @exception std::system_error if the size cannot be read
+         */
+        uint64_t size_bytes() const;
+
+    protected:
+        AsyncIo &io;
+        int fd;
+        uint64_t append_offset;
+    };
+
+    /**
+     * @brief Reads and writes whole RecordArray batches of one generated type asynchronously. A
+     * batch must not be touched until its request has been delivered by AsyncIo::poll().
+     *
+     * @tparam T is a generated record type
+     */
+    template <typename T>
+    class AsyncRecordFile : public AsyncFile
+    {
+    public:
+        using AsyncFile::AsyncFile;
+
+        /**
+         * @brief Distance in bytes between consecutive records
+         */
+        static constexpr size_t stride = T::buffer_size;
+
+        /**
+         * @brief Returns the number of whole records in the file.
+         *
+         * @return uint64_t
+         */
+        inline uint64_t size() const { return size_bytes() / stride; }
+
+        /**
+         * @brief Submits a read of up to \p count records starting at record \p first into \p batch.
+         * When the request is delivered \p batch holds the records that were read, which is fewer
+         * than \p count at the end of the file.
+         *
+         * @param batch receives the records
+         * @param first is the index of the first record to read
+         * @param count is the number of records to read
+         * @param tag identifies the request in its Completion
+         * @param callback is called by AsyncIo::poll() once \p batch is filled
+         */
+        void read(RecordArray<T> &batch, const uint64_t first, const size_t count,
+                  const uint64_t tag = 0, AsyncIo::Callback callback = nullptr)
+        {
+            batch.resize(count);
+            io.read(fd, batch.data(), batch.size_bytes(), first * stride, tag,
+                    [&batch, callback = std::move(callback)](const AsyncIo::Completion &completion) {
+                        batch.resize(completion.result > 0 ? static_cast<size_t>(completion.result) / stride : 0);
+                        if (callback)
+                        {
+                            callback(completion);
+                        }
+                    });
+        }
+
+        /**
+         * @brief Submits a write of \p batch starting at record \p first.
+         *
+         * @param batch holds the records
+         * @param first is the index of the first record to write
+         * @param tag identifies the request in its Completion
+         * @param callback is called by AsyncIo::poll() once the batch is written
+         */
+        void write(const RecordArray<T> &batch, const uint64_t first,
+                   const uint64_t tag = 0, AsyncIo::Callback callback = nullptr)
+        {
+            io.write(fd, batch.data(), batch.size_bytes(), first * stride, tag, std::move(callback));
+        }
+
+        /**
+         * @brief Submits a write of \p batch after the batches previously appended through this object.
+         *
+         * @param batch holds the records
+         * @param tag identifies the request in its Completion
+         * @param callback is called by AsyncIo::poll() once the batch is written
+         */
+        void append(const RecordArray<T> &batch, const uint64_t tag = 0, AsyncIo::Callback callback = nullptr)
+        {
+            const uint64_t offset = append_offset;
+            append_offset += batch.size_bytes();
+            io.write(fd, batch.data(), batch.size_bytes(), offset, tag, std::move(callback));
+        }
+    };
+
+} // namespace SeriStruct
@@ -0,0 +1,110 @@
+#include "ByteOrder.hpp"
+#include "KernelsDetail.hpp"
+#include <algorithm>
+
+namespace SeriStruct
+{
+    ByteOrderPlan::ByteOrderPlan(const FieldInfo *fields, const size_t field_count, const size_t record_size)
+        : stride{record_size}, vectorizable{true}
+    {
+        const size_t padded = (stride + 31) / 32 * 32;
+        masks.resize(padded);
+        for (size_t i = 0; i < padded; i++)
+        {
+            masks[i] = static_cast<unsigned char>(i % 16);
+        }
+        std::vector<bool> swapped(padded / 16);
+
+        for (size_t f = 0; f < field_count; f++)
+        {
+            const FieldInfo &field = fields[f];
+            if (field.offset + field.width * field.count > stride)
+            {
+                throw invalid_size{};
+            }
+            if (field.width <= 1 || field.count == 0)
+            {
+                continue;
+            }
+            runs.push_back(Run{field.offset, field.width, field.count});
+            for (size_t value = 0; value < field.count; value++)
+            {
+                const size_t first = field.offset + value * field.width;
+                const size_t last = first + field.width - 1;
+                if (first / 16 != last / 16)
+                {
+                    vectorizable = false;
+                    continue;
+                }
+                for (size_t b = 0; b < field.width; b++)
+                {
+                    masks[first + b] = static_cast<unsigned char>((last - b) % 16);
+                }
+                swapped[first / 16] = true;
+            }
+        }
+
+        // merge adjacent values of the same width so the scalar path loops over fewer runs
+        std::sort(runs.begin(), runs.end(), [](const Run &a, const Run &b) { return a.offset < b.offset; });
+        std::vector<Run> merged;
+        for (const auto &run : runs)
+        {
+            if (!merged.empty() && merged.back().width == run.width &&
+                merged.back().offset + merged.back().width * merged.back().count == run.offset)
+            {
+                merged.back().count += run.count;
+            }
+            else
+            {
+                merged.push_back(run);
+            }
+        }
+        runs.swap(merged);
+
+        for (size_t chunk = 0; chunk < swapped.size(); chunk++)
+        {
+            if (swapped[chunk])
+            {
+                chunks.push_back(static_cast<uint32_t>(chunk));
+                if (blocks.empty() || blocks.back() != chunk / 2)
+                {
+                    blocks.push_back(static_cast<uint32_t>(chunk / 2));
+                }
+            }
+        }
+    }
+
+    void ByteOrderPlan::swap(unsigned char *records, const size_t count) const
+    {
+        if (runs.empty())
+        {
+            return;
+        }
+#if defined(SERISTRUCT_X86_KERNELS)
+        if (vectorizable)
+        {
+            switch (simd_level())
+            {
+            case SimdLevel::avx2:
+                return detail::swap_chunks_avx2(records, count, stride, masks.data(), blocks.data(), blocks.size());
+            case SimdLevel::sse42:
+                return detail::swap_chunks_sse42(records, count, stride, masks.data(), chunks.data(), chunks.size());
+            default:
+                break;
+            }
+        }
+#endif
+        for (size_t r = 0; r < count; r++, records += stride)
+        {
+            for (const auto &run : runs)
+            {
+                unsigned char *value = records + run.offset;
+                for (size_t v = 0; v < run.count; v++, value += run.width)
+                {
+                    std::reverse(value, value + run.width);
+                }
+            }
+        }
+    }
+
+} // namespace SeriStruct
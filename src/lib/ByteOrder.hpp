@@ -0,0 +1,173 @@
+#pragma once
+#include "RecordArray.hpp"
+#include "SeriStruct.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief True if the host stores multi-byte values most significant byte first.
+     */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    constexpr bool host_is_big_endian = true;
+#else
+    constexpr bool host_is_big_endian = false;
+#endif
+
+    /**
+     * @brief Reverses the bytes of every multi-byte value in a run of records of one layout,
+     * converting between host and big-endian (network) byte order on little-endian hosts.
+     *
+     * The field layout is compiled once into a shuffle mask per 16 bytes of the record, so a batch is
+     * converted with one byte shuffle per 16 (SSE4.2) or 32 (AVX2) bytes that hold multi-byte values.
+     * Bytes of strings, bools, chars and padding are left untouched.
+     */
+    class ByteOrderPlan
+    {
+    public:
+        /**
+         * @brief Construct a new ByteOrderPlan object
+         *
+         * @param fields describes the fields of the record
+         * @param field_count is the number of fields
+         * @param record_size is the distance in bytes between consecutive records
+         *
+         * @exception SeriStruct::invalid_size if a field does not fit within \p record_size
+         */
+        ByteOrderPlan(const FieldInfo *fields, const size_t field_count, const size_t record_size);
+
+        /**
+         * @brief Construct a new ByteOrderPlan object from a generated record's field_info array
+         *
+         * @param fields describes the fields of the record
+         * @param record_size is the distance in bytes between consecutive records
+         */
+        template <size_t N>
+        ByteOrderPlan(const FieldInfo (&fields)[N], const size_t record_size) : ByteOrderPlan{fields, N, record_size} {}
+
+        /**
+         * @brief Reverses the bytes of every multi-byte value in \p count records stored back to back.
+         *
+         * @param records is the first byte of the first record
+         * @param count is the number of records
+         */
+        void swap(unsigned char *records, const size_t count) const;
+
+        /**
+         * @brief Returns the distance in bytes between consecutive records.
+         *
+         * @return size_t
+         */
+        inline size_t record_size() const { return stride; }
+
+    private:
+        struct Run
+        {
+            size_t offset;
+            size_t width;
+            size_t count;
+        };
+
+        size_t stride;
+        // adjacent values of the same width, used by the scalar path
+        std::vector<Run> runs;
+        // false if a value straddles a 16 byte boundary, which the shuffle masks cannot express
+        bool vectorizable;
+        // for each byte of the record, the index within its 16 byte chunk of the byte moved there
+        std::vector<unsigned char> masks;
+        // 16 and 32 byte chunks of the record that hold multi-byte values
+        std::vector<uint32_t> chunks;
+        std::vector<uint32_t> blocks;
+    };
+
+    /**
+     * @brief Returns the ByteOrderPlan of a generated record type, built on first use.
+     *
+     * @tparam T is a generated record type
+     * @return const ByteOrderPlan&
+     */
+    template <typename T>
+    const ByteOrderPlan &byte_order_plan()
+    {
+        static_assert(T::has_fixed_size, "Records with vstr fields vary in size");
+        static const ByteOrderPlan plan{T::field_info, T::buffer_size};
+        return plan;
+    }
+
+    /**
+     * @brief Writes \p record to \p buffer with every multi-byte value in big-endian byte order.
+     *
+     * @tparam T is a generated record type
+     * @param record is the record to convert
+     * @param buffer is the destination buffer, which must hold at least T::buffer_size bytes
+     */
+    template <typename T>
+    void to_big_endian(const T &record, unsigned char *buffer)
+    {
+        std::memcpy(buffer, record.data(), T::buffer_size);
+        if constexpr (!host_is_big_endian)
+        {
+            byte_order_plan<T>().swap(buffer, 1);
+        }
+    }
+
+    /**
+     * @brief Reads a record whose multi-byte values are in big-endian byte order.
+     *
+     * @tparam T is a generated record type
+     * @param buffer holds the record as written by to_big_endian()
+     * @param buffer_size is the number of bytes available in \p buffer
+     * @return T
+     *
+     * @exception SeriStruct::invalid_size if \p buffer_size < T::buffer_size
+     */
+    template <typename T>
+    T from_big_endian(const unsigned char *buffer, const size_t buffer_size)
+    {
+        if (buffer_size < T::buffer_size)
+        {
+            throw invalid_size{};
+        }
+        std::array<unsigned char, T::buffer_size> converted;
+        std::memcpy(converted.data(), buffer, T::buffer_size);
+        if constexpr (!host_is_big_endian)
+        {
+            byte_order_plan<T>().swap(converted.data(), 1);
+        }
+        return T{converted.data(), converted.size()};
+    }
+
+    /**
+     * @brief Converts every record in \p records from host to big-endian byte order in place. The
+     * records must not be read through views until they are converted back with from_big_endian().
+     *
+     * @tparam T is a generated record type
+     * @param records is the batch of records to convert
+     */
+    template <typename T>
+    void to_big_endian(RecordArray<T> &records)
+    {
+        if constexpr (!host_is_big_endian)
+        {
+            byte_order_plan<T>().swap(records.data(), records.size());
+        }
+    }
+
+    /**
+     * @brief Converts every record in \p records from big-endian to host byte order in place.
+     *
+     * @tparam T is a generated record type
+     * @param records is the batch of records to convert
+     */
+    template <typename T>
+    void from_big_endian(RecordArray<T> &records)
+    {
+        // reversing bytes is its own inverse
+        to_big_endian(records);
+    }
+
+} // namespace SeriStruct
@@ -0,0 +1,192 @@
+#include "CompactEncoding.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        // Presence byte and little-endian length in front of the text of an encoded string
+        constexpr size_t compact_string_header = 5;
+
+        void put_length(unsigned char *bytes, const size_t length)
+        {
+            bytes[0] = static_cast<unsigned char>(length);
+            bytes[1] = static_cast<unsigned char>(length >> 8);
+            bytes[2] = static_cast<unsigned char>(length >> 16);
+            bytes[3] = static_cast<unsigned char>(length >> 24);
+        }
+
+        size_t get_length(const unsigned char *bytes)
+        {
+            return static_cast<size_t>(bytes[0]) | static_cast<size_t>(bytes[1]) << 8 |
+                   static_cast<size_t>(bytes[2]) << 16 | static_cast<size_t>(bytes[3]) << 24;
+        }
+
+        // Checks a decoded string header against the capacity of its field
+        size_t checked_length(const unsigned char *header, const size_t capacity)
+        {
+            const size_t length = get_length(header + 1);
+            if (length > capacity || (!header[0] && length))
+            {
+                throw invalid_size{};
+            }
+            return length;
+        }
+
+        // Writes the presence flag and length of a string field, leaving its text alone
+        void store_string_header(unsigned char *field, const unsigned char *header, const size_t length)
+        {
+            const bool is_present = header[0] != 0;
+            std::memset(field, 0, string_header_size);
+            std::memcpy(field, &is_present, sizeof(bool));
+            put_length(field + string_length_offset, length);
+        }
+    } // namespace
+
+    CompactLayout::CompactLayout(const FieldInfo *fields, const size_t field_count, const size_t record_size)
+        : max_size{0}
+    {
+        std::vector<FieldInfo> strings;
+        for (size_t f = 0; f < field_count; f++)
+        {
+            if (fields[f].offset + fields[f].width * fields[f].count > record_size)
+            {
+                throw invalid_size{};
+            }
+            if (fields[f].is_string)
+            {
+                if (fields[f].count < string_header_size + 1)
+                {
+                    throw invalid_size{};
+                }
+                strings.push_back(fields[f]);
+            }
+        }
+        std::sort(strings.begin(), strings.end(), [](const FieldInfo &a, const FieldInfo &b) { return a.offset < b.offset; });
+
+        // everything between strings, padding included, is copied in one piece
+        size_t cursor = 0;
+        for (const auto &field : strings)
+        {
+            if (field.offset > cursor)
+            {
+                segments.push_back(Segment{cursor, field.offset - cursor, 0, false});
+                max_size += field.offset - cursor;
+            }
+            const size_t capacity = field.count - string_header_size - 1;
+            segments.push_back(Segment{field.offset, field.count, capacity, true});
+            max_size += compact_string_header + capacity;
+            cursor = field.offset + field.count;
+        }
+        if (record_size > cursor)
+        {
+            segments.push_back(Segment{cursor, record_size - cursor, 0, false});
+            max_size += record_size - cursor;
+        }
+    }
+
+    size_t CompactLayout::encode(const unsigned char *record, std::vector<unsigned char> &out) const
+    {
+        const size_t start = out.size();
+        for (const auto &segment : segments)
+        {
+            const unsigned char *bytes = record + segment.offset;
+            if (!segment.is_string)
+            {
+                out.insert(out.end(), bytes, bytes + segment.size);
+                continue;
+            }
+            const std::string_view text = string_field_str(bytes, segment.capacity);
+            const size_t length = std::min(text.size(), segment.capacity);
+            unsigned char header[compact_string_header];
+            header[0] = string_field_cstr(bytes) != nullptr;
+            put_length(header + 1, length);
+            out.insert(out.end(), header, header + sizeof(header));
+            out.insert(out.end(), text.data(), text.data() + length);
+        }
+        return out.size() - start;
+    }
+
+    size_t CompactLayout::decode(const unsigned char *bytes, const size_t size, unsigned char *record) const
+    {
+        size_t offset = 0;
+        for (const auto &segment : segments)
+        {
+            if (!segment.is_string)
+            {
+                if (size - offset < segment.size)
+                {
+                    throw not_enough_data{};
+                }
+                std::memcpy(record + segment.offset, bytes + offset, segment.size);
+                offset += segment.size;
+                continue;
+            }
+            if (size - offset < compact_string_header)
+            {
+                throw not_enough_data{};
+            }
+            const unsigned char *header = bytes + offset;
+            const size_t length = checked_length(header, segment.capacity);
+            offset += compact_string_header;
+            if (size - offset < length)
+            {
+                throw not_enough_data{};
+            }
+            unsigned char *field = record + segment.offset;
+            store_string_header(field, header, length);
+            std::memcpy(field + string_header_size, bytes + offset, length);
+            std::memset(field + string_header_size + length, 0, segment.size - string_header_size - length);
+            offset += length;
+        }
+        return offset;
+    }
+
+    void CompactLayout::write(std::ostream &ostr, const unsigned char *record) const
+    {
+        for (const auto &segment : segments)
+        {
+            const unsigned char *bytes = record + segment.offset;
+            if (!segment.is_string)
+            {
+                ostr.write(reinterpret_cast<const char *>(bytes), static_cast<std::streamsize>(segment.size));
+                continue;
+            }
+            const std::string_view text = string_field_str(bytes, segment.capacity);
+            const size_t length = std::min(text.size(), segment.capacity);
+            unsigned char header[compact_string_header];
+            header[0] = string_field_cstr(bytes) != nullptr;
+            put_length(header + 1, length);
+            ostr.write(reinterpret_cast<const char *>(header), sizeof(header));
+            ostr.write(text.data(), static_cast<std::streamsize>(length));
+        }
+    }
+
+    void CompactLayout::read(std::istream &istr, unsigned char *record) const
+    {
+        const auto read_exactly = [&istr](void *bytes, const size_t count) {
+            istr.read(static_cast<char *>(bytes), static_cast<std::streamsize>(count));
+            if (static_cast<size_t>(istr.gcount()) < count)
+            {
+                throw not_enough_data{};
+            }
+        };
+        for (const auto &segment : segments)
+        {
+            unsigned char *field = record + segment.offset;
+            if (!segment.is_string)
+            {
+                read_exactly(field, segment.size);
+                continue;
+            }
+            unsigned char header[compact_string_header];
+            read_exactly(header, sizeof(header));
+            const size_t length = checked_length(header, segment.capacity);
+            read_exactly(field + string_header_size, length);
+            store_string_header(field, header, length);
+            std::memset(field + string_header_size + length, 0, segment.size - string_header_size - length);
+        }
+    }
+
+} // namespace SeriStruct
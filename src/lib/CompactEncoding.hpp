@@ -0,0 +1,253 @@
+#pragma once
+#include "RecordArray.hpp"
+#include "SeriStruct.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Compact encoding of records whose string fields are mostly empty space.
+     *
+     * Each cstr or str field is written as a presence byte, its length as four little-endian bytes,
+     * and only the characters of its text. Every other byte of the record (numeric fields and padding)
+     * is copied as is, in host byte order. Decoding expands a record back into its fixed layout, with
+     * the unused capacity of each string cleared. Encoded records have different sizes, so they can
+     * only be read in order.
+     */
+    class CompactLayout
+    {
+    public:
+        /**
+         * @brief Construct a new CompactLayout object
+         *
+         * @param fields describes the fields of the record
+         * @param field_count is the number of fields
+         * @param record_size is the size of the record layout in bytes
+         *
+         * @exception SeriStruct::invalid_size if a field does not fit within \p record_size
+         */
+        CompactLayout(const FieldInfo *fields, const size_t field_count, const size_t record_size);
+
+        /**
+         * @brief Construct a new CompactLayout object from a generated record's field_info array
+         *
+         * @param fields describes the fields of the record
+         * @param record_size is the size of the record layout in bytes
+         */
+        template <size_t N>
+        CompactLayout(const FieldInfo (&fields)[N], const size_t record_size) : CompactLayout{fields, N, record_size} {}
+
+        /**
+         * @brief Returns the size in bytes of the encoded record with the longest strings.
+         *
+         * @return size_t
+         */
+        inline size_t max_encoded_size() const { return max_size; }
+
+        /**
+         * @brief Appends the encoding of \p record to \p out.
+         *
+         * @param record is a record of this layout
+         * @param out receives the encoded bytes
+         * @return size_t is the number of bytes appended
+         */
+        size_t encode(const unsigned char *record, std::vector<unsigned char> &out) const;
+
+        /**
+         * @brief Decodes one record from the start of \p bytes into \p record.
+         *
+         * @param bytes holds encoded records
+         * @param size is the number of bytes available in \p bytes
+         * @param record receives the record in its fixed layout
+         * @return size_t is the number of bytes decoded
+         *
+         * @exception SeriStruct::not_enough_data if \p bytes ends part way through the record
+         * @exception SeriStruct::invalid_size if a string is longer than its field allows
+         */
+        size_t decode(const unsigned char *bytes, const size_t size, unsigned char *record) const;
+
+        /**
+         * @brief Writes the encoding of \p record to \p ostr.
+         *
+         * @param ostr is a std::ostream ready for writing
+         * @param record is a record of this layout
+         */
+        void write(std::ostream &ostr, const unsigned char *record) const;
+
+        /**
+         * @brief Reads one encoded record from \p istr into \p record.
+         *
+         * @param istr is an open stream for reading the bytes
+         * @param record receives the record in its fixed layout
+         *
+         * @exception SeriStruct::not_enough_data if EOF is reached part way through the record
+         * @exception SeriStruct::invalid_size if a string is longer than its field allows
+         */
+        void read(std::istream &istr, unsigned char *record) const;
+
+    private:
+        // A run of bytes copied as is, or a string field of up to capacity characters
+        struct Segment
+        {
+            size_t offset;
+            size_t size;
+            size_t capacity;
+            bool is_string;
+        };
+
+        std::vector<Segment> segments;
+        size_t max_size;
+    };
+
+    /**
+     * @brief Returns the CompactLayout of a generated record type, built on first use.
+     *
+     * @tparam T is a generated record type
+     * @return const CompactLayout&
+     */
+    template <typename T>
+    const CompactLayout &compact_layout()
+    {
+        static_assert(T::has_fixed_size, "Records with vstr fields vary in size");
+        static const CompactLayout layout{T::field_info, T::buffer_size};
+        return layout;
+    }
+
+    /**
+     * @brief Appends the compact encoding of \p record to \p out.
+     *
+     * @tparam T is a generated record type
+     * @param record is the record to encode
+     * @param out receives the encoded bytes
+     */
+    template <typename T>
+    void encode_compact(const T &record, std::vector<unsigned char> &out)
+    {
+        compact_layout<T>().encode(record.data(), out);
+    }
+
+    /**
+     * @brief Appends the compact encoding of every record in \p records to \p out, back to back.
+     *
+     * @tparam T is a generated record type
+     * @param records is the batch of records to encode
+     * @param out receives the encoded bytes
+     */
+    template <typename T>
+    void encode_compact(const RecordArray<T> &records, std::vector<unsigned char> &out)
+    {
+        const CompactLayout &layout = compact_layout<T>();
+        for (auto view : records)
+        {
+            layout.encode(view.data(), out);
+        }
+    }
+
+    /**
+     * @brief Decodes one record from the start of \p bytes.
+     *
+     * @tparam T is a generated record type
+     * @param bytes holds encoded records
+     * @param size is the number of bytes available in \p bytes
+     * @param consumed receives the number of bytes decoded
+     * @return T
+     *
+     * @exception SeriStruct::not_enough_data if \p bytes ends part way through the record
+     * @exception SeriStruct::invalid_size if a string is longer than its field allows
+     */
+    template <typename T>
+    T decode_compact(const unsigned char *bytes, const size_t size, size_t &consumed)
+    {
+        std::array<unsigned char, T::buffer_size> record;
+        consumed = compact_layout<T>().decode(bytes, size, record.data());
+        return T{record.data(), record.size()};
+    }
+
+    /**
+     * @brief Decodes \p count records from the start of \p bytes and appends them to \p records.
+     *
+     * @tparam T is a generated record type
+     * @param bytes holds encoded records
+     * @param size is the number of bytes available in \p bytes
+     * @param count is the number of records to decode
+     * @param records receives the records
+     * @return size_t is the number of bytes decoded
+     *
+     * @exception SeriStruct::not_enough_data if \p bytes ends before \p count records
+     * @exception SeriStruct::invalid_size if a string is longer than its field allows
+     */
+    template <typename T>
+    size_t decode_compact(const unsigned char *bytes, const size_t size, const size_t count, RecordArray<T> &records)
+    {
+        const CompactLayout &layout = compact_layout<T>();
+        const size_t first = records.size();
+        records.resize(first + count);
+        size_t offset = 0;
+        try
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                offset += layout.decode(bytes + offset, size - offset, records.data() + (first + i) * T::buffer_size);
+            }
+        }
+        catch (...)
+        {
+            records.resize(first);
+            throw;
+        }
+        return offset;
+    }
+
+    /**
+     * @brief Writes the compact encoding of every record in \p records to \p ostr.
+     *
+     * @tparam T is a generated record type
+     * @param ostr is a std::ostream ready for writing
+     * @param records is the batch of records to write
+     */
+    template <typename T>
+    void write_compact(std::ostream &ostr, const RecordArray<T> &records)
+    {
+        const CompactLayout &layout = compact_layout<T>();
+        for (auto view : records)
+        {
+            layout.write(ostr, view.data());
+        }
+    }
+
+    /**
+     * @brief Reads \p count compactly encoded records from \p istr and appends them to \p records.
+     *
+     * @tparam T is a generated record type
+     * @param istr is an open stream for reading the bytes
+     * @param count is the number of records to read
+     * @param records receives the records
+     *
+     * @exception SeriStruct::not_enough_data if EOF is reached before \p count records
+     * @exception SeriStruct::invalid_size if a string is longer than its field allows
+     */
+    template <typename T>
+    void read_compact(std::istream &istr, const size_t count, RecordArray<T> &records)
+    {
+        const CompactLayout &layout = compact_layout<T>();
+        const size_t first = records.size();
+        records.resize(first + count);
+        try
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                layout.read(istr, records.data() + (first + i) * T::buffer_size);
+            }
+        }
+        catch (...)
+        {
+            records.resize(first);
+            throw;
+        }
+    }
+
+} // namespace SeriStruct
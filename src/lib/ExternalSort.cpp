@@ -0,0 +1,282 @@
+#include "ExternalSort.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        [[noreturn]] void throw_stream(const std::string &what)
+        {
+            throw std::system_error{std::make_error_code(std::io_errc::stream), what};
+        }
+
+        // Largest multiple of stride no greater than size, and at least one record
+        inline size_t whole_records(const size_t size, const size_t stride)
+        {
+            return std::max(size / stride, size_t{1}) * stride;
+        }
+
+        // Reads up to capacity bytes of whole records into buffer, returning the number of bytes read
+        size_t read_records(std::istream &input, unsigned char *buffer, const size_t capacity, const size_t stride)
+        {
+            input.read(reinterpret_cast<char *>(buffer), static_cast<std::streamsize>(capacity));
+            if (input.bad())
+            {
+                throw_stream("Cannot read records");
+            }
+            const size_t size = static_cast<size_t>(input.gcount());
+            if (size % stride != 0)
+            {
+                throw not_enough_data{};
+            }
+            return size;
+        }
+
+        // Replaces the contents of run with up to capacity bytes of records, read one block at a time
+        void read_run(std::istream &input, std::vector<unsigned char> &run, const size_t capacity, const size_t block,
+                      const size_t stride)
+        {
+            run.clear();
+            while (run.size() < capacity)
+            {
+                const size_t wanted = std::min(block, capacity - run.size());
+                const size_t old_size = run.size();
+                run.resize(old_size + wanted);
+                const size_t size = read_records(input, run.data() + old_size, wanted, stride);
+                run.resize(old_size + size);
+                if (size < wanted)
+                {
+                    return;
+                }
+            }
+        }
+
+        // Sorted runs spilled to files. Each is written on a background thread while the next is sorted,
+        // and all are removed when done.
+        class RunFiles
+        {
+        public:
+            explicit RunFiles(const ExternalSortOptions &options) : options{options} {}
+            RunFiles(const RunFiles &) = delete;
+            RunFiles &operator=(const RunFiles &) = delete;
+
+            ~RunFiles() noexcept
+            {
+                if (writer.joinable())
+                {
+                    writer.join();
+                }
+                for (const auto &path : paths)
+                {
+                    std::remove(path.c_str());
+                }
+            }
+
+            // Starts writing size bytes at records as the next run. They must stay valid until wait() returns.
+            void spill(const unsigned char *records, const size_t size)
+            {
+                wait();
+                char name[32];
+                std::snprintf(name, sizeof(name), "-%010llu.run", static_cast<unsigned long long>(paths.size()));
+                paths.push_back(options.directory + "/" + options.prefix + name);
+                writer = std::thread{[this, path = paths.back(), records, size] {
+                    try
+                    {
+                        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+                        out.write(reinterpret_cast<const char *>(records), static_cast<std::streamsize>(size));
+                        out.close();
+                        if (!out)
+                        {
+                            throw_stream("Cannot write sort run " + path);
+                        }
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                    }
+                }};
+            }
+
+            // Waits for the run being written, rethrowing any error
+            void wait()
+            {
+                if (writer.joinable())
+                {
+                    writer.join();
+                }
+                if (error)
+                {
+                    std::rethrow_exception(std::exchange(error, nullptr));
+                }
+            }
+
+            inline const std::vector<std::string> &files() const { return paths; }
+
+        private:
+            const ExternalSortOptions &options;
+            std::vector<std::string> paths;
+            std::thread writer;
+            std::exception_ptr error;
+        };
+
+        // Reads a sorted run back one block at a time
+        class RunReader
+        {
+        public:
+            RunReader(const std::string &path, const size_t stride, const size_t capacity)
+                : input{path, std::ios::binary}, stride{stride}, buffer(capacity), position{0}, end{0}
+            {
+                if (!input)
+                {
+                    throw_stream("Cannot open sort run " + path);
+                }
+                refill();
+            }
+
+            // The next record, or nullptr once the run is exhausted
+            inline const unsigned char *current() const { return position < end ? buffer.data() + position : nullptr; }
+
+            inline void advance()
+            {
+                position += stride;
+                if (position == end)
+                {
+                    refill();
+                }
+            }
+
+        private:
+            std::ifstream input;
+            size_t stride;
+            std::vector<unsigned char> buffer;
+            size_t position;
+            size_t end;
+
+            void refill()
+            {
+                end = read_records(input, buffer.data(), buffer.size(), stride);
+                position = 0;
+            }
+        };
+
+        void write_records(std::ostream &output, const unsigned char *records, const size_t size)
+        {
+            output.write(reinterpret_cast<const char *>(records), static_cast<std::streamsize>(size));
+            if (!output)
+            {
+                throw_stream("Cannot write sorted records");
+            }
+        }
+
+        void merge_runs(const std::vector<std::string> &paths, std::ostream &output, const size_t stride,
+                        const SortKey &key, const size_t memory, const size_t buffer_size)
+        {
+            // every run and the output get a buffer, within the memory the runs were sorted in
+            const size_t block = whole_records(std::min(buffer_size, memory / (paths.size() + 1)), stride);
+            std::vector<RunReader> runs;
+            runs.reserve(paths.size());
+            for (const auto &path : paths)
+            {
+                runs.emplace_back(path, stride, block);
+            }
+
+            // next key of each run; ties go to the earlier run, which keeps the sort stable
+            using Head = std::pair<uint64_t, size_t>;
+            std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+            for (size_t r = 0; r < runs.size(); r++)
+            {
+                if (const unsigned char *record = runs[r].current())
+                {
+                    heads.emplace(sort_bits(record, key), r);
+                }
+            }
+
+            std::vector<unsigned char> pending(block);
+            size_t used = 0;
+            while (!heads.empty())
+            {
+                const size_t r = heads.top().second;
+                heads.pop();
+                std::memcpy(pending.data() + used, runs[r].current(), stride);
+                used += stride;
+                if (used == pending.size())
+                {
+                    write_records(output, pending.data(), used);
+                    used = 0;
+                }
+                runs[r].advance();
+                if (const unsigned char *record = runs[r].current())
+                {
+                    heads.emplace(sort_bits(record, key), r);
+                }
+            }
+            write_records(output, pending.data(), used);
+        }
+    } // namespace
+
+    size_t external_sort(std::istream &input, std::ostream &output, const size_t stride, const SortKey &key,
+                         const ExternalSortOptions &options)
+    {
+        if (stride == 0 || options.run_size < stride)
+        {
+            throw invalid_size{};
+        }
+        const size_t capacity = options.run_size / stride * stride;
+        const size_t block = whole_records(options.buffer_size, stride);
+
+        // one run is sorted while the other is written. The buffers are declared first, so when an error
+        // unwinds the stack the writer thread is joined before the buffer it writes from is freed.
+        std::vector<unsigned char> buffers[2];
+        RunFiles runs{options};
+        size_t current = 0;
+        size_t total = 0;
+        while (true)
+        {
+            std::vector<unsigned char> &run = buffers[current];
+            read_run(input, run, capacity, block, stride);
+            if (run.empty())
+            {
+                break;
+            }
+            const size_t count = run.size() / stride;
+            total += count;
+            radix_sort(run.data(), count, stride, key, options.threads);
+
+            const bool last = run.size() < capacity || input.peek() == std::istream::traits_type::eof();
+            if (last && runs.files().empty())
+            {
+                // everything fit in memory
+                write_records(output, run.data(), run.size());
+                return total;
+            }
+            runs.spill(run.data(), run.size());
+            current ^= 1;
+            if (last)
+            {
+                break;
+            }
+        }
+        runs.wait();
+        for (auto &buffer : buffers)
+        {
+            std::vector<unsigned char>{}.swap(buffer);
+        }
+
+        if (!runs.files().empty())
+        {
+            merge_runs(runs.files(), output, stride, key, 2 * capacity, block);
+        }
+        return total;
+    }
+
+} // namespace SeriStruct
@@ -0,0 +1,71 @@
+#pragma once
+#include "RecordSort.hpp"
+#include "SeriStruct.hpp"
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Configures external_sort().
+     */
+    struct ExternalSortOptions
+    {
+        /** Directory holding the sorted runs while the merge is in progress, which must exist */
+        std::string directory = ".";
+        /** Runs are named <prefix>-<index>.run */
+        std::string prefix = "sort";
+        /** Bytes of records sorted in memory at once. Two runs are held at a time, one being sorted while the other is written. */
+        size_t run_size = 256 * 1024 * 1024;
+        /** Size in bytes of each read buffer and of the write buffer while merging */
+        size_t buffer_size = 4 * 1024 * 1024;
+        /** Threads sorting each run, or 0 for one per hardware thread */
+        unsigned threads = 0;
+    };
+
+    /**
+     * @brief Sorts records read from \p input by the value of \p key and writes them to \p output, using a
+     * bounded amount of memory however many records there are. The sort is stable.
+     *
+     * Records are read run_size bytes at a time, sorted with radix_sort() and spilled to a file in
+     * options.directory while the next run is read and sorted. The runs are then merged with a heap of
+     * their next keys, reading each run and writing \p output in blocks of up to buffer_size bytes, and
+     * removed. When every record fits in one run nothing is spilled.
+     *
+     * @param input is a stream of records stored back to back, such as one written by write_many() or RecordArray::write()
+     * @param output is a std::ostream ready for writing
+     * @param stride is the size of each record in bytes
+     * @param key is the field to sort by
+     * @param options configures the sort
+     * @return size_t is the number of records sorted
+     *
+     * @exception SeriStruct::not_enough_data if \p input ends partway through a record
+     * @exception SeriStruct::invalid_size if run_size cannot hold a record
+     * @exception std::system_error if a run cannot be written or read back, or \p output fails
+     */
+    size_t external_sort(std::istream &input, std::ostream &output, const size_t stride, const SortKey &key,
+                         const ExternalSortOptions &options = ExternalSortOptions{});
+
+    /**
+     * @brief Sorts records of generated type \p T read from \p input by the field named \p field and writes
+     * them to \p output.
+     *
+     * @tparam T is a generated record type
+     * @param input is a stream of records stored back to back
+     * @param output is a std::ostream ready for writing
+     * @param field is the name of an integral or floating point field
+     * @param options configures the sort
+     * @return size_t is the number of records sorted
+     *
+     * @exception std::invalid_argument if the field cannot be a sort key
+     */
+    template <typename T>
+    size_t external_sort(std::istream &input, std::ostream &output, const char *field,
+                         const ExternalSortOptions &options = ExternalSortOptions{})
+    {
+        static_assert(T::has_fixed_size, "Records with vstr fields vary in size");
+        return external_sort(input, output, T::buffer_size, sort_key<T>(field), options);
+    }
+
+} // namespace SeriStruct
@@ -0,0 +1,229 @@
+#include "HashIndex.hpp"
+#include "ParallelDetail.hpp"
+#include "RecordSort.hpp"
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        template <typename S>
+        inline S read_value(const unsigned char *value)
+        {
+            S result;
+            std::memcpy(&result, value, sizeof(S));
+            return result;
+        }
+
+        // The field named name, which is a key if it is a cstr or str or could be a sort key
+        const FieldInfo &key_field(const FieldInfo *fields, const size_t field_count, const char *name)
+        {
+            const std::string_view wanted{name};
+            const FieldInfo *field = std::find_if(fields, fields + field_count,
+                                                  [wanted](const FieldInfo &candidate) { return wanted == candidate.name; });
+            if (field == fields + field_count || !field->is_string)
+            {
+                // throws if there is no such field, or it is not a single integral or floating point value
+                sort_key(fields, field_count, name);
+            }
+            return *field;
+        }
+    } // namespace
+
+    uint64_t HashIndexFile::value_key(const unsigned char *value, const size_t width, const ValueKind kind)
+    {
+        if (kind == ValueKind::floating)
+        {
+            return width == sizeof(float) ? float_key(read_value<float>(value)) : float_key(read_value<double>(value));
+        }
+        if (kind == ValueKind::signed_integer)
+        {
+            switch (width)
+            {
+            case 1:
+                return static_cast<uint64_t>(int64_t{read_value<int8_t>(value)});
+            case 2:
+                return static_cast<uint64_t>(int64_t{read_value<int16_t>(value)});
+            case 4:
+                return static_cast<uint64_t>(int64_t{read_value<int32_t>(value)});
+            default:
+                return static_cast<uint64_t>(read_value<int64_t>(value));
+            }
+        }
+        switch (width)
+        {
+        case 1:
+            return read_value<uint8_t>(value);
+        case 2:
+            return read_value<uint16_t>(value);
+        case 4:
+            return read_value<uint32_t>(value);
+        default:
+            return read_value<uint64_t>(value);
+        }
+    }
+
+    void HashIndexFile::build(const unsigned char *records, const size_t count, const size_t stride, const FieldInfo *fields,
+                              const size_t field_count, const char *name, const uint64_t schema, const std::string &path,
+                              const unsigned threads)
+    {
+        const FieldInfo &field = key_field(fields, field_count, name);
+
+        HashIndexHeader header{};
+        std::memcpy(header.magic, HashIndexHeader::magic_value, sizeof(header.magic));
+        header.schema = schema;
+        header.record_size = stride;
+        header.record_count = count;
+        header.key_offset = field.offset;
+        header.key_width = field.is_string ? field.size : field.width;
+        header.key_kind = static_cast<uint8_t>(field.is_string ? ValueKind::other : field.kind);
+        // at most half full, so probes are short
+        unsigned slot_bits = 1;
+        while ((uint64_t{1} << slot_bits) < 2 * static_cast<uint64_t>(count))
+        {
+            slot_bits++;
+        }
+        header.slot_count = uint64_t{1} << slot_bits;
+        const unsigned shift = 64 - slot_bits;
+        const uint64_t mask = header.slot_count - 1;
+
+        const unsigned used = thread_count(count, threads, min_records_per_thread);
+        std::vector<uint64_t> keys(count);
+        // each thread fills the slots of one partition, so entries are grouped by the partition of their home slot
+        const uint64_t span = (header.slot_count + used - 1) / used;
+        std::vector<std::vector<size_t>> counts(used, std::vector<size_t>(used, 0));
+        parallel_slices(count, used, [&](const unsigned slice, const size_t begin, const size_t end) {
+            auto &histogram = counts[slice];
+            for (size_t i = begin; i < end; i++)
+            {
+                const unsigned char *key = records + i * stride + field.offset;
+                keys[i] = field.is_string ? string_key(string_field_str(key, field.size - string_header_size - 1)) : value_key(key, field.width, field.kind);
+                histogram[home_slot(keys[i], shift) / span]++;
+            }
+        });
+
+        // ordinals by partition, and in file order within each
+        std::vector<std::vector<size_t>> offsets(used, std::vector<size_t>(used));
+        std::vector<size_t> partition_begin(used + 1);
+        size_t next = 0;
+        for (unsigned partition = 0; partition < used; partition++)
+        {
+            partition_begin[partition] = next;
+            for (unsigned slice = 0; slice < used; slice++)
+            {
+                offsets[slice][partition] = next;
+                next += counts[slice][partition];
+            }
+        }
+        partition_begin[used] = next;
+        std::vector<uint64_t> ordinals(count);
+        parallel_slices(count, used, [&](const unsigned slice, const size_t begin, const size_t end) {
+            auto &offset = offsets[slice];
+            for (size_t i = begin; i < end; i++)
+            {
+                ordinals[offset[home_slot(keys[i], shift) / span]++] = i;
+            }
+        });
+
+        std::vector<HashIndexSlot> slots(header.slot_count, HashIndexSlot{0, 0});
+        // entries whose probe runs past the end of their partition, placed afterwards
+        std::vector<std::vector<uint64_t>> overflow(used);
+        parallel_slices(used, used, [&](const unsigned partition, const size_t, const size_t) {
+            const uint64_t last = std::min((partition + 1) * span, header.slot_count);
+            for (size_t i = partition_begin[partition]; i < partition_begin[partition + 1]; i++)
+            {
+                const uint64_t ordinal = ordinals[i];
+                uint64_t slot = home_slot(keys[ordinal], shift);
+                while (slot < last && slots[slot].ordinal != 0)
+                {
+                    slot++;
+                }
+                if (slot == last)
+                {
+                    overflow[partition].push_back(ordinal);
+                    continue;
+                }
+                slots[slot] = HashIndexSlot{keys[ordinal], ordinal + 1};
+            }
+        });
+        for (const auto &partition : overflow)
+        {
+            for (const uint64_t ordinal : partition)
+            {
+                uint64_t slot = home_slot(keys[ordinal], shift);
+                while (slots[slot].ordinal != 0)
+                {
+                    slot = (slot + 1) & mask;
+                }
+                slots[slot] = HashIndexSlot{keys[ordinal], ordinal + 1};
+            }
+        }
+
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(slots.data()), static_cast<std::streamsize>(slots.size() * sizeof(HashIndexSlot)));
+        out.close();
+        if (!out)
+        {
+            throw std::system_error{std::make_error_code(std::io_errc::stream), "Cannot write hash index " + path};
+        }
+    }
+
+    HashIndexFile::HashIndexFile(const std::string &path)
+        : file{path}, info{}, slots{nullptr}, mask{0}, shift{0}
+    {
+        if (file.size() < HashIndexHeader::size)
+        {
+            throw invalid_size{};
+        }
+        std::memcpy(&info, file.data(), sizeof(info));
+        const uint64_t slot_count = info.slot_count;
+        if (std::memcmp(info.magic, HashIndexHeader::magic_value, sizeof(info.magic)) != 0 || slot_count < 2 ||
+            (slot_count & (slot_count - 1)) != 0 || (file.size() - HashIndexHeader::size) / sizeof(HashIndexSlot) != slot_count ||
+            (file.size() - HashIndexHeader::size) % sizeof(HashIndexSlot) != 0 || info.record_count > slot_count / 2)
+        {
+            throw invalid_size{};
+        }
+        // lookups widen and shift by the key width, so it must be one a key field can have
+        const ValueKind kind = static_cast<ValueKind>(info.key_kind);
+        const uint64_t width = info.key_width;
+        const bool numeric_width = width == 1 || width == 2 || width == 4 || width == 8;
+        const bool valid_key = kind == ValueKind::other ? width > string_header_size
+                                                        : kind <= ValueKind::floating && numeric_width && (kind != ValueKind::floating || width >= sizeof(float));
+        if (!valid_key || info.key_offset > info.record_size || width > info.record_size - info.key_offset)
+        {
+            throw invalid_size{};
+        }
+        slots = reinterpret_cast<const HashIndexSlot *>(file.data() + HashIndexHeader::size);
+        mask = slot_count - 1;
+        unsigned slot_bits = 0;
+        while ((uint64_t{1} << slot_bits) < slot_count)
+        {
+            slot_bits++;
+        }
+        shift = 64 - slot_bits;
+    }
+
+    bool HashIndexFile::key_matches(const FieldInfo *fields, const size_t field_count) const
+    {
+        for (size_t f = 0; f < field_count; f++)
+        {
+            const FieldInfo &field = fields[f];
+            if (field.offset != info.key_offset)
+            {
+                continue;
+            }
+            if (field.is_string)
+            {
+                return is_string() && info.key_width == field.size;
+            }
+            return field.kind != ValueKind::other && field.count == 1 && field.size == field.width &&
+                   static_cast<ValueKind>(info.key_kind) == field.kind && info.key_width == field.width;
+        }
+        return false;
+    }
+
+} // namespace SeriStruct
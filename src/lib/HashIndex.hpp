@@ -0,0 +1,413 @@
+#pragma once
+#include "MappedFile.hpp"
+#include "MappedRecordFile.hpp"
+#include "RecordHash.hpp"
+#include "SeriStruct.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Fixed 64-byte header at the start of every hash index file, stored in host byte order.
+     * HashIndexSlot entries follow it.
+     */
+    struct HashIndexHeader
+    {
+        static constexpr char magic_value[8] = {'S', 'S', 'T', 'R', 'H', 'I', 'X', '1'};
+        static constexpr size_t size = 64;
+
+        /** Identifies the file as a hash index */
+        char magic[8];
+        /** Fingerprint of the indexed record layout */
+        uint64_t schema;
+        /** Size of each indexed record in bytes */
+        uint64_t record_size;
+        /** Number of records indexed */
+        uint64_t record_count;
+        /** Number of slots, a power of two at least twice record_count */
+        uint64_t slot_count;
+        /** Offset of the key field in each record */
+        uint64_t key_offset;
+        /** Size of the key value in bytes, or of the whole field for a string key */
+        uint64_t key_width;
+        /** ValueKind of the key, or ValueKind::other for a string key */
+        uint8_t key_kind;
+        uint8_t reserved[7];
+    };
+    static_assert(sizeof(HashIndexHeader) == HashIndexHeader::size, "Hash index header must be 64 bytes");
+
+    /**
+     * @brief One slot of a hash index.
+     */
+    struct HashIndexSlot
+    {
+        /** The value of an integral or floating point key, or the hash of the text of a string key */
+        uint64_t key;
+        /** Ordinal of the record plus one, or 0 if the slot is empty */
+        uint64_t ordinal;
+    };
+
+    /**
+     * @brief A hash index file mapped into memory, mapping the value of one field of a record file to the
+     * ordinals of the records holding it. Use HashIndex<T> to build and query one for a generated record type.
+     *
+     * The index is an open addressing table at most half full, probed linearly from the slot chosen by the
+     * high bits of a mixed key. Slots hold integral and floating point keys in place, so a lookup usually
+     * reads a single cache line of the index. String keys are stored as a 64-bit hash of their text, so
+     * a lookup also reads the candidate record to compare the text. Opening is constant time whatever
+     * the size of the index.
+     */
+    class HashIndexFile
+    {
+    public:
+        /**
+         * @brief Builds an index of the field named \p name over \p count records and writes it to \p path.
+         * Keys are read and hashed in parallel, and each thread fills its own range of slots.
+         *
+         * @param records is the first byte of the first record
+         * @param count is the number of records
+         * @param stride is the distance in bytes between consecutive records
+         * @param fields describes the fields of the record
+         * @param field_count is the number of fields
+         * @param name is the name of the key field in the IDL
+         * @param schema is stored in the header to identify the record layout
+         * @param path is the path of the index file, which is replaced
+         * @param threads is the number of threads to use, or 0 for one per hardware thread. Small files use fewer.
+         *
+         * @exception std::invalid_argument if there is no such field, or it is not a single integral or floating
+         * point value, cstr or str
+         * @exception std::system_error if the index cannot be written
+         */
+        static void build(const unsigned char *records, const size_t count, const size_t stride, const FieldInfo *fields,
+                          const size_t field_count, const char *name, const uint64_t schema, const std::string &path,
+                          const unsigned threads = 0);
+
+        /**
+         * @brief Construct a new HashIndexFile object by mapping the index at \p path.
+         *
+         * @param path is the path of the index file
+         *
+         * @exception std::system_error if the file cannot be opened or mapped
+         * @exception SeriStruct::invalid_size if the file is not a hash index, or its header is damaged
+         */
+        explicit HashIndexFile(const std::string &path);
+
+        /**
+         * @brief Returns the header of the index.
+         *
+         * @return const HashIndexHeader&
+         */
+        inline const HashIndexHeader &header() const { return info; }
+
+        /**
+         * @brief Returns true if the key is a cstr or str field.
+         *
+         * @return bool
+         */
+        inline bool is_string() const { return static_cast<ValueKind>(info.key_kind) == ValueKind::other; }
+
+        /**
+         * @brief Returns true if the key described by the header is one of \p fields, with the same
+         * offset, size and kind that build() would have stored for it.
+         *
+         * @param fields describes the fields of the record
+         * @param field_count is the number of fields
+         * @return bool
+         */
+        bool key_matches(const FieldInfo *fields, const size_t field_count) const;
+
+        /**
+         * @brief Calls \p visit with the ordinal of each record whose slot holds \p key, in file order, until
+         * \p visit returns false. At most every slot is probed once, even in a damaged index.
+         *
+         * @param key is a key as stored in the slots
+         * @param visit is called as bool(size_t ordinal)
+         *
+         * @exception SeriStruct::invalid_size if a probed slot holds an ordinal past the last record
+         */
+        template <typename Visit>
+        void probe(const uint64_t key, Visit &&visit) const
+        {
+            uint64_t slot = home_slot(key, shift);
+            for (uint64_t probed = 0; probed <= mask; probed++, slot = (slot + 1) & mask)
+            {
+                const HashIndexSlot &entry = slots[slot];
+                if (entry.ordinal == 0)
+                {
+                    return;
+                }
+                if (entry.ordinal > info.record_count)
+                {
+                    throw invalid_size{};
+                }
+                if (entry.key == key && !visit(static_cast<size_t>(entry.ordinal - 1)))
+                {
+                    return;
+                }
+            }
+        }
+
+        /**
+         * @brief Converts \p value to the key stored for an integral or floating point field holding it.
+         *
+         * @tparam K is an arithmetic type
+         * @param value is the value to look up
+         * @param key receives the key
+         * @return bool is false if the field cannot hold \p value, so no record matches
+         *
+         * @exception std::invalid_argument if the field is integral and \p value is not
+         */
+        template <typename K>
+        bool numeric_key(const K value, uint64_t &key) const
+        {
+            const ValueKind kind = static_cast<ValueKind>(info.key_kind);
+            if (kind == ValueKind::floating)
+            {
+                key = info.key_width == sizeof(float) ? float_key(static_cast<float>(value))
+                                                      : float_key(static_cast<double>(value));
+                return true;
+            }
+            if constexpr (std::is_integral_v<K>)
+            {
+                const size_t bits = info.key_width * 8;
+                if (kind == ValueKind::signed_integer)
+                {
+                    if (std::is_unsigned_v<K> && static_cast<uint64_t>(value) > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+                    {
+                        return false;
+                    }
+                    const int64_t signed_value = static_cast<int64_t>(value);
+                    if (bits < 64 && (signed_value < -(int64_t{1} << (bits - 1)) || signed_value >= (int64_t{1} << (bits - 1))))
+                    {
+                        return false;
+                    }
+                    key = static_cast<uint64_t>(signed_value);
+                    return true;
+                }
+                if constexpr (std::is_signed_v<K>)
+                {
+                    if (value < 0)
+                    {
+                        return false;
+                    }
+                }
+                const uint64_t unsigned_value = static_cast<uint64_t>(value);
+                if (bits < 64 && (unsigned_value >> bits) != 0)
+                {
+                    return false;
+                }
+                key = unsigned_value;
+                return true;
+            }
+            else
+            {
+                throw std::invalid_argument{"Integral keys are looked up with integral values"};
+            }
+        }
+
+        /**
+         * @brief Returns the key stored for a string field holding \p text.
+         *
+         * @param text is the text to look up
+         * @return uint64_t
+         */
+        static inline uint64_t string_key(const std::string_view text) { return hash_bytes(text.data(), text.size()); }
+
+        /**
+         * @brief Returns the key stored for an integral or floating point value of \p width bytes at \p value.
+         * Integers are widened to 64 bits and floating point values to double, with -0.0 stored as 0.0.
+         *
+         * @param value is the first byte of the value
+         * @param width is the size of the value in bytes
+         * @param kind is how the value is interpreted
+         * @return uint64_t
+         */
+        static uint64_t value_key(const unsigned char *value, const size_t width, const ValueKind kind);
+
+        /**
+         * @brief Returns the first slot probed for \p key in a table of 2^(64 - \p shift) slots.
+         *
+         * @param key is a key as stored in the slots
+         * @param shift is 64 minus the base 2 logarithm of the number of slots
+         * @return uint64_t
+         */
+        static inline uint64_t home_slot(uint64_t key, const unsigned shift)
+        {
+            // the MurmurHash3 finalizer, so that every key bit affects the high bits
+            key ^= key >> 33;
+            key *= 0xFF51AFD7ED558CCDull;
+            key ^= key >> 33;
+            key *= 0xC4CEB9FE1A85EC53ull;
+            key ^= key >> 33;
+            return key >> shift;
+        }
+
+    private:
+        MappedFile file;
+        HashIndexHeader info;
+        const HashIndexSlot *slots;
+        uint64_t mask;
+        unsigned shift;
+
+        template <typename F>
+        static inline uint64_t float_key(const F value)
+        {
+            // 0.0 == -0.0, and widening to double is exact
+            const double wide = value == 0 ? 0.0 : static_cast<double>(value);
+            uint64_t key;
+            std::memcpy(&key, &wide, sizeof(key));
+            return key;
+        }
+    };
+
+    /**
+     * @brief A persistent hash index over a MappedRecordFile<T>, keyed by one field, with lookups returning
+     * record ordinals. See HashIndexFile for the layout.
+     *
+     * Records with equal keys are all found, in file order. The index refers to the records file it was
+     * opened with, which must outlive it, and must be rebuilt when that file changes.
+     *
+     * @tparam T is a generated record type
+     */
+    template <typename T>
+    class HashIndex
+    {
+    public:
+        /**
+         * @brief Builds an index of the field named \p field over every record of \p records and writes it to \p path.
+         *
+         * @param records is the file of records to index
+         * @param field is the name of an integral, floating point, cstr or str field
+         * @param path is the path of the index file, which is replaced
+         * @param threads is the number of threads to use, or 0 for one per hardware thread
+         *
+         * @exception std::invalid_argument if the field cannot be a key
+         * @exception std::system_error if the index cannot be written
+         */
+        static void build(const MappedRecordFile<T> &records, const char *field, const std::string &path,
+                          const unsigned threads = 0)
+        {
+            HashIndexFile::build(records.data(), records.size(), MappedRecordFile<T>::stride, T::field_info,
+                                 std::size(T::field_info), field, T::fingerprint, path, threads);
+        }
+
+        /**
+         * @brief Construct a new HashIndex object by mapping the index at \p path, built over \p records.
+         *
+         * @param records is the indexed file
+         * @param path is the path of the index file
+         *
+         * @exception std::system_error if the file cannot be opened or mapped
+         * @exception SeriStruct::schema_mismatch if the index was built for another record layout
+         * @exception SeriStruct::invalid_size if the file is not a hash index of a field of T, or \p records has
+         * changed size since it was built
+         */
+        HashIndex(const MappedRecordFile<T> &records, const std::string &path) : records{records}, index{path}
+        {
+            if (index.header().schema != T::fingerprint)
+            {
+                throw schema_mismatch{};
+            }
+            if (index.header().record_size != MappedRecordFile<T>::stride || index.header().record_count != records.size() ||
+                !index.key_matches(T::field_info, std::size(T::field_info)))
+            {
+                throw invalid_size{};
+            }
+        }
+
+        /**
+         * @brief Returns the ordinal of the first record whose key equals \p key, if any.
+         *
+         * @tparam K is an arithmetic type for integral and floating point keys, or convertible to std::string_view for strings
+         * @param key is the value to look up
+         * @return std::optional<size_t>
+         *
+         * @exception std::invalid_argument if \p key cannot be compared with the key field
+         * @exception SeriStruct::invalid_size if the index is damaged
+         */
+        template <typename K>
+        std::optional<size_t> find(const K &key) const
+        {
+            std::optional<size_t> found;
+            visit(key, [&found](const size_t ordinal) {
+                found = ordinal;
+                return false;
+            });
+            return found;
+        }
+
+        /**
+         * @brief Returns the ordinals of every record whose key equals \p key, in file order.
+         *
+         * @tparam K is an arithmetic type for integral and floating point keys, or convertible to std::string_view for strings
+         * @param key is the value to look up
+         * @return std::vector<size_t>
+         *
+         * @exception std::invalid_argument if \p key cannot be compared with the key field
+         * @exception SeriStruct::invalid_size if the index is damaged
+         */
+        template <typename K>
+        std::vector<size_t> find_all(const K &key) const
+        {
+            std::vector<size_t> found;
+            visit(key, [&found](const size_t ordinal) {
+                found.push_back(ordinal);
+                return true;
+            });
+            return found;
+        }
+
+        /**
+         * @brief Returns the underlying index.
+         *
+         * @return const HashIndexFile&
+         */
+        inline const HashIndexFile &index_file() const { return index; }
+
+    private:
+        const MappedRecordFile<T> &records;
+        HashIndexFile index;
+
+        template <typename K, typename Visit>
+        void visit(const K &key, Visit &&visit_ordinal) const
+        {
+            if constexpr (std::is_arithmetic_v<K>)
+            {
+                if (index.is_string())
+                {
+                    throw std::invalid_argument{"String keys are looked up with text"};
+                }
+                uint64_t probe_key;
+                if (index.numeric_key(key, probe_key))
+                {
+                    index.probe(probe_key, visit_ordinal);
+                }
+            }
+            else
+            {
+                const std::string_view text{key};
+                if (!index.is_string())
+                {
+                    throw std::invalid_argument{"Only string keys are looked up with text"};
+                }
+                const size_t offset = static_cast<size_t>(index.header().key_offset);
+                const size_t maxlen = static_cast<size_t>(index.header().key_width) - string_header_size - 1;
+                index.probe(HashIndexFile::string_key(text), [&](const size_t ordinal) {
+                    // a different text with the same hash is skipped
+                    return string_field_str(records[ordinal].data() + offset, maxlen) != text || visit_ordinal(ordinal);
+                });
+            }
+        }
+    };
+
+} // namespace SeriStruct
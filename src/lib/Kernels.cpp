@@ -0,0 +1,190 @@
+#include "KernelsDetail.hpp"
+#include <atomic>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        SimdLevel supported_level()
+        {
+#if defined(SERISTRUCT_X86_KERNELS) && defined(__GNUC__)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2"))
+            {
+                return SimdLevel::avx2;
+            }
+            if (__builtin_cpu_supports("sse4.2"))
+            {
+                return SimdLevel::sse42;
+            }
+#endif
+            return SimdLevel::scalar;
+        }
+
+        std::atomic<SimdLevel> &active_level()
+        {
+            static std::atomic<SimdLevel> level{supported_level()};
+            return level;
+        }
+
+        inline size_t popcount(uint64_t word)
+        {
+#if defined(__GNUC__)
+            return static_cast<size_t>(__builtin_popcountll(word));
+#else
+            size_t count = 0;
+            for (; word; word &= word - 1)
+            {
+                count++;
+            }
+            return count;
+#endif
+        }
+    } // namespace
+
+    SimdLevel simd_level()
+    {
+        return active_level().load(std::memory_order_relaxed);
+    }
+
+    SimdLevel set_simd_level(const SimdLevel level)
+    {
+        static const SimdLevel supported = supported_level();
+        const SimdLevel used = static_cast<int>(level) < static_cast<int>(supported) ? level : supported;
+        active_level().store(used, std::memory_order_relaxed);
+        return used;
+    }
+
+    void SelectionBitmap::assign(const size_t size, const bool value)
+    {
+        bits = size;
+        bitmap.assign((size + 63) / 64, value ? ~uint64_t{0} : 0);
+        if (value && size % 64)
+        {
+            bitmap.back() = (uint64_t{1} << (size % 64)) - 1;
+        }
+    }
+
+    size_t SelectionBitmap::count() const
+    {
+        size_t total = 0;
+        for (auto word : bitmap)
+        {
+            total += popcount(word);
+        }
+        return total;
+    }
+
+    std::vector<size_t> SelectionBitmap::indices() const
+    {
+        std::vector<size_t> out;
+        indices(out);
+        return out;
+    }
+
+    void SelectionBitmap::indices(std::vector<size_t> &out) const
+    {
+        out.reserve(out.size() + count());
+        for (size_t w = 0; w < bitmap.size(); w++)
+        {
+            for (uint64_t word = bitmap[w]; word; word &= word - 1)
+            {
+                out.push_back(w * 64 + detail::lowest_bit(word));
+            }
+        }
+    }
+
+    SelectionBitmap &SelectionBitmap::operator&=(const SelectionBitmap &other)
+    {
+        for (size_t w = 0; w < bitmap.size(); w++)
+        {
+            bitmap[w] &= other.bitmap[w];
+        }
+        return *this;
+    }
+
+    SelectionBitmap &SelectionBitmap::operator|=(const SelectionBitmap &other)
+    {
+        for (size_t w = 0; w < bitmap.size(); w++)
+        {
+            bitmap[w] |= other.bitmap[w];
+        }
+        return *this;
+    }
+
+    void SelectionBitmap::flip()
+    {
+        for (auto &word : bitmap)
+        {
+            word = ~word;
+        }
+        if (bits % 64)
+        {
+            bitmap.back() &= (uint64_t{1} << (bits % 64)) - 1;
+        }
+    }
+
+    namespace detail
+    {
+        template <typename T>
+        void filter(const T *values, const size_t count, const Compare op, const T operand, uint64_t *words)
+        {
+#if defined(SERISTRUCT_X86_KERNELS)
+            switch (simd_level())
+            {
+            case SimdLevel::avx2:
+                return filter_avx2(values, count, op, operand, words);
+            case SimdLevel::sse42:
+                return filter_sse42(values, count, op, operand, words);
+            default:
+                break;
+            }
+#endif
+            with_compare(op, [&](auto c) {
+                filter_tail(0, count, words, [&](const size_t i) { return compare<decltype(c)::value>(values[i], operand); });
+            });
+        }
+
+        template <typename T>
+        void filter_range(const T *values, const size_t count, const T low, const T high, uint64_t *words)
+        {
+#if defined(SERISTRUCT_X86_KERNELS)
+            switch (simd_level())
+            {
+            case SimdLevel::avx2:
+                return filter_range_avx2(values, count, low, high, words);
+            case SimdLevel::sse42:
+                return filter_range_sse42(values, count, low, high, words);
+            default:
+                break;
+            }
+#endif
+            filter_tail(0, count, words, [&](const size_t i) { return values[i] >= low && values[i] <= high; });
+        }
+
+        template <typename T>
+        Aggregate<T> aggregate(const T *values, const size_t count, const uint64_t *words)
+        {
+#if defined(SERISTRUCT_X86_KERNELS)
+            switch (simd_level())
+            {
+            case SimdLevel::avx2:
+                return aggregate_avx2(values, count, words);
+            case SimdLevel::sse42:
+                return aggregate_sse42(values, count, words);
+            default:
+                break;
+            }
+#endif
+            return aggregate_values(values, count, words);
+        }
+
+#define SERISTRUCT_INSTANTIATE(T)                                                            \
+    template void filter<T>(const T *, const size_t, const Compare, const T, uint64_t *);    \
+    template void filter_range<T>(const T *, const size_t, const T, const T, uint64_t *);   \
+    template Aggregate<T> aggregate<T>(const T *, const size_t, const uint64_t *);
+        SERISTRUCT_KERNEL_TYPES(SERISTRUCT_INSTANTIATE)
+#undef SERISTRUCT_INSTANTIATE
+
+    } // namespace detail
+} // namespace SeriStruct
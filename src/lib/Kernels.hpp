@@ -0,0 +1,329 @@
+#pragma once
+#include "RecordColumns.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <type_traits>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Instruction set used by the filter and aggregate kernels.
+     */
+    enum class SimdLevel
+    {
+        scalar,
+        sse42,
+        avx2
+    };
+
+    /**
+     * @brief Returns the instruction set the kernels currently run with. Defaults to the best one
+     * supported by the processor.
+     *
+     * @return SimdLevel
+     */
+    SimdLevel simd_level();
+
+    /**
+     * @brief Selects the instruction set the kernels run with, for example to compare code paths.
+     * Levels the processor does not support are lowered to the best one it does.
+     *
+     * @param level is the requested instruction set
+     * @return SimdLevel is the instruction set that will be used
+     */
+    SimdLevel set_simd_level(const SimdLevel level);
+
+    /**
+     * @brief Comparison applied by filter() between each value and the operand.
+     */
+    enum class Compare
+    {
+        equal,
+        not_equal,
+        less,
+        less_equal,
+        greater,
+        greater_equal
+    };
+
+    /**
+     * @brief Result of a filter: one bit per value, set where the value was selected. Bits are
+     * packed 64 to a word, with value i at bit (i % 64) of word (i / 64). Bits past size() are zero.
+     */
+    class SelectionBitmap
+    {
+    public:
+        /**
+         * @brief Construct a new, empty SelectionBitmap object
+         *
+         * @param resource is the memory resource used to allocate the words
+         */
+        explicit SelectionBitmap(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : bits{0}, bitmap{resource} {}
+
+        /**
+         * @brief Construct a new SelectionBitmap object of \p size bits, all set to \p value
+         *
+         * @param size is the number of bits
+         * @param value is the initial value of every bit
+         * @param resource is the memory resource used to allocate the words
+         */
+        SelectionBitmap(const size_t size, const bool value = false,
+                        std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : bits{0}, bitmap{resource}
+        {
+            assign(size, value);
+        }
+
+        /**
+         * @brief Returns the number of bits.
+         *
+         * @return size_t
+         */
+        inline size_t size() const { return bits; }
+
+        /**
+         * @brief Returns the number of 64-bit words holding the bits.
+         *
+         * @return size_t
+         */
+        inline size_t word_count() const { return bitmap.size(); }
+
+        /**
+         * @brief Returns a pointer to the first word.
+         *
+         * @return const uint64_t*
+         */
+        inline const uint64_t *words() const { return bitmap.data(); }
+
+        /**
+         * @brief Returns a pointer to the first word. Bits past size() must be left zero.
+         *
+         * @return uint64_t*
+         */
+        inline uint64_t *words() { return bitmap.data(); }
+
+        /**
+         * @brief Resizes to \p size bits, all set to \p value.
+         *
+         * @param size is the number of bits
+         * @param value is the value of every bit
+         */
+        void assign(const size_t size, const bool value);
+
+        /**
+         * @brief Returns bit \p index. No bounds checking is performed.
+         *
+         * @param index is the index of the bit
+         * @return bool
+         */
+        inline bool test(const size_t index) const { return (bitmap[index / 64] >> (index % 64)) & 1; }
+
+        /**
+         * @brief Sets bit \p index to \p value. No bounds checking is performed.
+         *
+         * @param index is the index of the bit
+         * @param value is the new value of the bit
+         */
+        inline void set(const size_t index, const bool value = true)
+        {
+            const uint64_t bit = uint64_t{1} << (index % 64);
+            bitmap[index / 64] = value ? bitmap[index / 64] | bit : bitmap[index / 64] & ~bit;
+        }
+
+        /**
+         * @brief Returns the number of set bits.
+         *
+         * @return size_t
+         */
+        size_t count() const;
+
+        /**
+         * @brief Returns the indices of the set bits in ascending order.
+         *
+         * @return std::vector<size_t>
+         */
+        std::vector<size_t> indices() const;
+
+        /**
+         * @brief Appends the indices of the set bits to \p out in ascending order.
+         *
+         * @param out is the destination of the indices
+         */
+        void indices(std::vector<size_t> &out) const;
+
+        /**
+         * @brief Keeps only the bits also set in \p other, which must be the same size.
+         *
+         * @return SelectionBitmap&
+         */
+        SelectionBitmap &operator&=(const SelectionBitmap &other);
+
+        /**
+         * @brief Sets the bits set in \p other, which must be the same size.
+         *
+         * @return SelectionBitmap&
+         */
+        SelectionBitmap &operator|=(const SelectionBitmap &other);
+
+        /**
+         * @brief Inverts every bit.
+         */
+        void flip();
+
+    private:
+        size_t bits;
+        std::pmr::vector<uint64_t> bitmap;
+    };
+
+    /**
+     * @brief True for the field types the kernels are provided for (i8 to u64, f32 and f64).
+     */
+    template <typename T>
+    constexpr bool is_kernel_type_v = std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t> ||
+                                      std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t> ||
+                                      std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> ||
+                                      std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t> ||
+                                      std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+    /**
+     * @brief Sum, minimum, maximum and count of a set of values. Integers are summed in 64 bits
+     * and floating point values in double precision. NaNs are included in the sum but never
+     * become the minimum or maximum. The minimum and maximum of no values are
+     * std::numeric_limits<T>::max() and std::numeric_limits<T>::lowest().
+     *
+     * @tparam T is the type of the values
+     */
+    template <typename T>
+    struct Aggregate
+    {
+        using sum_type = std::conditional_t<std::is_floating_point_v<T>, double,
+                                            std::conditional_t<std::is_signed_v<T>, int64_t, uint64_t>>;
+
+        sum_type sum = 0;
+        T min = std::numeric_limits<T>::max();
+        T max = std::numeric_limits<T>::lowest();
+        size_t count = 0;
+    };
+
+    namespace detail
+    {
+        template <typename T>
+        void filter(const T *values, size_t count, Compare op, T operand, uint64_t *words);
+        template <typename T>
+        void filter_range(const T *values, size_t count, T low, T high, uint64_t *words);
+        template <typename T>
+        Aggregate<T> aggregate(const T *values, size_t count, const uint64_t *words);
+    } // namespace detail
+
+    /**
+     * @brief Selects the values for which `value <op> operand` holds.
+     *
+     * @param values is the first value, such as Column::data()
+     * @param count is the number of values
+     * @param op is the comparison
+     * @param operand is the right hand side of the comparison
+     * @param selection receives one bit per value
+     */
+    template <typename T>
+    inline void filter(const T *values, const size_t count, const Compare op, const T operand, SelectionBitmap &selection)
+    {
+        static_assert(is_kernel_type_v<T>, "No kernel for this type");
+        selection.assign(count, false);
+        detail::filter(values, count, op, operand, selection.words());
+    }
+
+    /**
+     * @brief Selects the values of \p column for which `value <op> operand` holds.
+     *
+     * @return SelectionBitmap
+     */
+    template <typename T>
+    inline SelectionBitmap filter(const Column<T> &column, const Compare op, const T operand)
+    {
+        SelectionBitmap selection;
+        filter(column.data(), column.size(), op, operand, selection);
+        return selection;
+    }
+
+    /**
+     * @brief Selects the values within the closed range [low, high].
+     *
+     * @param values is the first value, such as Column::data()
+     * @param count is the number of values
+     * @param low is the smallest value selected
+     * @param high is the largest value selected
+     * @param selection receives one bit per value
+     */
+    template <typename T>
+    inline void filter_range(const T *values, const size_t count, const T low, const T high, SelectionBitmap &selection)
+    {
+        static_assert(is_kernel_type_v<T>, "No kernel for this type");
+        selection.assign(count, false);
+        detail::filter_range(values, count, low, high, selection.words());
+    }
+
+    /**
+     * @brief Selects the values of \p column within the closed range [low, high].
+     *
+     * @return SelectionBitmap
+     */
+    template <typename T>
+    inline SelectionBitmap filter_range(const Column<T> &column, const T low, const T high)
+    {
+        SelectionBitmap selection;
+        filter_range(column.data(), column.size(), low, high, selection);
+        return selection;
+    }
+
+    /**
+     * @brief Aggregates \p count values.
+     *
+     * @param values is the first value, such as Column::data()
+     * @param count is the number of values
+     * @return Aggregate<T>
+     */
+    template <typename T>
+    inline Aggregate<T> aggregate(const T *values, const size_t count)
+    {
+        static_assert(is_kernel_type_v<T>, "No kernel for this type");
+        return detail::aggregate(values, count, static_cast<const uint64_t *>(nullptr));
+    }
+
+    /**
+     * @brief Aggregates the values selected in \p selection, which must have one bit per value.
+     *
+     * @param values is the first value, such as Column::data()
+     * @param selection selects the values to aggregate
+     * @return Aggregate<T>
+     */
+    template <typename T>
+    inline Aggregate<T> aggregate(const T *values, const SelectionBitmap &selection)
+    {
+        static_assert(is_kernel_type_v<T>, "No kernel for this type");
+        return detail::aggregate(values, selection.size(), selection.words());
+    }
+
+    /**
+     * @brief Aggregates every value of \p column.
+     *
+     * @return Aggregate<T>
+     */
+    template <typename T>
+    inline Aggregate<T> aggregate(const Column<T> &column) { return aggregate(column.data(), column.size()); }
+
+    /**
+     * @brief Aggregates the values of \p column selected in \p selection.
+     *
+     * @return Aggregate<T>
+     */
+    template <typename T>
+    inline Aggregate<T> aggregate(const Column<T> &column, const SelectionBitmap &selection)
+    {
+        return aggregate(column.data(), selection);
+    }
+
+} // namespace SeriStruct
@@ -0,0 +1,264 @@
+// Compiled with AVX2 enabled. Only called after the processor has been checked for AVX2 support.
+#include "KernelsDetail.hpp"
+#include <immintrin.h>
+
+namespace SeriStruct
+{
+    namespace detail
+    {
+        namespace
+        {
+            template <typename T>
+            inline __m256i broadcast(const T value)
+            {
+                if constexpr (sizeof(T) == 1)
+                    return _mm256_set1_epi8(static_cast<char>(value));
+                else if constexpr (sizeof(T) == 2)
+                    return _mm256_set1_epi16(static_cast<short>(value));
+                else if constexpr (sizeof(T) == 4)
+                    return _mm256_set1_epi32(static_cast<int>(value));
+                else
+                    return _mm256_set1_epi64x(static_cast<long long>(value));
+            }
+
+            template <typename T>
+            struct Lanes
+            {
+                using vector = __m256i;
+                static constexpr size_t count = sizeof(vector) / sizeof(T);
+                static constexpr uint32_t all = count == 32 ? 0xFFFFFFFFu : (1u << count) - 1;
+
+                // AVX2 only has signed compares, so unsigned lanes get their sign bit flipped first
+                static inline vector to_signed(const vector v)
+                {
+                    if constexpr (std::is_signed_v<T>)
+                    {
+                        return v;
+                    }
+                    else
+                    {
+                        constexpr T sign_bit = static_cast<T>(T{1} << (sizeof(T) * 8 - 1));
+                        return _mm256_xor_si256(v, broadcast(sign_bit));
+                    }
+                }
+
+                static inline vector load(const T *values)
+                {
+                    return to_signed(_mm256_loadu_si256(reinterpret_cast<const vector *>(values)));
+                }
+
+                static inline vector splat(const T value) { return to_signed(broadcast(value)); }
+
+                static inline vector equal(const vector a, const vector b)
+                {
+                    if constexpr (sizeof(T) == 1)
+                        return _mm256_cmpeq_epi8(a, b);
+                    else if constexpr (sizeof(T) == 2)
+                        return _mm256_cmpeq_epi16(a, b);
+                    else if constexpr (sizeof(T) == 4)
+                        return _mm256_cmpeq_epi32(a, b);
+                    else
+                        return _mm256_cmpeq_epi64(a, b);
+                }
+
+                static inline vector greater(const vector a, const vector b)
+                {
+                    if constexpr (sizeof(T) == 1)
+                        return _mm256_cmpgt_epi8(a, b);
+                    else if constexpr (sizeof(T) == 2)
+                        return _mm256_cmpgt_epi16(a, b);
+                    else if constexpr (sizeof(T) == 4)
+                        return _mm256_cmpgt_epi32(a, b);
+                    else
+                        return _mm256_cmpgt_epi64(a, b);
+                }
+
+                // One bit per lane of a compare result
+                static inline uint32_t mask(const vector v)
+                {
+                    if constexpr (sizeof(T) == 1)
+                    {
+                        return static_cast<uint32_t>(_mm256_movemask_epi8(v));
+                    }
+                    else if constexpr (sizeof(T) == 2)
+                    {
+                        // narrow to bytes; packs works within each 128-bit half, so gather the halves after
+                        const vector packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(v, v), 0xD8);
+                        return static_cast<uint32_t>(_mm256_movemask_epi8(packed)) & 0xFFFFu;
+                    }
+                    else if constexpr (sizeof(T) == 4)
+                    {
+                        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(v)));
+                    }
+                    else
+                    {
+                        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_castsi256_pd(v)));
+                    }
+                }
+
+                template <Compare op>
+                static inline uint32_t compare(const vector v, const vector operand)
+                {
+                    if constexpr (op == Compare::equal)
+                        return mask(equal(v, operand));
+                    else if constexpr (op == Compare::not_equal)
+                        return ~mask(equal(v, operand)) & all;
+                    else if constexpr (op == Compare::less)
+                        return mask(greater(operand, v));
+                    else if constexpr (op == Compare::less_equal)
+                        return ~mask(greater(v, operand)) & all;
+                    else if constexpr (op == Compare::greater)
+                        return mask(greater(v, operand));
+                    else
+                        return ~mask(greater(operand, v)) & all;
+                }
+            };
+
+            template <>
+            struct Lanes<float>
+            {
+                using vector = __m256;
+                static constexpr size_t count = 8;
+
+                static inline vector load(const float *values) { return _mm256_loadu_ps(values); }
+                static inline vector splat(const float value) { return _mm256_set1_ps(value); }
+
+                template <Compare op>
+                static inline uint32_t compare(const vector v, const vector operand)
+                {
+                    // ordered predicates are false for NaN and not_equal is unordered, matching the scalar operators
+                    if constexpr (op == Compare::equal)
+                        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, operand, _CMP_EQ_OQ)));
+                    else if constexpr (op == Compare::not_equal)
+                        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, operand, _CMP_NEQ_UQ)));
+                    else if constexpr (op == Compare::less)
+                        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, operand, _CMP_LT_OQ)));
+                    else if constexpr (op == Compare::less_equal)
+                        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, operand, _CMP_LE_OQ)));
+                    else if constexpr (op == Compare::greater)
+                        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, operand, _CMP_GT_OQ)));
+                    else
+                        return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, operand, _CMP_GE_OQ)));
+                }
+            };
+
+            template <>
+            struct Lanes<double>
+            {
+                using vector = __m256d;
+                static constexpr size_t count = 4;
+
+                static inline vector load(const double *values) { return _mm256_loadu_pd(values); }
+                static inline vector splat(const double value) { return _mm256_set1_pd(value); }
+
+                template <Compare op>
+                static inline uint32_t compare(const vector v, const vector operand)
+                {
+                    // ordered predicates are false for NaN and not_equal is unordered, matching the scalar operators
+                    if constexpr (op == Compare::equal)
+                        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(v, operand, _CMP_EQ_OQ)));
+                    else if constexpr (op == Compare::not_equal)
+                        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(v, operand, _CMP_NEQ_UQ)));
+                    else if constexpr (op == Compare::less)
+                        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(v, operand, _CMP_LT_OQ)));
+                    else if constexpr (op == Compare::less_equal)
+                        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(v, operand, _CMP_LE_OQ)));
+                    else if constexpr (op == Compare::greater)
+                        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(v, operand, _CMP_GT_OQ)));
+                    else
+                        return static_cast<uint32_t>(_mm256_movemask_pd(_mm256_cmp_pd(v, operand, _CMP_GE_OQ)));
+                }
+            };
+
+            template <Compare op, typename T>
+            void filter_op(const T *values, const size_t count, const T operand, uint64_t *words)
+            {
+                using L = Lanes<T>;
+                const typename L::vector splat = L::splat(operand);
+                const size_t done = filter_words<L::count>(count, words, [&](const size_t i) {
+                    return L::template compare<op>(L::load(values + i), splat);
+                });
+                filter_tail(done, count, words, [&](const size_t i) { return detail::compare<op>(values[i], operand); });
+            }
+        } // namespace
+
+        template <typename T>
+        void filter_avx2(const T *values, const size_t count, const Compare op, const T operand, uint64_t *words)
+        {
+            with_compare(op, [&](auto c) { filter_op<decltype(c)::value>(values, count, operand, words); });
+        }
+
+        template <typename T>
+        void filter_range_avx2(const T *values, const size_t count, const T low, const T high, uint64_t *words)
+        {
+            using L = Lanes<T>;
+            const typename L::vector low_splat = L::splat(low);
+            const typename L::vector high_splat = L::splat(high);
+            const size_t done = filter_words<L::count>(count, words, [&](const size_t i) {
+                const typename L::vector v = L::load(values + i);
+                return L::template compare<Compare::greater_equal>(v, low_splat) &
+                       L::template compare<Compare::less_equal>(v, high_splat);
+            });
+            filter_tail(done, count, words, [&](const size_t i) { return values[i] >= low && values[i] <= high; });
+        }
+
+        template <typename T>
+        Aggregate<T> aggregate_avx2(const T *values, const size_t count, const uint64_t *words)
+        {
+            return aggregate_values(values, count, words);
+        }
+
+        void swap_chunks_avx2(unsigned char *records, const size_t count, const size_t stride,
+                              const unsigned char *masks, const uint32_t *blocks, const size_t block_count)
+        {
+            // the last block of a record may reach into the next one, whose bytes its mask leaves
+            // in place; only the end of the batch needs the scalar tail
+            const size_t total = count * stride;
+            for (size_t start = 0; start < total; start += stride)
+            {
+                for (size_t k = 0; k < block_count; k++)
+                {
+                    const size_t offset = size_t{blocks[k]} * 32;
+                    unsigned char *bytes = records + start + offset;
+                    if (start + offset + 32 <= total)
+                    {
+                        const __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(masks + offset));
+                        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bytes));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(bytes), _mm256_shuffle_epi8(v, mask));
+                    }
+                    else
+                    {
+                        swap_chunk_tail(bytes, masks + offset, total - start - offset);
+                    }
+                }
+            }
+        }
+
+        size_t masked_mismatch_avx2(const unsigned char *a, const unsigned char *b, const unsigned char *mask,
+                                    const size_t size, size_t start)
+        {
+            const __m256i zero = _mm256_setzero_si256();
+            for (; start + 32 <= size; start += 32)
+            {
+                const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + start));
+                const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + start));
+                const __m256i vm = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + start));
+                const __m256i differ = _mm256_and_si256(_mm256_xor_si256(va, vb), vm);
+                const uint32_t same = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(differ, zero)));
+                if (same != 0xFFFFFFFFu)
+                {
+                    return start + lowest_bit(~same & 0xFFFFFFFFu);
+                }
+            }
+            return masked_mismatch_tail(a, b, mask, size, start);
+        }
+
+#define SERISTRUCT_INSTANTIATE(T)                                                                 \
+    template void filter_avx2<T>(const T *, const size_t, const Compare, const T, uint64_t *);    \
+    template void filter_range_avx2<T>(const T *, const size_t, const T, const T, uint64_t *);   \
+    template Aggregate<T> aggregate_avx2<T>(const T *, const size_t, const uint64_t *);
+        SERISTRUCT_KERNEL_TYPES(SERISTRUCT_INSTANTIATE)
+#undef SERISTRUCT_INSTANTIATE
+
+    } // namespace detail
+} // namespace SeriStruct
@@ -0,0 +1,276 @@
+#pragma once
+#include "Kernels.hpp"
+#include <limits>
+#include <type_traits>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/*
+ * Private to the library: shared by Kernels.cpp and the instruction set specific translation units
+ * (KernelsSse42.cpp, KernelsAvx2.cpp), which are compiled with different target flags. Helpers
+ * defined here have internal linkage so that each translation unit keeps the copy built for its own
+ * instruction set. For the same reason they avoid calling inline functions from other headers (including
+ * the standard library and default constructors): the linker may keep any one of the copies of such a
+ * function, and an AVX2 build of it must never end up on the scalar path.
+ */
+
+#define SERISTRUCT_KERNEL_TYPES(X) \
+    X(int8_t)                      \
+    X(int16_t)                     \
+    X(int32_t)                     \
+    X(int64_t)                     \
+    X(uint8_t)                     \
+    X(uint16_t)                    \
+    X(uint32_t)                    \
+    X(uint64_t)                    \
+    X(float)                       \
+    X(double)
+
+namespace SeriStruct
+{
+    namespace detail
+    {
+        // Entry points of each instruction set. words, when given to aggregate, selects the values.
+        template <typename T>
+        void filter_sse42(const T *values, size_t count, Compare op, T operand, uint64_t *words);
+        template <typename T>
+        void filter_range_sse42(const T *values, size_t count, T low, T high, uint64_t *words);
+        template <typename T>
+        Aggregate<T> aggregate_sse42(const T *values, size_t count, const uint64_t *words);
+
+        template <typename T>
+        void filter_avx2(const T *values, size_t count, Compare op, T operand, uint64_t *words);
+        template <typename T>
+        void filter_range_avx2(const T *values, size_t count, T low, T high, uint64_t *words);
+        template <typename T>
+        Aggregate<T> aggregate_avx2(const T *values, size_t count, const uint64_t *words);
+
+        // Byte order conversion: applies the shuffle masks of a ByteOrderPlan to the listed 16 byte
+        // (SSE4.2) or 32 byte (AVX2) chunks of each of count records
+        void swap_chunks_sse42(unsigned char *records, size_t count, size_t stride,
+                               const unsigned char *masks, const uint32_t *chunks, size_t chunk_count);
+        void swap_chunks_avx2(unsigned char *records, size_t count, size_t stride,
+                              const unsigned char *masks, const uint32_t *blocks, size_t block_count);
+
+        // Record comparison: returns the first index from start to size at which the bytes of a and b
+        // differ where mask is non-zero, or size if there is none
+        size_t masked_mismatch_sse42(const unsigned char *a, const unsigned char *b, const unsigned char *mask,
+                                     size_t size, size_t start);
+        size_t masked_mismatch_avx2(const unsigned char *a, const unsigned char *b, const unsigned char *mask,
+                                    size_t size, size_t start);
+
+        namespace
+        {
+            // Index of the lowest set bit of a non-zero word
+            inline unsigned lowest_bit(const uint64_t word)
+            {
+#if defined(_MSC_VER)
+                unsigned long index;
+                _BitScanForward64(&index, word);
+                return static_cast<unsigned>(index);
+#else
+                return static_cast<unsigned>(__builtin_ctzll(word));
+#endif
+            }
+
+            template <Compare op, typename T>
+            inline bool compare(const T value, const T operand)
+            {
+                if constexpr (op == Compare::equal)
+                    return value == operand;
+                else if constexpr (op == Compare::not_equal)
+                    return value != operand;
+                else if constexpr (op == Compare::less)
+                    return value < operand;
+                else if constexpr (op == Compare::less_equal)
+                    return value <= operand;
+                else if constexpr (op == Compare::greater)
+                    return value > operand;
+                else
+                    return value >= operand;
+            }
+
+            // Calls function with the comparison as a compile time constant
+            template <typename Function>
+            inline void with_compare(const Compare op, Function function)
+            {
+                switch (op)
+                {
+                case Compare::equal:
+                    function(std::integral_constant<Compare, Compare::equal>{});
+                    break;
+                case Compare::not_equal:
+                    function(std::integral_constant<Compare, Compare::not_equal>{});
+                    break;
+                case Compare::less:
+                    function(std::integral_constant<Compare, Compare::less>{});
+                    break;
+                case Compare::less_equal:
+                    function(std::integral_constant<Compare, Compare::less_equal>{});
+                    break;
+                case Compare::greater:
+                    function(std::integral_constant<Compare, Compare::greater>{});
+                    break;
+                case Compare::greater_equal:
+                    function(std::integral_constant<Compare, Compare::greater_equal>{});
+                    break;
+                }
+            }
+
+            // Fills every whole word from block(i), which returns one bit per lane for values
+            // [i, i + Lanes). Returns the number of values covered, a multiple of 64.
+            template <size_t Lanes, typename Block>
+            inline size_t filter_words(const size_t count, uint64_t *words, Block block)
+            {
+                static_assert(64 % Lanes == 0, "Lanes must divide a word");
+                const size_t whole_words = count / 64;
+                for (size_t w = 0; w < whole_words; w++)
+                {
+                    uint64_t word = 0;
+                    for (size_t k = 0; k < 64 / Lanes; k++)
+                    {
+                        word |= static_cast<uint64_t>(block(w * 64 + k * Lanes)) << (k * Lanes);
+                    }
+                    words[w] = word;
+                }
+                return whole_words * 64;
+            }
+
+            // Fills the words for values [first, count) one value at a time. first must be a multiple of 64.
+            template <typename Predicate>
+            inline void filter_tail(const size_t first, const size_t count, uint64_t *words, Predicate predicate)
+            {
+                for (size_t w = first / 64; w * 64 < count; w++)
+                {
+                    uint64_t word = 0;
+                    const size_t end = count < w * 64 + 64 ? count : w * 64 + 64;
+                    for (size_t i = w * 64; i < end; i++)
+                    {
+                        word |= static_cast<uint64_t>(predicate(i)) << (i % 64);
+                    }
+                    words[w] = word;
+                }
+            }
+
+            template <typename T>
+            inline Aggregate<T> empty_aggregate()
+            {
+                constexpr T highest = std::numeric_limits<T>::max();
+                constexpr T lowest = std::numeric_limits<T>::lowest();
+                return Aggregate<T>{0, highest, lowest, 0};
+            }
+
+            template <typename T>
+            inline void merge(Aggregate<T> &total, const Aggregate<T> &part)
+            {
+                total.sum += part.sum;
+                total.min = part.min < total.min ? part.min : total.min;
+                total.max = total.max < part.max ? part.max : total.max;
+                total.count += part.count;
+            }
+
+            // Independent accumulators per lane let the compiler vectorize the loop with whatever
+            // instruction set the translation unit targets. The summation order is fixed, so
+            // floating point sums are identical on every code path.
+            template <typename T>
+            Aggregate<T> aggregate_dense(const T *values, const size_t count)
+            {
+                using Sum = typename Aggregate<T>::sum_type;
+                constexpr size_t lanes = 8;
+                Sum sums[lanes] = {};
+                T mins[lanes];
+                T maxs[lanes];
+                for (size_t l = 0; l < lanes; l++)
+                {
+                    mins[l] = empty_aggregate<T>().min;
+                    maxs[l] = empty_aggregate<T>().max;
+                }
+
+                size_t i = 0;
+                for (; i + lanes <= count; i += lanes)
+                {
+                    for (size_t l = 0; l < lanes; l++)
+                    {
+                        const T value = values[i + l];
+                        sums[l] += static_cast<Sum>(value);
+                        mins[l] = value < mins[l] ? value : mins[l];
+                        maxs[l] = maxs[l] < value ? value : maxs[l];
+                    }
+                }
+                for (size_t l = 0; i < count; i++, l++)
+                {
+                    const T value = values[i];
+                    sums[l] += static_cast<Sum>(value);
+                    mins[l] = value < mins[l] ? value : mins[l];
+                    maxs[l] = maxs[l] < value ? value : maxs[l];
+                }
+
+                Aggregate<T> result = empty_aggregate<T>();
+                for (size_t l = 0; l < lanes; l++)
+                {
+                    merge(result, Aggregate<T>{sums[l], mins[l], maxs[l], 0});
+                }
+                result.count = count;
+                return result;
+            }
+
+            template <typename T>
+            Aggregate<T> aggregate_values(const T *values, const size_t count, const uint64_t *words)
+            {
+                if (!words)
+                {
+                    return aggregate_dense(values, count);
+                }
+
+                Aggregate<T> result = empty_aggregate<T>();
+                for (size_t w = 0; w * 64 < count; w++)
+                {
+                    uint64_t word = words[w];
+                    if (word == ~uint64_t{0})
+                    {
+                        merge(result, aggregate_dense(values + w * 64, 64));
+                        continue;
+                    }
+                    while (word)
+                    {
+                        const T value = values[w * 64 + lowest_bit(word)];
+                        word &= word - 1;
+                        merge(result, Aggregate<T>{static_cast<typename Aggregate<T>::sum_type>(value), value, value, 1});
+                    }
+                }
+                return result;
+            }
+
+            // Applies shuffle masks to the last length bytes of a batch, where a full vector would
+            // read past its end. Mask values index within their own 16 byte chunk.
+            inline void swap_chunk_tail(unsigned char *chunk, const unsigned char *mask, const size_t length)
+            {
+                unsigned char copy[32];
+                for (size_t i = 0; i < length; i++)
+                {
+                    copy[i] = chunk[i];
+                }
+                for (size_t i = 0; i < length; i++)
+                {
+                    chunk[i] = copy[(i & ~size_t{15}) + mask[i]];
+                }
+            }
+
+            // Compares the bytes from start to size one at a time, for the end of a record where a full
+            // vector would read past it
+            inline size_t masked_mismatch_tail(const unsigned char *a, const unsigned char *b, const unsigned char *mask,
+                                               const size_t size, size_t start)
+            {
+                for (; start < size; start++)
+                {
+                    if ((a[start] ^ b[start]) & mask[start])
+                    {
+                        return start;
+                    }
+                }
+                return size;
+            }
+        } // namespace
+    } // namespace detail
+} // namespace SeriStruct
@@ -0,0 +1,118 @@
+#include "MappedFile.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        int to_madvise(const MappedFile::Advice advice)
+        {
+            switch (advice)
+            {
+            case MappedFile::Advice::sequential:
+                return MADV_SEQUENTIAL;
+            case MappedFile::Advice::random:
+                return MADV_RANDOM;
+            case MappedFile::Advice::will_need:
+                return MADV_WILLNEED;
+            case MappedFile::Advice::dont_need:
+                return MADV_DONTNEED;
+            default:
+                return MADV_NORMAL;
+            }
+        }
+    } // namespace
+
+    MappedFile::MappedFile(const std::string &path)
+        : mapping{nullptr}, length{0}
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw std::system_error{errno, std::generic_category(), "Cannot open " + path};
+        }
+
+        struct stat status;
+        if (::fstat(fd, &status) != 0)
+        {
+            const int error = errno;
+            ::close(fd);
+            throw std::system_error{error, std::generic_category(), "Cannot stat " + path};
+        }
+
+        // mmap rejects empty mappings, so an empty file is left unmapped
+        if (status.st_size > 0)
+        {
+            void *address = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (address == MAP_FAILED)
+            {
+                const int error = errno;
+                ::close(fd);
+                throw std::system_error{error, std::generic_category(), "Cannot map " + path};
+            }
+            mapping = static_cast<const unsigned char *>(address);
+            length = static_cast<size_t>(status.st_size);
+        }
+        // the mapping keeps the file alive
+        ::close(fd);
+    }
+
+    MappedFile::MappedFile(MappedFile &&other) noexcept
+        : mapping{std::exchange(other.mapping, nullptr)}, length{std::exchange(other.length, 0)}
+    {
+    }
+
+    MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            mapping = std::exchange(other.mapping, nullptr);
+            length = std::exchange(other.length, 0);
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile() noexcept
+    {
+        unmap();
+    }
+
+    void MappedFile::advise(const Advice advice) const
+    {
+        advise(advice, 0, length);
+    }
+
+    void MappedFile::advise(const Advice advice, const size_t offset, const size_t count) const
+    {
+        if (!mapping || offset >= length || count == 0)
+        {
+            return;
+        }
+        // madvise needs a page aligned start
+        const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t start = offset / page * page;
+        const size_t end = count > length - offset ? length : offset + count;
+        if (::madvise(const_cast<unsigned char *>(mapping) + start, end - start, to_madvise(advice)) != 0)
+        {
+            throw std::system_error{errno, std::generic_category(), "madvise failed"};
+        }
+    }
+
+    void MappedFile::unmap() noexcept
+    {
+        if (mapping)
+        {
+            ::munmap(const_cast<unsigned char *>(mapping), length);
+            mapping = nullptr;
+            length = 0;
+        }
+    }
+
+} // namespace SeriStruct
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace SeriStruct
+{
+    /**
+     * @brief A read-only, shared memory mapping of a whole file. Opening is constant time: pages are
+     * read on first access and come from the page cache, so processes mapping the same file share
+     * one copy of it.
+     *
+     * Errors from the operating system are reported as std::system_error.
+     */
+    class MappedFile
+    {
+    public:
+        /**
+         * @brief Expected access pattern, passed to the kernel as a hint for read-ahead and caching.
+         */
+        enum class Advice
+        {
+            /** No special treatment */
+            normal,
+            /** Pages will be read in order; read ahead aggressively and drop them soon after */
+            sequential,
+            /** Pages will be read in no particular order; do not read ahead */
+            random,
+            /** Pages will be needed soon; start reading them now */
+            will_need,
+            /** Pages will not be needed soon; they may be dropped from memory */
+            dont_need
+        };
+
+        /**
+         * @brief Construct a new MappedFile object by mapping the file at \p path.
+         *
+         * @param path is the path of the file to map
+         *
+         * @exception std::system_error if the file cannot be opened or mapped
+         */
+        explicit MappedFile(const std::string &path);
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+        MappedFile(MappedFile &&other) noexcept;
+        MappedFile &operator=(MappedFile &&other) noexcept;
+
+        /**
+         * @brief Destroy the MappedFile object, unmapping the file.
+         */
+        ~MappedFile() noexcept;
+
+        /**
+         * @brief Returns the size of the file in bytes.
+         *
+         * @return size_t
+         */
+        inline size_t size() const { return length; }
+
+        /**
+         * @brief Returns a pointer to the first byte of the file, or nullptr if the file is empty.
+         *
+         * @return const unsigned char*
+         */
+        inline const unsigned char *data() const { return mapping; }
+
+        /**
+         * @brief Tells the kernel how the whole file will be accessed.
+         *
+         * @param advice is the expected access pattern
+         *
+         * @exception std::system_error if the kernel rejects the hint
+         */
+        void advise(const Advice advice) const;
+
+        /**
+         * @brief Tells the kernel how the bytes [offset, offset + count) will be accessed. The
+         * range is widened to whole pages.
+         *
+         * @param advice is the expected access pattern
+         * @param offset is the offset of the first byte
+         * @param count is the number of bytes
+         *
+         * @exception std::system_error if the kernel rejects the hint
+         */
+        void advise(const Advice advice, const size_t offset, const size_t count) const;
+
+    private:
+        const unsigned char *mapping;
+        size_t length;
+
+        void unmap() noexcept;
+    };
+
+} // namespace SeriStruct
@@ -0,0 +1,174 @@
+#pragma once
+#include "MappedFile.hpp"
+#include "RecordArray.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace SeriStruct
+{
+    /**
+     * @brief A file of records of one generated type, such as one produced by write_many() or
+     * RecordArray::write(), mapped into memory. Records are read in place through zero-copy
+     * T::View objects, so opening is instant regardless of the file size and random access is
+     * constant time.
+     *
+     * The file must not be truncated while it is mapped.
+     *
+     * @tparam T is a generated record type
+     */
+    template <typename T>
+    class MappedRecordFile
+    {
+        static_assert(T::has_fixed_size, "Records with vstr fields vary in size");
+
+    public:
+        using value_type = T;
+        using view_type = typename T::View;
+        using const_iterator = typename RecordArray<T>::const_iterator;
+        using Advice = MappedFile::Advice;
+
+        /**
+         * @brief Distance in bytes between consecutive records
+         */
+        static constexpr size_t stride = T::buffer_size;
+
+        /**
+         * @brief Construct a new MappedRecordFile object by mapping the file at \p path.
+         *
+         * @param path is the path of the file to map
+         * @param header_size is the number of bytes before the first record
+         *
+         * @exception std::system_error if the file cannot be opened or mapped
+         * @exception SeriStruct::invalid_size if the file does not hold a whole number of records after the header
+         */
+        explicit MappedRecordFile(const std::string &path, const size_t header_size = 0)
+            : file{path}, header_size{header_size}
+        {
+            if (file.size() < header_size || (file.size() - header_size) % stride != 0)
+            {
+                throw invalid_size{};
+            }
+        }
+
+        /**
+         * @brief Returns the number of records in the file.
+         *
+         * @return size_t
+         */
+        inline size_t size() const { return size_bytes() / stride; }
+
+        /**
+         * @brief Returns true if the file holds no records.
+         *
+         * @return bool
+         */
+        inline bool empty() const { return size_bytes() == 0; }
+
+        /**
+         * @brief Returns the size of the records in bytes, excluding the header.
+         *
+         * @return size_t
+         */
+        inline size_t size_bytes() const { return file.size() - header_size; }
+
+        /**
+         * @brief Returns a pointer to the first byte of the first record.
+         *
+         * @return const unsigned char*
+         */
+        inline const unsigned char *data() const { return file.data() ? file.data() + header_size : nullptr; }
+
+        /**
+         * @brief Returns the underlying mapping, including the header.
+         *
+         * @return const MappedFile&
+         */
+        inline const MappedFile &mapped_file() const { return file; }
+
+        /**
+         * @brief Returns a view of the record at \p index. No bounds checking is performed.
+         *
+         * @param index is the index of the record
+         * @return view_type
+         */
+        inline view_type operator[](const size_t index) const { return view_type{data() + index * stride, stride}; }
+
+        /**
+         * @brief Returns a view of the record at \p index.
+         *
+         * @param index is the index of the record
+         * @return view_type
+         *
+         * @exception std::out_of_range if \p index >= size()
+         */
+        inline view_type at(const size_t index) const
+        {
+            if (index >= size())
+            {
+                throw std::out_of_range{"MappedRecordFile index out of range"};
+            }
+            return (*this)[index];
+        }
+
+        /**
+         * @brief Returns a view of the first record. The file must not be empty.
+         *
+         * @return view_type
+         */
+        inline view_type front() const { return (*this)[0]; }
+
+        /**
+         * @brief Returns a view of the last record. The file must not be empty.
+         *
+         * @return view_type
+         */
+        inline view_type back() const { return (*this)[size() - 1]; }
+
+        /**
+         * @brief Returns an iterator to the first record.
+         *
+         * @return const_iterator
+         */
+        inline const_iterator begin() const { return const_iterator{data()}; }
+
+        /**
+         * @brief Returns an iterator past the last record.
+         *
+         * @return const_iterator
+         */
+        inline const_iterator end() const { return const_iterator{data() + size_bytes()}; }
+
+        /**
+         * @brief Returns an owning copy of the record at \p index.
+         *
+         * @param index is the index of the record
+         * @return T
+         */
+        inline T get(const size_t index) const { return T{data() + index * stride, stride}; }
+
+        /**
+         * @brief Tells the kernel how the records will be accessed, for example Advice::sequential
+         * before a full scan or Advice::random before point lookups.
+         *
+         * @param advice is the expected access pattern
+         */
+        inline void advise(const Advice advice) const { file.advise(advice); }
+
+        /**
+         * @brief Tells the kernel how records [first, first + count) will be accessed.
+         *
+         * @param advice is the expected access pattern
+         * @param first is the index of the first record
+         * @param count is the number of records
+         */
+        inline void advise(const Advice advice, const size_t first, const size_t count) const
+        {
+            file.advise(advice, header_size + first * stride, count * stride);
+        }
+
+    private:
+        MappedFile file;
+        size_t header_size;
+    };
+
+} // namespace SeriStruct
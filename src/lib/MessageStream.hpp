@@ -0,0 +1,316 @@
+#pragma once
+#include "RecordArray.hpp"
+#include "RecordStream.hpp"
+#include "SeriStruct.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Compile time list of the generated record types carried by one stream. Each type is
+     * given a dense index, its position in the list, and is recognized on the wire by its fingerprint.
+     *
+     * @tparam Ts are generated record types with distinct fingerprints
+     */
+    template <typename... Ts>
+    struct MessageTypes
+    {
+        static constexpr size_t count = sizeof...(Ts);
+        static constexpr uint64_t fingerprints[] = {Ts::fingerprint...};
+        static constexpr size_t record_sizes[] = {Ts::buffer_size...};
+
+        /**
+         * @brief Returns the index of the type with \p fingerprint, or count if there is none.
+         *
+         * @param fingerprint is a record fingerprint
+         * @return size_t
+         */
+        static constexpr size_t index_of(const uint64_t fingerprint)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (fingerprints[i] == fingerprint)
+                {
+                    return i;
+                }
+            }
+            return count;
+        }
+
+        /**
+         * @brief Index of \p T in the list
+         *
+         * @tparam T is one of Ts
+         */
+        template <typename T>
+        static constexpr size_t index = index_of(T::fingerprint);
+
+        /**
+         * @brief True if \p T is one of Ts
+         *
+         * @tparam T is a generated record type
+         */
+        template <typename T>
+        static constexpr bool contains = (std::is_same_v<T, Ts> || ...);
+
+        /**
+         * @brief Returns true if no two types share a fingerprint, so every type can be told apart.
+         *
+         * @return bool
+         */
+        static constexpr bool distinct()
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                if (index_of(fingerprints[i]) != i)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief Writes records of several generated types to one stream. Each call writes one frame
+     * (see RecordStream.hpp) tagged with the type's fingerprint.
+     *
+     * @tparam Ts are the generated record types that may be written
+     */
+    template <typename... Ts>
+    class MessageWriter
+    {
+    public:
+        using types = MessageTypes<Ts...>;
+        static_assert(sizeof...(Ts) > 0, "A message stream needs at least one record type");
+        static_assert(types::distinct(), "Record types of a message stream must have distinct fingerprints");
+        static_assert((Ts::has_fixed_size && ...), "Records with vstr fields vary in size");
+
+        /**
+         * @brief Construct a new MessageWriter object
+         *
+         * @param ostr is a std::ostream ready for writing, which must outlive this object
+         */
+        explicit MessageWriter(std::ostream &ostr) : ostr{ostr} {}
+
+        /**
+         * @brief Writes \p record as a frame of one record.
+         *
+         * @tparam T is one of Ts
+         * @param record is the record to write
+         */
+        template <typename T>
+        void write(const T &record)
+        {
+            static_assert(types::template contains<T>, "Record type is not part of this message stream");
+            write_frame(ostr, T::fingerprint, T::buffer_size, record.data(), 1);
+        }
+
+        /**
+         * @brief Writes the record viewed by \p view as a frame of one record.
+         *
+         * @tparam T is one of Ts
+         * @param view is a view of the record to write
+         */
+        template <typename T>
+        void write_view(const typename T::View &view)
+        {
+            static_assert(types::template contains<T>, "Record type is not part of this message stream");
+            write_frame(ostr, T::fingerprint, T::buffer_size, view.data(), 1);
+        }
+
+        /**
+         * @brief Writes every record in \p records as one frame.
+         *
+         * @tparam T is one of Ts
+         * @param records is the batch of records to write
+         */
+        template <typename T>
+        void write(const RecordArray<T> &records)
+        {
+            static_assert(types::template contains<T>, "Record type is not part of this message stream");
+            write_frame(ostr, records);
+        }
+
+    private:
+        std::ostream &ostr;
+    };
+
+    /**
+     * @brief Reads frames of several generated types and hands each record to a visitor as a
+     * zero-copy view.
+     *
+     * A frame's fingerprint is mapped to the type's dense index (the last type seen is checked first)
+     * and the index selects the handler from a table of function pointers built at compile time, so
+     * dispatch costs no virtual calls and no allocation. The visitor must be callable with a
+     * `const T::View &` of each of Ts, e.g. a generic lambda or a struct with one overload per type.
+     * Views are only valid during the call.
+     *
+     * @tparam Ts are the generated record types that may be read
+     */
+    template <typename... Ts>
+    class MessageReader
+    {
+    public:
+        using types = MessageTypes<Ts...>;
+        static_assert(sizeof...(Ts) > 0, "A message stream needs at least one record type");
+        static_assert(types::distinct(), "Record types of a message stream must have distinct fingerprints");
+        static_assert((Ts::has_fixed_size && ...), "Records with vstr fields vary in size");
+
+        /**
+         * @brief Largest number of bytes read() reads from the stream at a time
+         */
+        static constexpr size_t read_block_size = 1024 * 1024;
+
+        /**
+         * @brief Construct a new MessageReader object
+         *
+         * @param istr is an open stream for reading the bytes, which must outlive this object
+         */
+        explicit MessageReader(std::istream &istr) : istr{istr}, last_index{0} {}
+
+        /**
+         * @brief Reads the next frame and calls \p visitor with a view of each of its records.
+         *
+         * @param visitor is called once per record
+         * @return true if a frame was read
+         * @return false if the stream was already at EOF
+         *
+         * @exception SeriStruct::schema_mismatch if the frame holds a type that is not one of Ts
+         * @exception SeriStruct::not_enough_data if EOF is reached part way through the frame
+         * @exception SeriStruct::invalid_size if the bytes are not a frame, or it holds too many records to fit in memory
+         */
+        template <typename Visitor>
+        bool read(Visitor &&visitor)
+        {
+            FrameHeader header;
+            if (!read_frame_header(istr, header))
+            {
+                return false;
+            }
+            const size_t index = lookup(header, last_index);
+            // the header is untrusted, so the size of the records must not overflow
+            if (header.record_count > std::numeric_limits<size_t>::max() / header.record_size)
+            {
+                throw invalid_size{};
+            }
+            const size_t size = static_cast<size_t>(header.record_size * header.record_count);
+            // read in blocks and grow only by what arrived, so an untrusted count cannot allocate more than
+            // the stream holds. The buffer only grows, so a warmed up reader does not allocate.
+            for (size_t at = 0; at < size;)
+            {
+                const size_t block = std::min(size - at, read_block_size);
+                if (buffer.size() < at + block)
+                {
+                    buffer.resize(at + block);
+                }
+                istr.read(reinterpret_cast<char *>(buffer.data() + at), static_cast<std::streamsize>(block));
+                if (static_cast<size_t>(istr.gcount()) != block)
+                {
+                    throw not_enough_data{};
+                }
+                at += block;
+            }
+            table<Visitor>[index](visitor, buffer.data(), static_cast<size_t>(header.record_count));
+            return true;
+        }
+
+        /**
+         * @brief Reads frames until EOF.
+         *
+         * @param visitor is called once per record
+         * @return size_t is the number of frames read
+         */
+        template <typename Visitor>
+        size_t read_all(Visitor &&visitor)
+        {
+            size_t frames = 0;
+            while (read(visitor))
+            {
+                frames++;
+            }
+            return frames;
+        }
+
+        /**
+         * @brief Calls \p visitor with a view of every record in the whole frames at the start of
+         * \p bytes, without copying them.
+         *
+         * @param bytes holds frames back to back, e.g. a received message or a mapped file
+         * @param size is the number of bytes available in \p bytes
+         * @param visitor is called once per record
+         * @return size_t is the number of bytes in whole frames; the rest starts an incomplete frame
+         *
+         * @exception SeriStruct::schema_mismatch if a frame holds a type that is not one of Ts
+         * @exception SeriStruct::invalid_size if the bytes are not frames
+         */
+        template <typename Visitor>
+        static size_t dispatch(const unsigned char *bytes, const size_t size, Visitor &&visitor)
+        {
+            size_t offset = 0;
+            size_t index = 0;
+            FrameHeader header;
+            while (read_frame_header(bytes + offset, size - offset, header))
+            {
+                index = lookup(header, index);
+                // divide rather than multiply, so an untrusted count cannot overflow past the check
+                if (header.record_count > (size - offset - FrameHeader::size) / header.record_size)
+                {
+                    break;
+                }
+                const size_t records = static_cast<size_t>(header.record_size * header.record_count);
+                table<Visitor>[index](visitor, bytes + offset + FrameHeader::size, static_cast<size_t>(header.record_count));
+                offset += FrameHeader::size + records;
+            }
+            return offset;
+        }
+
+    private:
+        std::istream &istr;
+        std::vector<unsigned char> buffer;
+        size_t last_index;
+
+        template <typename Visitor>
+        using Handler = void (*)(Visitor &, const unsigned char *, size_t);
+
+        template <typename T, typename Visitor>
+        static void visit(Visitor &visitor, const unsigned char *records, const size_t count)
+        {
+            for (size_t i = 0; i < count; i++, records += T::buffer_size)
+            {
+                visitor(typename T::View{records, T::buffer_size});
+            }
+        }
+
+        template <typename Visitor>
+        static constexpr Handler<std::remove_reference_t<Visitor>> table[] = {&visit<Ts, std::remove_reference_t<Visitor>>...};
+
+        // Maps the frame's fingerprint to its type index, trying the previous frame's type first
+        static size_t lookup(const FrameHeader &header, size_t &last)
+        {
+            size_t index = last;
+            if (types::fingerprints[index] != header.fingerprint)
+            {
+                index = types::index_of(header.fingerprint);
+                if (index == types::count)
+                {
+                    throw schema_mismatch{};
+                }
+                last = index;
+            }
+            if (header.record_size != types::record_sizes[index])
+            {
+                throw schema_mismatch{};
+            }
+            return index;
+        }
+    };
+
+} // namespace SeriStruct
@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/*
+ * Private to the library: splits work over a range of items between threads, for the sorts and index
+ * builds. Each call starts its threads and joins them before returning.
+ */
+
+namespace SeriStruct
+{
+    namespace
+    {
+        // below this many records per thread, starting the thread costs more than it saves
+        constexpr size_t min_records_per_thread = size_t{1} << 14;
+
+        /**
+         * Number of threads to split count items between: threads, or one per hardware thread if 0, but no
+         * more than leaves min_per_thread items to each
+         */
+        inline unsigned thread_count(const size_t count, const unsigned threads, const size_t min_per_thread)
+        {
+            const size_t wanted = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+            return static_cast<unsigned>(std::min(wanted, std::max<size_t>(1, count / min_per_thread)));
+        }
+
+        // First item of slice of count items split into threads equal slices
+        inline size_t slice_begin(const size_t count, const unsigned threads, const unsigned slice)
+        {
+            return count / threads * slice + std::min<size_t>(slice, count % threads);
+        }
+
+        // Runs work(slice, begin, end) on each of threads equal slices of [0, count), the first on this thread
+        template <typename Work>
+        void parallel_slices(const size_t count, const unsigned threads, const Work &work)
+        {
+            std::vector<std::thread> workers;
+            workers.reserve(threads - 1);
+            try
+            {
+                for (unsigned t = 1; t < threads; t++)
+                {
+                    workers.emplace_back(work, t, slice_begin(count, threads, t), slice_begin(count, threads, t + 1));
+                }
+            }
+            catch (...)
+            {
+                for (auto &worker : workers)
+                {
+                    worker.join();
+                }
+                throw;
+            }
+            work(0u, size_t{0}, slice_begin(count, threads, 1));
+            for (auto &worker : workers)
+            {
+                worker.join();
+            }
+        }
+    } // namespace
+} // namespace SeriStruct
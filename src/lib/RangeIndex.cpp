@@ -0,0 +1,165 @@
+#include "RangeIndex.hpp"
+#include "ParallelDetail.hpp"
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        // Number of keys at each level, from the leaves up to the root
+        std::vector<size_t> level_sizes(const size_t count, const size_t fanout)
+        {
+            std::vector<size_t> sizes{count};
+            while (sizes.back() > fanout)
+            {
+                sizes.push_back((sizes.back() + fanout - 1) / fanout);
+            }
+            return sizes;
+        }
+
+        inline size_t whole_nodes(const size_t keys, const size_t fanout)
+        {
+            return (keys + fanout - 1) / fanout * fanout;
+        }
+
+        inline bool valid_node_size(const uint64_t node_size)
+        {
+            return node_size >= RangeIndexHeader::size && (node_size & (node_size - 1)) == 0;
+        }
+    } // namespace
+
+    void RangeIndexFile::build(const unsigned char *records, const size_t count, const size_t stride, const FieldInfo *fields,
+                               const size_t field_count, const char *name, const uint64_t schema, const std::string &path,
+                               const size_t node_size, const unsigned threads)
+    {
+        const SortKey key = sort_key(fields, field_count, name);
+        if (!valid_node_size(node_size))
+        {
+            throw invalid_size{};
+        }
+        const size_t fanout = node_size / sizeof(uint64_t);
+
+        std::vector<size_t> order(count);
+        radix_sort_index(records, count, stride, key, order.data(), threads);
+
+        // the leaves, then each level above them, padded with keys past every real one
+        const std::vector<size_t> sizes = level_sizes(count, fanout);
+        std::vector<std::vector<uint64_t>> levels(sizes.size());
+        levels[0].assign(whole_nodes(count, fanout), std::numeric_limits<uint64_t>::max());
+        std::vector<uint64_t> ordinals(count);
+        const unsigned used = thread_count(count, threads, min_records_per_thread);
+        parallel_slices(count, used, [&](const unsigned, const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                levels[0][i] = sort_bits(records + order[i] * stride, key);
+                ordinals[i] = order[i];
+            }
+        });
+        for (size_t level = 1; level < sizes.size(); level++)
+        {
+            const std::vector<uint64_t> &below = levels[level - 1];
+            levels[level].assign(whole_nodes(sizes[level], fanout), std::numeric_limits<uint64_t>::max());
+            for (size_t child = 0; child < sizes[level]; child++)
+            {
+                // largest key of the child
+                levels[level][child] = below[std::min((child + 1) * fanout, sizes[level - 1]) - 1];
+            }
+        }
+
+        RangeIndexHeader header{};
+        std::memcpy(header.magic, RangeIndexHeader::magic_value, sizeof(header.magic));
+        header.schema = schema;
+        header.record_size = stride;
+        header.record_count = count;
+        header.node_size = node_size;
+        header.key_offset = key.offset;
+        header.key_width = key.width;
+        header.key_kind = static_cast<uint8_t>(key.kind);
+
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        // the header takes a whole node, so every node is aligned to its size
+        std::vector<char> first_node(node_size, 0);
+        std::memcpy(first_node.data(), &header, sizeof(header));
+        out.write(first_node.data(), static_cast<std::streamsize>(first_node.size()));
+        for (auto level = levels.rbegin(); level != levels.rend(); ++level)
+        {
+            out.write(reinterpret_cast<const char *>(level->data()), static_cast<std::streamsize>(level->size() * sizeof(uint64_t)));
+        }
+        out.write(reinterpret_cast<const char *>(ordinals.data()), static_cast<std::streamsize>(ordinals.size() * sizeof(uint64_t)));
+        out.close();
+        if (!out)
+        {
+            throw std::system_error{std::make_error_code(std::io_errc::stream), "Cannot write range index " + path};
+        }
+    }
+
+    RangeIndexFile::RangeIndexFile(const std::string &path)
+        : file{path}, info{}, fanout{0}, ordinal_data{nullptr}
+    {
+        if (file.size() < RangeIndexHeader::size)
+        {
+            throw invalid_size{};
+        }
+        std::memcpy(&info, file.data(), sizeof(info));
+        if (std::memcmp(info.magic, RangeIndexHeader::magic_value, sizeof(info.magic)) != 0 || !valid_node_size(info.node_size))
+        {
+            throw invalid_size{};
+        }
+        // every record has an ordinal and the header takes a node, so larger values are damage and would overflow the layout sums
+        if (info.record_count > file.size() / sizeof(uint64_t) || info.node_size > file.size())
+        {
+            throw invalid_size{};
+        }
+        fanout = static_cast<size_t>(info.node_size / sizeof(uint64_t));
+        const size_t count = static_cast<size_t>(info.record_count);
+        const std::vector<size_t> sizes = level_sizes(count, fanout);
+
+        size_t expected = static_cast<size_t>(info.node_size) + count * sizeof(uint64_t);
+        for (const size_t size : sizes)
+        {
+            expected += whole_nodes(size, fanout) * sizeof(uint64_t);
+        }
+        if (file.size() != expected)
+        {
+            throw invalid_size{};
+        }
+
+        const uint64_t *next = reinterpret_cast<const uint64_t *>(file.data() + info.node_size);
+        levels.resize(sizes.size());
+        for (size_t level = sizes.size(); level-- > 0;)
+        {
+            levels[sizes.size() - 1 - level] = next;
+            next += whole_nodes(sizes[level], fanout);
+        }
+        ordinal_data = next;
+    }
+
+    size_t RangeIndexFile::lower_bound(const uint64_t bits) const
+    {
+        const size_t count = static_cast<size_t>(info.record_count);
+        // the largest key is the last leaf key
+        if (count == 0 || bits > levels.back()[count - 1])
+        {
+            return count;
+        }
+        // every node below the root was reached through a child whose largest key is not less than bits
+        size_t node = 0;
+        for (const uint64_t *level : levels)
+        {
+            const uint64_t *keys = level + node * fanout;
+            node = node * fanout + static_cast<size_t>(std::lower_bound(keys, keys + fanout, bits) - keys);
+        }
+        return node;
+    }
+
+    OrdinalRange RangeIndexFile::range_bits(const uint64_t low, const uint64_t high) const
+    {
+        const size_t count = static_cast<size_t>(info.record_count);
+        const size_t first = lower_bound(low);
+        const size_t last = high == std::numeric_limits<uint64_t>::max() ? count : lower_bound(high + 1);
+        return first < last ? ordinals(first, last) : ordinals(count, count);
+    }
+
+} // namespace SeriStruct
@@ -0,0 +1,442 @@
+#pragma once
+#include "MappedFile.hpp"
+#include "MappedRecordFile.hpp"
+#include "RecordSort.hpp"
+#include "SeriStruct.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Fixed 64-byte header at the start of every range index file, stored in host byte order and
+     * padded to one node. The levels of the tree follow it, each padded to whole nodes.
+     */
+    struct RangeIndexHeader
+    {
+        static constexpr char magic_value[8] = {'S', 'S', 'T', 'R', 'R', 'I', 'X', '1'};
+        static constexpr size_t size = 64;
+
+        /** Identifies the file as a range index */
+        char magic[8];
+        /** Fingerprint of the indexed record layout */
+        uint64_t schema;
+        /** Size of each indexed record in bytes */
+        uint64_t record_size;
+        /** Number of records indexed */
+        uint64_t record_count;
+        /** Size of each node in bytes, a power of two of at least 64 */
+        uint64_t node_size;
+        /** Offset of the key field in each record */
+        uint64_t key_offset;
+        /** Size of the key value in bytes */
+        uint64_t key_width;
+        /** ValueKind of the key */
+        uint8_t key_kind;
+        uint8_t reserved[7];
+    };
+    static_assert(sizeof(RangeIndexHeader) == RangeIndexHeader::size, "Range index header must be 64 bytes");
+
+    /**
+     * @brief The ordinals of the records matching a range query, in ascending order of key and then
+     * ordinal. The ordinals are read in place from the index and stay valid while it is open.
+     */
+    class OrdinalRange
+    {
+    public:
+        using const_iterator = const uint64_t *;
+
+        OrdinalRange() noexcept : first{nullptr}, last{nullptr}, position{0} {}
+        OrdinalRange(const uint64_t *first, const uint64_t *last, const size_t position) noexcept
+            : first{first}, last{last}, position{position} {}
+
+        inline const_iterator begin() const { return first; }
+        inline const_iterator end() const { return last; }
+        inline size_t size() const { return static_cast<size_t>(last - first); }
+        inline bool empty() const { return first == last; }
+        inline size_t operator[](const size_t index) const { return static_cast<size_t>(first[index]); }
+
+        /**
+         * @brief Returns the position of the first match among all records in key order. When the records
+         * file is itself sorted by the key, as by external_sort(), ordinals equal positions and the matches
+         * are the records [key_position(), key_position() + size()).
+         *
+         * @return size_t
+         */
+        inline size_t key_position() const { return position; }
+
+    private:
+        const uint64_t *first;
+        const uint64_t *last;
+        size_t position;
+    };
+
+    /**
+     * @brief A B+tree over one integral or floating point field of a record file, mapped into memory. Use
+     * RangeIndex<T> to build and query one for a generated record type.
+     *
+     * The tree is bulk loaded from the sorted keys and never updated, so every node is full and nodes are
+     * stored level by level from the root. The leaves are the keys, mapped by sort_bits(), in ascending
+     * order, followed by the ordinal of the record holding each one. Every inner node holds the largest
+     * key of each of its children. Nodes are node_size bytes, aligned to their size within the file, so a
+     * search reads one node (one page, or a few cache lines for small nodes) per level.
+     */
+    class RangeIndexFile
+    {
+    public:
+        /**
+         * @brief Nodes of one page, holding 512 keys each
+         */
+        static constexpr size_t default_node_size = 4096;
+
+        /**
+         * @brief Builds an index of the field named \p name over \p count records and writes it to \p path.
+         * The keys are sorted with radix_sort_index().
+         *
+         * @param records is the first byte of the first record
+         * @param count is the number of records
+         * @param stride is the distance in bytes between consecutive records
+         * @param fields describes the fields of the record
+         * @param field_count is the number of fields
+         * @param name is the name of the key field in the IDL
+         * @param schema is stored in the header to identify the record layout
+         * @param path is the path of the index file, which is replaced
+         * @param node_size is the size of each node in bytes, a power of two of at least 64
+         * @param threads is the number of threads to use, or 0 for one per hardware thread
+         *
+         * @exception std::invalid_argument if the field cannot be a sort key
+         * @exception SeriStruct::invalid_size if \p node_size is not a power of two of at least 64
+         * @exception std::system_error if the index cannot be written
+         */
+        static void build(const unsigned char *records, const size_t count, const size_t stride, const FieldInfo *fields,
+                          const size_t field_count, const char *name, const uint64_t schema, const std::string &path,
+                          const size_t node_size = default_node_size, const unsigned threads = 0);
+
+        /**
+         * @brief Construct a new RangeIndexFile object by mapping the index at \p path.
+         *
+         * @param path is the path of the index file
+         *
+         * @exception std::system_error if the file cannot be opened or mapped
+         * @exception SeriStruct::invalid_size if the file is not a range index
+         */
+        explicit RangeIndexFile(const std::string &path);
+
+        /**
+         * @brief Returns the header of the index.
+         *
+         * @return const RangeIndexHeader&
+         */
+        inline const RangeIndexHeader &header() const { return info; }
+
+        /**
+         * @brief Returns the key field as a SortKey.
+         *
+         * @return SortKey
+         */
+        inline SortKey key() const
+        {
+            return SortKey{static_cast<size_t>(info.key_offset), static_cast<size_t>(info.key_width),
+                           static_cast<ValueKind>(info.key_kind)};
+        }
+
+        /**
+         * @brief Returns the position in key order of the first key not less than \p bits.
+         *
+         * @param bits is a key mapped by sort_bits()
+         * @return size_t is the number of records if every key is less
+         */
+        size_t lower_bound(const uint64_t bits) const;
+
+        /**
+         * @brief Returns the ordinals of the records at positions [first, last) in key order.
+         *
+         * @param first is the first position
+         * @param last is one past the last position
+         * @return OrdinalRange
+         */
+        inline OrdinalRange ordinals(const size_t first, const size_t last) const
+        {
+            return OrdinalRange{ordinal_data + first, ordinal_data + last, first};
+        }
+
+        /**
+         * @brief Returns the ordinals of the records whose keys, mapped by sort_bits(), are in [\p low, \p high].
+         *
+         * @param low is the smallest mapped key to match
+         * @param high is the largest mapped key to match
+         * @return OrdinalRange
+         */
+        OrdinalRange range_bits(const uint64_t low, const uint64_t high) const;
+
+    private:
+        MappedFile file;
+        RangeIndexHeader info;
+        size_t fanout;
+        // first key of each level, from the root down to the leaves
+        std::vector<const uint64_t *> levels;
+        const uint64_t *ordinal_data;
+    };
+
+    /**
+     * @brief A persistent B+tree index over a MappedRecordFile<T>, keyed by one integral or floating point
+     * field, answering range queries with the ordinals of the matching records. See RangeIndexFile for the
+     * layout.
+     *
+     * The index refers to the records file it was opened with, which must outlive it, and must be rebuilt
+     * when that file changes.
+     *
+     * @tparam T is a generated record type
+     */
+    template <typename T>
+    class RangeIndex
+    {
+    public:
+        /**
+         * @brief Builds an index of the field named \p field over every record of \p records and writes it to \p path.
+         *
+         * @param records is the file of records to index
+         * @param field is the name of an integral or floating point field
+         * @param path is the path of the index file, which is replaced
+         * @param node_size is the size of each node in bytes, a power of two of at least 64
+         * @param threads is the number of threads to use, or 0 for one per hardware thread
+         *
+         * @exception std::invalid_argument if the field cannot be a sort key
+         * @exception std::system_error if the index cannot be written
+         */
+        static void build(const MappedRecordFile<T> &records, const char *field, const std::string &path,
+                          const size_t node_size = RangeIndexFile::default_node_size, const unsigned threads = 0)
+        {
+            RangeIndexFile::build(records.data(), records.size(), MappedRecordFile<T>::stride, T::field_info,
+                                  std::size(T::field_info), field, T::fingerprint, path, node_size, threads);
+        }
+
+        /**
+         * @brief Construct a new RangeIndex object by mapping the index at \p path, built over \p records.
+         *
+         * @param records is the indexed file
+         * @param path is the path of the index file
+         *
+         * @exception std::system_error if the file cannot be opened or mapped
+         * @exception SeriStruct::schema_mismatch if the index was built for another record layout
+         * @exception SeriStruct::invalid_size if the file is not a range index, or \p records has changed size since it was built
+         */
+        RangeIndex(const MappedRecordFile<T> &records, const std::string &path) : records{records}, index{path}
+        {
+            if (index.header().schema != T::fingerprint)
+            {
+                throw schema_mismatch{};
+            }
+            if (index.header().record_size != MappedRecordFile<T>::stride || index.header().record_count != records.size())
+            {
+                throw invalid_size{};
+            }
+        }
+
+        /**
+         * @brief Returns the ordinals of the records whose key is at least \p low and at most \p high, in order
+         * of key. Bounds outside the range of the field are clamped to it; for an integral field, fractional
+         * bounds are rounded inwards.
+         *
+         * @tparam L is an arithmetic type
+         * @tparam H is an arithmetic type
+         * @param low is the smallest key to match
+         * @param high is the largest key to match
+         * @return OrdinalRange
+         */
+        template <typename L, typename H>
+        OrdinalRange range(const L low, const H high) const
+        {
+            static_assert(std::is_arithmetic_v<L> && std::is_arithmetic_v<H>, "Range bounds must be integral or floating point values");
+            const size_t count = records.size();
+            const size_t first = bound_position(low, false);
+            const size_t last = bound_position(high, true);
+            return first < last ? index.ordinals(first, last) : index.ordinals(count, count);
+        }
+
+        /**
+         * @brief Returns the ordinals of the records whose key equals \p key.
+         *
+         * @tparam K is an arithmetic type
+         * @param key is the key to match
+         * @return OrdinalRange
+         */
+        template <typename K>
+        inline OrdinalRange equal_range(const K key) const { return range(key, key); }
+
+        /**
+         * @brief Returns a view of each record in \p range.
+         *
+         * @param range is the result of a query on this index
+         * @return std::vector<typename T::View>
+         */
+        std::vector<typename T::View> views(const OrdinalRange &range) const
+        {
+            std::vector<typename T::View> result;
+            result.reserve(range.size());
+            for (const uint64_t ordinal : range)
+            {
+                result.push_back(records[static_cast<size_t>(ordinal)]);
+            }
+            return result;
+        }
+
+        /**
+         * @brief Returns the underlying index.
+         *
+         * @return const RangeIndexFile&
+         */
+        inline const RangeIndexFile &index_file() const { return index; }
+
+    private:
+        const MappedRecordFile<T> &records;
+        RangeIndexFile index;
+
+        // Position in key order of the first key past the bound: not less than it for a lower bound, greater than it for an upper one
+        template <typename K>
+        size_t bound_position(const K bound, const bool upper) const
+        {
+            const SortKey key = index.key();
+            switch (key.kind)
+            {
+            case ValueKind::floating:
+                return key.width == sizeof(float) ? position_of<float>(bound, upper) : position_of<double>(bound, upper);
+            case ValueKind::signed_integer:
+                switch (key.width)
+                {
+                case 1:
+                    return position_of<int8_t>(bound, upper);
+                case 2:
+                    return position_of<int16_t>(bound, upper);
+                case 4:
+                    return position_of<int32_t>(bound, upper);
+                default:
+                    return position_of<int64_t>(bound, upper);
+                }
+            default:
+                switch (key.width)
+                {
+                case 1:
+                    return position_of<uint8_t>(bound, upper);
+                case 2:
+                    return position_of<uint16_t>(bound, upper);
+                case 4:
+                    return position_of<uint32_t>(bound, upper);
+                default:
+                    return position_of<uint64_t>(bound, upper);
+                }
+            }
+        }
+
+        template <typename F, typename K>
+        size_t position_of(const K bound, const bool upper) const
+        {
+            const size_t count = records.size();
+            F value;
+            if constexpr (std::is_floating_point_v<K>)
+            {
+                if (std::isnan(bound))
+                {
+                    return upper ? 0 : count;
+                }
+            }
+            if constexpr (std::is_floating_point_v<F>)
+            {
+                value = static_cast<F>(bound);
+                // the nearest value of the field type may lie outside the bound
+                if (!upper && value < bound)
+                {
+                    value = std::nextafter(value, std::numeric_limits<F>::infinity());
+                }
+                else if (upper && value > bound)
+                {
+                    value = std::nextafter(value, -std::numeric_limits<F>::infinity());
+                }
+                if (value == 0)
+                {
+                    // -0.0 orders just before 0.0 but is equal to it
+                    value = upper ? F{0} : -F{0};
+                }
+            }
+            else if constexpr (std::is_floating_point_v<K>)
+            {
+                const K rounded = upper ? std::floor(bound) : std::ceil(bound);
+                // below every value of the field, or above every value
+                if (rounded < static_cast<K>(std::numeric_limits<F>::min()))
+                {
+                    return 0;
+                }
+                if (rounded > static_cast<K>(std::numeric_limits<F>::max()))
+                {
+                    return count;
+                }
+                // the largest integers may round up to a value the field cannot hold
+                value = rounded == static_cast<K>(std::numeric_limits<F>::max()) ? std::numeric_limits<F>::max()
+                                                                                  : static_cast<F>(rounded);
+            }
+            else
+            {
+                if (below_min<F>(bound))
+                {
+                    return 0;
+                }
+                if (above_max<F>(bound))
+                {
+                    return count;
+                }
+                value = static_cast<F>(bound);
+            }
+
+            unsigned char bytes[sizeof(F)];
+            std::memcpy(bytes, &value, sizeof(F));
+            const uint64_t bits = sort_bits(bytes, SortKey{0, sizeof(F), value_kind<F>()});
+            if (!upper)
+            {
+                return index.lower_bound(bits);
+            }
+            return bits == std::numeric_limits<uint64_t>::max() ? count : index.lower_bound(bits + 1);
+        }
+
+        template <typename F, typename K>
+        static inline bool below_min(const K value)
+        {
+            if constexpr (std::is_signed_v<K>)
+            {
+                if (value < 0)
+                {
+                    if constexpr (std::is_unsigned_v<F>)
+                    {
+                        return true;
+                    }
+                    else
+                    {
+                        return static_cast<int64_t>(value) < static_cast<int64_t>(std::numeric_limits<F>::min());
+                    }
+                }
+            }
+            return false;
+        }
+
+        template <typename F, typename K>
+        static inline bool above_max(const K value)
+        {
+            if constexpr (std::is_signed_v<K>)
+            {
+                if (value < 0)
+                {
+                    return false;
+                }
+            }
+            return static_cast<uint64_t>(value) > static_cast<uint64_t>(std::numeric_limits<F>::max());
+        }
+    };
+
+} // namespace SeriStruct
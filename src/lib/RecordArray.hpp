@@ -0,0 +1,361 @@
+#pragma once
+#include "SeriStruct.hpp"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory_resource>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief A batch of records of one generated type, stored back to back in a single allocation
+     * spaced by T::buffer_size. The bytes of the array are exactly what writing each record in turn
+     * would produce, so a RecordArray can be written or copied with a single call and scanned linearly.
+     *
+     * Elements are accessed through zero-copy T::View objects, which are invalidated by any operation
+     * that grows the array.
+     *
+     * @tparam T is a generated record type
+     */
+    template <typename T>
+    class RecordArray
+    {
+        static_assert(T::has_fixed_size, "Records with vstr fields vary in size");
+
+    public:
+        using value_type = T;
+        using view_type = typename T::View;
+
+        /**
+         * @brief Distance in bytes between consecutive records
+         */
+        static constexpr size_t stride = T::buffer_size;
+
+        /**
+         * @brief Largest number of bytes read() reads from a stream at a time
+         */
+        static constexpr size_t read_block_size = 1024 * 1024;
+
+        /**
+         * @brief Random access iterator producing a view of each record.
+         */
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = view_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = void;
+            using reference = view_type;
+
+            const_iterator() noexcept : position{nullptr} {}
+            explicit const_iterator(const unsigned char *position) noexcept : position{position} {}
+
+            inline view_type operator*() const { return view_type{position, stride}; }
+            inline view_type operator[](const difference_type n) const { return *(*this + n); }
+            inline const_iterator &operator++()
+            {
+                position += stride;
+                return *this;
+            }
+            inline const_iterator operator++(int)
+            {
+                auto copy = *this;
+                position += stride;
+                return copy;
+            }
+            inline const_iterator &operator--()
+            {
+                position -= stride;
+                return *this;
+            }
+            inline const_iterator operator--(int)
+            {
+                auto copy = *this;
+                position -= stride;
+                return copy;
+            }
+            inline const_iterator &operator+=(const difference_type n)
+            {
+                position += n * static_cast<difference_type>(stride);
+                return *this;
+            }
+            inline const_iterator &operator-=(const difference_type n) { return *this += -n; }
+            inline const_iterator operator+(const difference_type n) const { return const_iterator{*this} += n; }
+            inline const_iterator operator-(const difference_type n) const { return const_iterator{*this} -= n; }
+            inline difference_type operator-(const const_iterator &other) const
+            {
+                return (position - other.position) / static_cast<difference_type>(stride);
+            }
+            inline bool operator==(const const_iterator &other) const { return position == other.position; }
+            inline bool operator!=(const const_iterator &other) const { return position != other.position; }
+            inline bool operator<(const const_iterator &other) const { return position < other.position; }
+            inline bool operator>(const const_iterator &other) const { return position > other.position; }
+            inline bool operator<=(const const_iterator &other) const { return position <= other.position; }
+            inline bool operator>=(const const_iterator &other) const { return position >= other.position; }
+
+        private:
+            const unsigned char *position;
+        };
+
+        /**
+         * @brief Construct a new, empty RecordArray object
+         *
+         * @param resource is the memory resource used to allocate the array
+         */
+        explicit RecordArray(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : bytes{resource} {}
+
+        /**
+         * @brief Construct a new RecordArray object by copying records from \p buffer, such as one
+         * filled by copy_to() or write().
+         *
+         * @param buffer is a buffer holding zero or more records back to back
+         * @param buffer_size is the size of \p buffer, which must be a multiple of stride
+         * @param resource is the memory resource used to allocate the array
+         *
+         * @exception SeriStruct::invalid_size if \p buffer_size is not a multiple of stride
+         */
+        RecordArray(const unsigned char *buffer, const size_t buffer_size,
+                    std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : bytes{resource}
+        {
+            if (buffer_size % stride != 0)
+            {
+                throw invalid_size{};
+            }
+            bytes.assign(buffer, buffer + buffer_size);
+        }
+
+        /**
+         * @brief Returns the number of records in the array.
+         *
+         * @return size_t
+         */
+        inline size_t size() const { return bytes.size() / stride; };
+
+        /**
+         * @brief Returns true if the array holds no records.
+         *
+         * @return bool
+         */
+        inline bool empty() const { return bytes.empty(); };
+
+        /**
+         * @brief Returns the size of the array in bytes (size() * stride).
+         *
+         * @return size_t
+         */
+        inline size_t size_bytes() const { return bytes.size(); };
+
+        /**
+         * @brief Returns a pointer to the first byte of the first record.
+         *
+         * @return const unsigned char*
+         */
+        inline const unsigned char *data() const { return bytes.data(); };
+
+        /**
+         * @brief Returns a pointer to the first byte of the first record.
+         *
+         * @return unsigned char*
+         */
+        inline unsigned char *data() { return bytes.data(); };
+
+        /**
+         * @brief Reserves space for at least \p count records.
+         *
+         * @param count is the number of records
+         */
+        inline void reserve(const size_t count) { bytes.reserve(count * stride); }
+
+        /**
+         * @brief Resizes the array to \p count records. New records are zero filled.
+         *
+         * @param count is the number of records
+         */
+        inline void resize(const size_t count) { bytes.resize(count * stride); }
+
+        /**
+         * @brief Removes all records.
+         */
+        inline void clear() { bytes.clear(); }
+
+        /**
+         * @brief Returns a view of the record at \p index. No bounds checking is performed.
+         *
+         * @param index is the index of the record
+         * @return view_type
+         */
+        inline view_type operator[](const size_t index) const { return view_type{bytes.data() + index * stride, stride}; }
+
+        /**
+         * @brief Returns a view of the record at \p index.
+         *
+         * @param index is the index of the record
+         * @return view_type
+         *
+         * @exception std::out_of_range if \p index >= size()
+         */
+        inline view_type at(const size_t index) const
+        {
+            if (index >= size())
+            {
+                throw std::out_of_range{"RecordArray index out of range"};
+            }
+            return (*this)[index];
+        }
+
+        /**
+         * @brief Returns a view of the first record. The array must not be empty.
+         *
+         * @return view_type
+         */
+        inline view_type front() const { return (*this)[0]; }
+
+        /**
+         * @brief Returns a view of the last record. The array must not be empty.
+         *
+         * @return view_type
+         */
+        inline view_type back() const { return (*this)[size() - 1]; }
+
+        /**
+         * @brief Returns an iterator to the first record.
+         *
+         * @return const_iterator
+         */
+        inline const_iterator begin() const { return const_iterator{bytes.data()}; }
+
+        /**
+         * @brief Returns an iterator past the last record.
+         *
+         * @return const_iterator
+         */
+        inline const_iterator end() const { return const_iterator{bytes.data() + bytes.size()}; }
+
+        /**
+         * @brief Returns an owning copy of the record at \p index.
+         *
+         * @param index is the index of the record
+         * @return T
+         */
+        inline T get(const size_t index) const { return T{bytes.data() + index * stride, stride}; }
+
+        /**
+         * @brief Appends a copy of \p record. Only the first stride bytes are kept, so extra fields of
+         * a forward compatible record are dropped.
+         *
+         * @param record is the record to append
+         */
+        inline void push_back(const T &record) { append(record.data(), record.size()); }
+
+        /**
+         * @brief Appends a copy of the record viewed by \p view.
+         *
+         * @param view is a view of the record to append
+         */
+        inline void push_back(const view_type &view) { append(view.data(), view.size()); }
+
+        /**
+         * @brief Constructs a record from \p args and appends it. Records that accept a memory
+         * resource are built in scratch space on the stack, so appending does not allocate
+         * beyond growing the array.
+         *
+         * @tparam Args are the types of the arguments to T's constructor
+         * @param args are the arguments to T's constructor
+         * @return view_type is a view of the new record
+         */
+        template <typename... Args>
+        view_type emplace_back(Args &&...args)
+        {
+            if constexpr (std::is_constructible_v<T, Args..., std::pmr::memory_resource *>)
+            {
+                alignas(alignof(std::max_align_t)) unsigned char scratch[stride];
+                std::pmr::monotonic_buffer_resource arena{scratch, sizeof(scratch), std::pmr::null_memory_resource()};
+                push_back(T(std::forward<Args>(args)..., &arena));
+            }
+            else
+            {
+                push_back(T(std::forward<Args>(args)...));
+            }
+            return back();
+        }
+
+        /**
+         * @brief Appends \p count records read from \p istr. Up to read_block_size bytes are read at a
+         * time and the array grows only as they arrive, so a count taken from an untrusted header cannot
+         * allocate more than the stream actually holds.
+         *
+         * @param istr is an open stream for reading the bytes
+         * @param count is the number of records to read
+         *
+         * @exception SeriStruct::invalid_size if \p count records cannot fit in memory
+         * @exception SeriStruct::not_enough_data if EOF is reached on \p istr before all data could be read.
+         * The array is left as it was.
+         */
+        void read(std::istream &istr, const size_t count)
+        {
+            const size_t old_size = bytes.size();
+            if (count > (std::numeric_limits<size_t>::max() - old_size) / stride)
+            {
+                throw invalid_size{};
+            }
+            for (size_t remaining = count * stride; remaining > 0;)
+            {
+                const size_t block = std::min(remaining, read_block_size);
+                const size_t at = bytes.size();
+                bytes.resize(at + block);
+                istr.read(reinterpret_cast<char *>(bytes.data() + at), static_cast<std::streamsize>(block));
+                if (static_cast<size_t>(istr.gcount()) != block)
+                {
+                    bytes.resize(old_size);
+                    throw not_enough_data{};
+                }
+                remaining -= block;
+            }
+        }
+
+        /**
+         * @brief Copies every record to \p buffer.
+         *
+         * @param buffer is the destination buffer. Make sure at least size_bytes() bytes are available.
+         */
+        inline void copy_to(unsigned char *buffer) const { std::memcpy(buffer, bytes.data(), bytes.size()); }
+
+        /**
+         * @brief Writes every record to \p ostr as a single block of bytes.
+         *
+         * @param ostr is a std::ostream ready for writing
+         */
+        inline void write(std::ostream &ostr) const { ostr.write(reinterpret_cast<const char *>(bytes.data()), bytes.size()); }
+
+    private:
+        std::pmr::vector<unsigned char> bytes;
+
+        void append(const unsigned char *record, const size_t record_size)
+        {
+            if (record_size < stride)
+            {
+                throw invalid_size{};
+            }
+            bytes.insert(bytes.end(), record, record + stride);
+        }
+    };
+
+    /**
+     * @brief Writes every record in \p records to \p ostr.
+     *
+     * @return std::ostream&
+     */
+    template <typename T>
+    std::ostream &operator<<(std::ostream &ostr, const RecordArray<T> &records)
+    {
+        records.write(ostr);
+        return ostr;
+    }
+
+} // namespace SeriStruct
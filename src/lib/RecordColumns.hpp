@@ -0,0 +1,225 @@
+#pragma once
+#include "SeriStruct.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory_resource>
+#include <type_traits>
+#include <utility>
+
+namespace SeriStruct
+{
+    /**
+     * @brief A growable array of one field's values, used by the generated <Name>Columns classes
+     * to store a batch of records as one contiguous array per field. The values start on a
+     * cache line boundary, so scans over a column are dense and can use aligned vector loads.
+     *
+     * @tparam T is the trivially copyable type of the field
+     */
+    template <typename T>
+    class Column
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Column values must be trivially copyable");
+
+    public:
+        using value_type = T;
+
+        /**
+         * @brief Alignment in bytes of the first value
+         */
+        static constexpr size_t alignment = std::max<size_t>(64, alignof(T));
+
+        /**
+         * @brief Construct a new, empty Column object
+         *
+         * @param resource is the memory resource used to allocate the values
+         */
+        explicit Column(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) noexcept
+            : values{nullptr}, count{0}, capacity{0}, resource{resource} {}
+
+        /**
+         * @brief Construct a new Column object by copying \p other
+         *
+         * @param other is the column to copy
+         * @param resource is the memory resource used to allocate the values
+         */
+        Column(const Column &other, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : Column{resource}
+        {
+            reserve(other.count);
+            copy_values(other.values, other.count);
+            count = other.count;
+        }
+
+        Column(Column &&other) noexcept
+            : values{std::exchange(other.values, nullptr)},
+              count{std::exchange(other.count, 0)},
+              capacity{std::exchange(other.capacity, 0)},
+              resource{other.resource} {}
+
+        Column &operator=(const Column &other)
+        {
+            if (this != &other)
+            {
+                count = 0;
+                reserve(other.count);
+                copy_values(other.values, other.count);
+                count = other.count;
+            }
+            return *this;
+        }
+
+        Column &operator=(Column &&other) noexcept
+        {
+            if (resource->is_equal(*other.resource))
+            {
+                std::swap(values, other.values);
+                std::swap(count, other.count);
+                std::swap(capacity, other.capacity);
+                return *this;
+            }
+            return *this = static_cast<const Column &>(other);
+        }
+
+        ~Column() noexcept
+        {
+            if (values)
+            {
+                resource->deallocate(values, capacity * sizeof(T), alignment);
+            }
+        }
+
+        /**
+         * @brief Returns the number of values in the column.
+         *
+         * @return size_t
+         */
+        inline size_t size() const { return count; }
+
+        /**
+         * @brief Returns true if the column holds no values.
+         *
+         * @return bool
+         */
+        inline bool empty() const { return count == 0; }
+
+        /**
+         * @brief Returns a pointer to the first value, aligned to Column::alignment.
+         *
+         * @return const T*
+         */
+        inline const T *data() const { return values; }
+
+        /**
+         * @brief Returns a pointer to the first value, aligned to Column::alignment.
+         *
+         * @return T*
+         */
+        inline T *data() { return values; }
+
+        inline const T *begin() const { return values; }
+        inline const T *end() const { return values + count; }
+        inline T *begin() { return values; }
+        inline T *end() { return values + count; }
+
+        /**
+         * @brief Returns the value at \p index. No bounds checking is performed.
+         *
+         * @param index is the index of the value
+         * @return const T&
+         */
+        inline const T &operator[](const size_t index) const { return values[index]; }
+
+        /**
+         * @brief Returns the value at \p index. No bounds checking is performed.
+         *
+         * @param index is the index of the value
+         * @return T&
+         */
+        inline T &operator[](const size_t index) { return values[index]; }
+
+        /**
+         * @brief Returns the memory resource used to allocate the values.
+         *
+         * @return std::pmr::memory_resource*
+         */
+        inline std::pmr::memory_resource *get_memory_resource() const { return resource; }
+
+        /**
+         * @brief Reserves space for at least \p new_capacity values.
+         *
+         * @param new_capacity is the number of values
+         */
+        void reserve(const size_t new_capacity)
+        {
+            if (new_capacity <= capacity)
+            {
+                return;
+            }
+            auto new_values = static_cast<T *>(resource->allocate(new_capacity * sizeof(T), alignment));
+            if (values)
+            {
+                std::memcpy(new_values, values, count * sizeof(T));
+                resource->deallocate(values, capacity * sizeof(T), alignment);
+            }
+            values = new_values;
+            capacity = new_capacity;
+        }
+
+        /**
+         * @brief Resizes the column to \p new_count values. New values are zero filled.
+         *
+         * @param new_count is the number of values
+         */
+        void resize(const size_t new_count)
+        {
+            reserve(new_count);
+            if (new_count > count)
+            {
+                std::memset(static_cast<void *>(values + count), 0, (new_count - count) * sizeof(T));
+            }
+            count = new_count;
+        }
+
+        /**
+         * @brief Removes all values without releasing memory.
+         */
+        inline void clear() { count = 0; }
+
+        /**
+         * @brief Appends \p value.
+         *
+         * @param value is the value to append
+         */
+        inline void push_back(const T &value) { push_back_bytes(reinterpret_cast<const unsigned char *>(&value)); }
+
+        /**
+         * @brief Appends a value copied from its encoded bytes, such as a field inside a record buffer.
+         *
+         * @param bytes points to sizeof(T) bytes holding the value, with no alignment requirement
+         */
+        inline void push_back_bytes(const unsigned char *bytes)
+        {
+            if (count == capacity)
+            {
+                reserve(std::max<size_t>(16, capacity * 2));
+            }
+            std::memcpy(static_cast<void *>(values + count), bytes, sizeof(T));
+            count++;
+        }
+
+    private:
+        T *values;
+        size_t count;
+        size_t capacity;
+        std::pmr::memory_resource *resource;
+
+        inline void copy_values(const T *source, const size_t source_count)
+        {
+            if (source_count)
+            {
+                std::memcpy(static_cast<void *>(values), source, source_count * sizeof(T));
+            }
+        }
+    };
+
+} // namespace SeriStruct
@@ -0,0 +1,73 @@
+#include "RecordDiff.hpp"
+#include "KernelsDetail.hpp"
+
+namespace SeriStruct
+{
+    DiffPlan::DiffPlan(const FieldInfo *fields, const size_t field_count, const size_t record_size)
+        : stride{record_size}, mask(record_size), field_at(record_size), field_end(field_count)
+    {
+        for (size_t f = 0; f < field_count; f++)
+        {
+            const FieldInfo &field = fields[f];
+            // generated fields give their size; others span their values
+            const size_t size = field.size ? field.size : field.width * field.count;
+            if (field.offset + size > stride)
+            {
+                throw invalid_size{};
+            }
+            for (size_t i = field.offset; i < field.offset + size; i++)
+            {
+                mask[i] = 0xFF;
+                field_at[i] = static_cast<uint32_t>(f);
+            }
+            field_end[f] = field.offset + size;
+        }
+    }
+
+    size_t DiffPlan::mismatch(const unsigned char *a, const unsigned char *b, const size_t start) const
+    {
+#if defined(SERISTRUCT_X86_KERNELS)
+        switch (simd_level())
+        {
+        case SimdLevel::avx2:
+            return detail::masked_mismatch_avx2(a, b, mask.data(), stride, start);
+        case SimdLevel::sse42:
+            return detail::masked_mismatch_sse42(a, b, mask.data(), stride, start);
+        default:
+            break;
+        }
+#endif
+        return detail::masked_mismatch_tail(a, b, mask.data(), stride, start);
+    }
+
+    bool DiffPlan::equal(const unsigned char *a, const unsigned char *b) const
+    {
+        return mismatch(a, b, 0) == stride;
+    }
+
+    size_t DiffPlan::diff(const unsigned char *a, const unsigned char *b, std::vector<size_t> &changed) const
+    {
+        const size_t first = changed.size();
+        for (size_t position = mismatch(a, b, 0); position < stride;)
+        {
+            const size_t field = field_at[position];
+            changed.push_back(field);
+            position = mismatch(a, b, field_end[field]);
+        }
+        return changed.size() - first;
+    }
+
+    size_t DiffPlan::diff_rows(const unsigned char *a, const unsigned char *b, const size_t count, std::vector<size_t> &rows) const
+    {
+        const size_t first = rows.size();
+        for (size_t r = 0; r < count; r++, a += stride, b += stride)
+        {
+            if (mismatch(a, b, 0) != stride)
+            {
+                rows.push_back(r);
+            }
+        }
+        return rows.size() - first;
+    }
+
+} // namespace SeriStruct
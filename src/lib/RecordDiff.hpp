@@ -0,0 +1,154 @@
+#pragma once
+#include "RecordArray.hpp"
+#include "SeriStruct.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Compares records of one layout field by field, ignoring the padding between fields.
+     *
+     * The layout is compiled once into a byte mask that covers every field, so two records are compared
+     * 16 (SSE4.2) or 32 (AVX2) bytes at a time, and a table that maps each differing byte back to its field.
+     * Once a field is found to differ the rest of it is skipped.
+     */
+    class DiffPlan
+    {
+    public:
+        /**
+         * @brief Construct a new DiffPlan object
+         *
+         * @param fields describes the fields of the record
+         * @param field_count is the number of fields
+         * @param record_size is the distance in bytes between consecutive records
+         *
+         * @exception SeriStruct::invalid_size if a field does not fit within \p record_size
+         */
+        DiffPlan(const FieldInfo *fields, const size_t field_count, const size_t record_size);
+
+        /**
+         * @brief Construct a new DiffPlan object from a generated record's field_info array
+         *
+         * @param fields describes the fields of the record
+         * @param record_size is the distance in bytes between consecutive records
+         */
+        template <size_t N>
+        DiffPlan(const FieldInfo (&fields)[N], const size_t record_size) : DiffPlan{fields, N, record_size} {}
+
+        /**
+         * @brief Returns true if every field of \p a equals the same field of \p b, byte for byte.
+         *
+         * @param a is a record of this layout
+         * @param b is a record of this layout
+         * @return bool
+         */
+        bool equal(const unsigned char *a, const unsigned char *b) const;
+
+        /**
+         * @brief Appends the index of every field that differs between \p a and \p b to \p changed,
+         * in order of offset.
+         *
+         * @param a is a record of this layout
+         * @param b is a record of this layout
+         * @param changed receives indexes into the fields the plan was built from
+         * @return size_t is the number of fields appended
+         */
+        size_t diff(const unsigned char *a, const unsigned char *b, std::vector<size_t> &changed) const;
+
+        /**
+         * @brief Compares \p count records stored back to back in \p a with those in \p b and appends the
+         * position of every record that differs to \p rows.
+         *
+         * @param a is the first byte of the first batch
+         * @param b is the first byte of the second batch
+         * @param count is the number of records in each batch
+         * @param rows receives the positions of the records that differ
+         * @return size_t is the number of positions appended
+         */
+        size_t diff_rows(const unsigned char *a, const unsigned char *b, const size_t count, std::vector<size_t> &rows) const;
+
+    private:
+        // First byte at or after start where a and b differ within a field, or stride
+        size_t mismatch(const unsigned char *a, const unsigned char *b, const size_t start) const;
+
+        size_t stride;
+        // 0xFF for bytes of a field, 0 for padding
+        std::vector<unsigned char> mask;
+        // field index of each byte of a field
+        std::vector<uint32_t> field_at;
+        // one past the last byte of each field
+        std::vector<size_t> field_end;
+    };
+
+    /**
+     * @brief Returns the DiffPlan of a generated record type, built on first use.
+     *
+     * @tparam T is a generated record type
+     * @return const DiffPlan&
+     */
+    template <typename T>
+    const DiffPlan &diff_plan()
+    {
+        static_assert(T::has_fixed_size, "Records with vstr fields vary in size");
+        static const DiffPlan plan{T::field_info, T::buffer_size};
+        return plan;
+    }
+
+    /**
+     * @brief Returns the index in T::field_info of every field that differs between \p a and \p b.
+     *
+     * @tparam T is a generated record type
+     * @param a is a record
+     * @param b is a record
+     * @return std::vector<size_t>
+     */
+    template <typename T>
+    std::vector<size_t> diff(const T &a, const T &b)
+    {
+        std::vector<size_t> changed;
+        diff_plan<T>().diff(a.data(), b.data(), changed);
+        return changed;
+    }
+
+    /**
+     * @brief Returns the index in T::field_info of every field that differs between the viewed records.
+     *
+     * @tparam T is a generated record type, which must be given explicitly
+     * @param a is a view of a record
+     * @param b is a view of a record
+     * @return std::vector<size_t>
+     */
+    template <typename T>
+    std::vector<size_t> diff(const typename T::View &a, const typename T::View &b)
+    {
+        std::vector<size_t> changed;
+        diff_plan<T>().diff(a.data(), b.data(), changed);
+        return changed;
+    }
+
+    /**
+     * @brief Returns the position of every record that differs between two batches of the same size,
+     * such as two snapshots of a table.
+     *
+     * @tparam T is a generated record type
+     * @param a is a batch of records
+     * @param b is a batch of records
+     * @return std::vector<size_t>
+     *
+     * @exception SeriStruct::invalid_size if the batches hold different numbers of records
+     */
+    template <typename T>
+    std::vector<size_t> diff_rows(const RecordArray<T> &a, const RecordArray<T> &b)
+    {
+        if (a.size() != b.size())
+        {
+            throw invalid_size{};
+        }
+        std::vector<size_t> rows;
+        diff_plan<T>().diff_rows(a.data(), b.data(), a.size(), rows);
+        return rows;
+    }
+
+} // namespace SeriStruct
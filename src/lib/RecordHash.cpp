@@ -0,0 +1,107 @@
+#include "RecordHash.hpp"
+#include <cstring>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        constexpr uint64_t prime_1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t prime_2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t prime_3 = 0x165667B19E3779F9ull;
+        constexpr uint64_t prime_4 = 0x85EBCA77C2B2AE63ull;
+        constexpr uint64_t prime_5 = 0x27D4EB2F165667C5ull;
+
+        inline uint64_t rotate_left(const uint64_t value, const int bits)
+        {
+            return (value << bits) | (value >> (64 - bits));
+        }
+
+        inline uint64_t read_64(const unsigned char *bytes)
+        {
+            uint64_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+
+        inline uint32_t read_32(const unsigned char *bytes)
+        {
+            uint32_t value;
+            std::memcpy(&value, bytes, sizeof(value));
+            return value;
+        }
+
+        inline uint64_t round(uint64_t accumulator, const uint64_t input)
+        {
+            accumulator += input * prime_2;
+            accumulator = rotate_left(accumulator, 31);
+            return accumulator * prime_1;
+        }
+
+        inline uint64_t merge_round(uint64_t hash, const uint64_t accumulator)
+        {
+            hash ^= round(0, accumulator);
+            return hash * prime_1 + prime_4;
+        }
+    } // namespace
+
+    uint64_t hash_bytes(const void *bytes, const size_t size, const uint64_t seed)
+    {
+        const unsigned char *input = static_cast<const unsigned char *>(bytes);
+        const unsigned char *const end = input + size;
+        uint64_t hash;
+
+        if (size >= 32)
+        {
+            // four lanes with no dependency on each other, one 8-byte word each per stripe
+            uint64_t v1 = seed + prime_1 + prime_2;
+            uint64_t v2 = seed + prime_2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - prime_1;
+            const unsigned char *const last_stripe = end - 32;
+            do
+            {
+                v1 = round(v1, read_64(input));
+                v2 = round(v2, read_64(input + 8));
+                v3 = round(v3, read_64(input + 16));
+                v4 = round(v4, read_64(input + 24));
+                input += 32;
+            } while (input <= last_stripe);
+
+            hash = rotate_left(v1, 1) + rotate_left(v2, 7) + rotate_left(v3, 12) + rotate_left(v4, 18);
+            hash = merge_round(hash, v1);
+            hash = merge_round(hash, v2);
+            hash = merge_round(hash, v3);
+            hash = merge_round(hash, v4);
+        }
+        else
+        {
+            hash = seed + prime_5;
+        }
+        hash += static_cast<uint64_t>(size);
+
+        for (; input + 8 <= end; input += 8)
+        {
+            hash ^= round(0, read_64(input));
+            hash = rotate_left(hash, 27) * prime_1 + prime_4;
+        }
+        if (input + 4 <= end)
+        {
+            hash ^= static_cast<uint64_t>(read_32(input)) * prime_1;
+            hash = rotate_left(hash, 23) * prime_2 + prime_3;
+            input += 4;
+        }
+        for (; input < end; input++)
+        {
+            hash ^= *input * prime_5;
+            hash = rotate_left(hash, 11) * prime_1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime_2;
+        hash ^= hash >> 29;
+        hash *= prime_3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+} // namespace SeriStruct
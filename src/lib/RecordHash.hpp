@@ -0,0 +1,47 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Hashes \p size bytes with XXH64. The input is consumed in 32-byte stripes by four independent
+     * accumulators, so the hash runs at memory speed for large records and agrees with the reference
+     * XXH64 on little-endian hosts.
+     *
+     * @param bytes is the first byte to hash
+     * @param size is the number of bytes
+     * @param seed selects one of a family of hash functions
+     * @return uint64_t
+     */
+    uint64_t hash_bytes(const void *bytes, const size_t size, const uint64_t seed = 0);
+
+    /**
+     * @brief Hashes every byte of a record or record view in one pass. Generated records zero their padding
+     * and unused string capacity, so records with equal fields have equal hashes.
+     *
+     * @tparam R is a generated record or View type
+     * @param record is the record to hash
+     * @param seed selects one of a family of hash functions
+     * @return uint64_t
+     */
+    template <typename R>
+    uint64_t record_hash(const R &record, const uint64_t seed = 0)
+    {
+        return hash_bytes(record.data(), record.size(), seed);
+    }
+
+    /**
+     * @brief Hash function object for records and record views. Generated headers specialize std::hash
+     * with it, so records can be used as keys of unordered containers.
+     */
+    struct RecordHasher
+    {
+        template <typename R>
+        size_t operator()(const R &record) const noexcept
+        {
+            return static_cast<size_t>(record_hash(record));
+        }
+    };
+
+} // namespace SeriStruct
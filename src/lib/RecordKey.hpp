@@ -0,0 +1,143 @@
+#pragma once
+#include "RecordSort.hpp"
+#include "SeriStruct.hpp"
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+
+namespace SeriStruct
+{
+    /**
+     * @brief A key field holding one integral or floating point value of type \p T at \p Offset. Floating
+     * point values compare as sort_bits() maps them, so the order is total: -0.0 orders just before 0.0
+     * and NaNs have a fixed place, and sorting records with NaN keys is well defined.
+     *
+     * @tparam T is the type of the value
+     * @tparam Offset is the offset of the field in the record
+     */
+    template <typename T, size_t Offset>
+    struct ValueKey
+    {
+        using type = T;
+        static constexpr size_t offset = Offset;
+
+        static inline T get(const unsigned char *record)
+        {
+            T value;
+            std::memcpy(&value, record + Offset, sizeof(T));
+            return value;
+        }
+
+        static inline int compare(const unsigned char *a, const unsigned char *b)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                constexpr SortKey key{Offset, sizeof(T), ValueKind::floating};
+                const uint64_t va = sort_bits(a, key);
+                const uint64_t vb = sort_bits(b, key);
+                return (vb < va) - (va < vb);
+            }
+            else
+            {
+                const T va = get(a);
+                const T vb = get(b);
+                return (vb < va) - (va < vb);
+            }
+        }
+    };
+
+    /**
+     * @brief A key field holding a cstr or str of up to \p MaxLength characters at \p Offset. Strings compare
+     * like std::string_view, and a cstr that was never assigned compares equal to an empty one.
+     *
+     * @tparam Offset is the offset of the field in the record
+     * @tparam MaxLength is the maximum length allowed for the field
+     */
+    template <size_t Offset, size_t MaxLength>
+    struct StringKey
+    {
+        using type = std::string_view;
+        static constexpr size_t offset = Offset;
+
+        static inline std::string_view get(const unsigned char *record) { return string_field_str(record + Offset, MaxLength); }
+
+        static inline int compare(const unsigned char *a, const unsigned char *b)
+        {
+            const int result = get(a).compare(get(b));
+            return (result > 0) - (result < 0);
+        }
+    };
+
+    /**
+     * @brief A key field holding a vstr whose slot is at \p Offset.
+     *
+     * @tparam Offset is the offset of the field's slot in the record
+     */
+    template <size_t Offset>
+    struct VarStringKey
+    {
+        using type = std::string_view;
+        static constexpr size_t offset = Offset;
+
+        static inline std::string_view get(const unsigned char *record) { return vstr_field(record, Offset); }
+
+        static inline int compare(const unsigned char *a, const unsigned char *b)
+        {
+            const int result = get(a).compare(get(b));
+            return (result > 0) - (result < 0);
+        }
+    };
+
+    /**
+     * @brief Lexicographic order of records by a list of key fields, fixed at compile time. Generated
+     * records with a \c key line in their IDL define it as key_order.
+     *
+     * @tparam Keys are ValueKey, StringKey or VarStringKey types, most significant first
+     */
+    template <typename... Keys>
+    struct KeyOrder
+    {
+        static_assert(sizeof...(Keys) > 0, "A key needs at least one field");
+
+        /**
+         * @brief Compares the keys of two records.
+         *
+         * @param a is the first byte of a record
+         * @param b is the first byte of a record
+         * @return int is negative if \p a orders first, positive if \p b does, or 0 if the keys are equal
+         */
+        static inline int compare(const unsigned char *a, const unsigned char *b)
+        {
+            int result = 0;
+            // stops at the first key that differs
+            static_cast<void>((((result = Keys::compare(a, b)) != 0) || ...));
+            return result;
+        }
+
+        /**
+         * @brief Returns true if the key of \p a orders before the key of \p b.
+         *
+         * @param a is the first byte of a record
+         * @param b is the first byte of a record
+         * @return bool
+         */
+        static inline bool less(const unsigned char *a, const unsigned char *b) { return compare(a, b) < 0; }
+    };
+
+    /**
+     * @brief Function object ordering records or views by \p Order, for std::sort and ordered containers.
+     *
+     * @tparam Order is a KeyOrder
+     */
+    template <typename Order>
+    struct KeyLess
+    {
+        template <typename A, typename B>
+        inline bool operator()(const A &a, const B &b) const
+        {
+            return Order::less(a.data(), b.data());
+        }
+    };
+
+} // namespace SeriStruct
@@ -0,0 +1,295 @@
+#include "RecordLog.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        [[noreturn]] void throw_errno(const std::string &what)
+        {
+            throw std::system_error{errno, std::generic_category(), what};
+        }
+
+        // Writes count bytes, adding each part to done as it is written so a failure reports how far it got
+        void write_all(const int fd, const unsigned char *bytes, size_t count, size_t &done)
+        {
+            while (count)
+            {
+                const ssize_t written = ::write(fd, bytes, count);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw_errno("Cannot write log segment");
+                }
+                bytes += written;
+                count -= static_cast<size_t>(written);
+                done += static_cast<size_t>(written);
+            }
+        }
+
+        void pwrite_all(const int fd, const unsigned char *bytes, size_t count, off_t offset)
+        {
+            while (count)
+            {
+                const ssize_t written = ::pwrite(fd, bytes, count, offset);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    throw_errno("Cannot write log segment header");
+                }
+                bytes += written;
+                count -= static_cast<size_t>(written);
+                offset += written;
+            }
+        }
+
+        void data_sync(const int fd)
+        {
+#if defined(__APPLE__)
+            const int result = ::fsync(fd);
+#else
+            const int result = ::fdatasync(fd);
+#endif
+            if (result != 0)
+            {
+                throw_errno("Cannot sync log segment");
+            }
+        }
+
+        // Makes the creation of a new segment file durable
+        void sync_directory(const std::string &directory)
+        {
+            const int fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                throw_errno("Cannot open log directory " + directory);
+            }
+            const int result = ::fsync(fd);
+            const int error = errno;
+            ::close(fd);
+            if (result != 0)
+            {
+                throw std::system_error{error, std::generic_category(), "Cannot sync log directory " + directory};
+            }
+        }
+    } // namespace
+
+    SegmentHeader read_segment_header(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            throw_errno("Cannot open " + path);
+        }
+        SegmentHeader header;
+        const ssize_t result = ::pread(fd, &header, sizeof(header), 0);
+        const int error = errno;
+        ::close(fd);
+        if (result < 0)
+        {
+            throw std::system_error{error, std::generic_category(), "Cannot read " + path};
+        }
+        if (static_cast<size_t>(result) < sizeof(header) ||
+            std::memcmp(header.magic, SegmentHeader::magic_value, sizeof(header.magic)) != 0)
+        {
+            throw invalid_size{};
+        }
+        return header;
+    }
+
+    LogWriter::LogWriter(const Options &options, const size_t record_size)
+        : options{options},
+          record_size{record_size},
+          fd{-1},
+          segment{0},
+          segment_first_record{0},
+          segment_records{0},
+          synced_records{0},
+          unsynced_bytes{0},
+          last_sync{std::chrono::steady_clock::now()}
+    {
+        if (record_size == 0 || options.segment_size < SegmentHeader::size + record_size)
+        {
+            throw invalid_size{};
+        }
+        buffer.reserve(std::max(options.buffer_size, record_size));
+        open_segment();
+    }
+
+    LogWriter::~LogWriter() noexcept
+    {
+        try
+        {
+            close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    std::string LogWriter::segment_path(const uint64_t index) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "-%010llu.log", static_cast<unsigned long long>(index));
+        return options.directory + "/" + options.prefix + name;
+    }
+
+    void LogWriter::append(const unsigned char *records, size_t count)
+    {
+        if (fd < 0)
+        {
+            throw std::system_error{EBADF, std::generic_category(), "Log writer is closed"};
+        }
+        while (count)
+        {
+            size_t segment_room = (options.segment_size - SegmentHeader::size) / record_size - segment_records;
+            if (segment_room == 0)
+            {
+                close_segment();
+                segment++;
+                segment_first_record += segment_records;
+                segment_records = 0;
+                synced_records = 0;
+                open_segment();
+                segment_room = (options.segment_size - SegmentHeader::size) / record_size;
+            }
+            size_t buffer_room = (buffer.capacity() - buffer.size()) / record_size;
+            if (buffer_room == 0)
+            {
+                flush();
+                // a large batch is written in many chunks, and must not run past the sync interval
+                sync_if_due();
+                buffer_room = buffer.capacity() / record_size;
+            }
+
+            const size_t batch = std::min({count, segment_room, buffer_room});
+            buffer.insert(buffer.end(), records, records + batch * record_size);
+            records += batch * record_size;
+            count -= batch;
+            segment_records += batch;
+            unsynced_bytes += batch * record_size;
+        }
+        sync_if_due();
+    }
+
+    void LogWriter::sync()
+    {
+        if (fd < 0 || (segment_records == synced_records && buffer.empty()))
+        {
+            return;
+        }
+        // the records must be on disk before the header counts them
+        flush();
+        data_sync(fd);
+        write_header();
+        data_sync(fd);
+        synced_records = segment_records;
+        unsynced_bytes = 0;
+        last_sync = std::chrono::steady_clock::now();
+    }
+
+    void LogWriter::close()
+    {
+        if (fd >= 0)
+        {
+            close_segment();
+        }
+    }
+
+    void LogWriter::open_segment()
+    {
+        const std::string path = segment_path(segment);
+        // never overwrite an existing log
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0)
+        {
+            throw_errno("Cannot create " + path);
+        }
+#if defined(__linux__)
+        // reserve the blocks up front without changing the file size, so the file only ever holds
+        // the header and whole records
+        if (::fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(options.segment_size)) != 0 &&
+            errno != EOPNOTSUPP && errno != ENOSYS)
+        {
+            throw_errno("Cannot preallocate " + path);
+        }
+#endif
+        SegmentHeader header{};
+        std::memcpy(header.magic, SegmentHeader::magic_value, sizeof(header.magic));
+        header.schema = options.schema;
+        header.record_size = record_size;
+        header.segment_index = segment;
+        header.first_record = segment_first_record;
+        size_t written = 0;
+        write_all(fd, reinterpret_cast<const unsigned char *>(&header), sizeof(header), written);
+        data_sync(fd);
+        sync_directory(options.directory);
+        last_sync = std::chrono::steady_clock::now();
+    }
+
+    void LogWriter::close_segment()
+    {
+        try
+        {
+            sync();
+            // give back preallocated blocks past the last record
+            if (::ftruncate(fd, static_cast<off_t>(SegmentHeader::size + segment_records * record_size)) != 0)
+            {
+                throw_errno("Cannot truncate " + segment_path(segment));
+            }
+        }
+        catch (...)
+        {
+            ::close(fd);
+            fd = -1;
+            throw;
+        }
+        ::close(fd);
+        fd = -1;
+    }
+
+    void LogWriter::flush()
+    {
+        size_t written = 0;
+        try
+        {
+            write_all(fd, buffer.data(), buffer.size(), written);
+        }
+        catch (...)
+        {
+            // keep only what did not reach the file, so a retry does not write records twice
+            buffer.erase(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(written));
+            throw;
+        }
+        buffer.clear();
+    }
+
+    void LogWriter::write_header()
+    {
+        const uint64_t count = segment_records;
+        pwrite_all(fd, reinterpret_cast<const unsigned char *>(&count), sizeof(count), offsetof(SegmentHeader, record_count));
+    }
+
+    void LogWriter::sync_if_due()
+    {
+        if (unsynced_bytes >= options.sync_bytes ||
+            std::chrono::steady_clock::now() - last_sync >= options.sync_interval)
+        {
+            sync();
+        }
+    }
+
+} // namespace SeriStruct
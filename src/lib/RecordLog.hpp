@@ -0,0 +1,215 @@
+#pragma once
+#include "RecordArray.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Fixed 64-byte header at the start of every log segment, stored in host byte order.
+     * Records follow it back to back, so a segment can be opened with
+     * MappedRecordFile<T>{path, SegmentHeader::size}.
+     */
+    struct SegmentHeader
+    {
+        static constexpr char magic_value[8] = {'S', 'S', 'T', 'R', 'L', 'O', 'G', '1'};
+        static constexpr size_t size = 64;
+
+        /** Identifies the file as a log segment */
+        char magic[8];
+        /** Caller supplied identifier of the record layout */
+        uint64_t schema;
+        /** Size of each record in bytes */
+        uint64_t record_size;
+        /** Number of records durably written to the segment */
+        uint64_t record_count;
+        /** Position of the segment in the log, starting at 0 */
+        uint64_t segment_index;
+        /** Index of the segment's first record in the whole log */
+        uint64_t first_record;
+        uint64_t reserved[2];
+    };
+    static_assert(sizeof(SegmentHeader) == SegmentHeader::size, "Segment header must be 64 bytes");
+
+    /**
+     * @brief Reads and checks the header of the log segment at \p path.
+     *
+     * @param path is the path of the segment
+     * @return SegmentHeader
+     *
+     * @exception std::system_error if the file cannot be read
+     * @exception SeriStruct::invalid_size if the file does not start with a segment header
+     */
+    SegmentHeader read_segment_header(const std::string &path);
+
+    /**
+     * @brief Append-only writer of fixed-size records to a log split into segment files.
+     *
+     * Records are buffered and written to the file descriptor in large blocks. Each segment is
+     * preallocated on creation (where the file system supports it) so appends do not pay for block
+     * allocation, and a new segment is started when the next record would not fit within
+     * Options::segment_size. Data is made durable in groups: fdatasync is called once
+     * Options::sync_bytes have been appended or Options::sync_interval has passed since the last
+     * sync, whichever comes first. The record count in the segment header is updated at every sync,
+     * so it always counts the records that are known to be on disk.
+     *
+     * The interval is checked when records are appended, after each block written; call sync() from a
+     * timer to bound the delay while no records arrive. Errors from the operating system are reported
+     * as std::system_error. Bytes that were not written stay buffered, so a later sync() writes each
+     * record once. A writer is not thread safe.
+     */
+    class LogWriter
+    {
+    public:
+        struct Options
+        {
+            /** Directory holding the segments, which must exist */
+            std::string directory = ".";
+            /** Segments are named <prefix>-<index>.log */
+            std::string prefix = "segment";
+            /** Maximum size of a segment in bytes, including its header */
+            size_t segment_size = 64 * 1024 * 1024;
+            /** Bytes appended between syncs */
+            size_t sync_bytes = 1024 * 1024;
+            /** Maximum time between syncs while records are being appended */
+            std::chrono::milliseconds sync_interval{100};
+            /** Size of the write buffer in bytes */
+            size_t buffer_size = 64 * 1024;
+            /** Stored in each segment header to identify the record layout. RecordLogWriter<T> stores T::fingerprint when this is 0. */
+            uint64_t schema = 0;
+        };
+
+        /**
+         * @brief Construct a new LogWriter object and create its first segment.
+         *
+         * @param options configures the log
+         * @param record_size is the size of each record in bytes
+         *
+         * @exception std::system_error if the segment cannot be created
+         * @exception SeriStruct::invalid_size if a record does not fit in a segment
+         */
+        LogWriter(const Options &options, const size_t record_size);
+        LogWriter(const LogWriter &) = delete;
+        LogWriter &operator=(const LogWriter &) = delete;
+
+        /**
+         * @brief Destroy the LogWriter object, syncing and closing the current segment. Errors are
+         * ignored; call close() first to see them.
+         */
+        ~LogWriter() noexcept;
+
+        /**
+         * @brief Appends \p count records stored back to back in \p records.
+         *
+         * @param records is the first byte of the first record
+         * @param count is the number of records
+         */
+        void append(const unsigned char *records, const size_t count);
+
+        /**
+         * @brief Writes buffered records, updates the segment header and waits for both to reach the disk.
+         */
+        void sync();
+
+        /**
+         * @brief Syncs and closes the current segment. Nothing can be appended afterwards.
+         */
+        void close();
+
+        /**
+         * @brief Returns the number of records appended to the log, including unsynced ones.
+         *
+         * @return uint64_t
+         */
+        inline uint64_t record_count() const { return segment_first_record + segment_records; }
+
+        /**
+         * @brief Returns the index of the segment being written.
+         *
+         * @return uint64_t
+         */
+        inline uint64_t segment_index() const { return segment; }
+
+        /**
+         * @brief Returns the path of the segment with index \p index.
+         *
+         * @param index is the index of the segment
+         * @return std::string
+         */
+        std::string segment_path(const uint64_t index) const;
+
+    private:
+        const Options options;
+        const size_t record_size;
+        std::vector<unsigned char> buffer;
+        int fd;
+        uint64_t segment;
+        uint64_t segment_first_record;
+        uint64_t segment_records;
+        uint64_t synced_records;
+        size_t unsynced_bytes;
+        std::chrono::steady_clock::time_point last_sync;
+
+        void open_segment();
+        void close_segment();
+        void flush();
+        void write_header();
+        void sync_if_due();
+    };
+
+    /**
+     * @brief A LogWriter for records of one generated type.
+     *
+     * @tparam T is a generated record type
+     */
+    template <typename T>
+    class RecordLogWriter : public LogWriter
+    {
+        static_assert(T::has_fixed_size, "Records with vstr fields vary in size");
+
+    public:
+        /**
+         * @brief Construct a new RecordLogWriter object and create its first segment.
+         *
+         * @param options configures the log
+         */
+        explicit RecordLogWriter(const Options &options) : LogWriter{with_schema(options), T::buffer_size} {}
+
+        using LogWriter::append;
+
+        /**
+         * @brief Appends \p record. Only the first T::buffer_size bytes are kept.
+         *
+         * @param record is the record to append
+         */
+        inline void append(const T &record) { LogWriter::append(record.data(), 1); }
+
+        /**
+         * @brief Appends the record viewed by \p view.
+         *
+         * @param view is a view of the record to append
+         */
+        inline void append(const typename T::View &view) { LogWriter::append(view.data(), 1); }
+
+        /**
+         * @brief Appends every record in \p records.
+         *
+         * @param records is the batch of records to append
+         */
+        inline void append(const RecordArray<T> &records) { LogWriter::append(records.data(), records.size()); }
+
+    private:
+        static Options with_schema(Options options)
+        {
+            if (options.schema == 0)
+            {
+                options.schema = T::fingerprint;
+            }
+            return options;
+        }
+    };
+
+} // namespace SeriStruct
@@ -0,0 +1,228 @@
+#include "RecordPool.hpp"
+#include <algorithm>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        std::atomic<uint64_t> next_pool_id{1};
+
+        constexpr size_t round_up(size_t value, size_t multiple)
+        {
+            return (value + multiple - 1) / multiple * multiple;
+        }
+    } // namespace
+
+    // Precedes each block. Holds the owning cache while allocated and the free list link while free.
+    union alignas(std::max_align_t) BlockPool::Header
+    {
+        Cache *owner;
+        Header *next;
+    };
+
+    struct BlockPool::Cache
+    {
+        // only touched by the thread that currently owns this cache
+        Header *local = nullptr;
+        // blocks freed by other threads, pushed lock-free and drained all at once by the owner
+        std::atomic<Header *> remote{nullptr};
+        std::atomic<bool> in_use{true};
+        std::atomic<size_t> hits{0};
+        std::atomic<size_t> misses{0};
+        std::atomic<size_t> remote_frees{0};
+        Cache *next_cache = nullptr;
+    };
+
+    // Owns every cache of a pool. Shared with the threads using them, so a thread exiting after
+    // the pool was destroyed can still release its cache safely.
+    struct BlockPool::Registry
+    {
+        std::atomic<Cache *> head{nullptr};
+
+        ~Registry()
+        {
+            Cache *cache = head.load();
+            while (cache)
+            {
+                Cache *next = cache->next_cache;
+                delete cache;
+                cache = next;
+            }
+        }
+    };
+
+    struct BlockPool::ThreadCaches
+    {
+        struct Entry
+        {
+            uint64_t pool_id;
+            std::shared_ptr<Registry> registry;
+            Cache *cache;
+        };
+        std::vector<Entry> entries;
+
+        ~ThreadCaches()
+        {
+            // hand the caches (and any blocks on their free lists) over to the next thread that needs one
+            for (auto &entry : entries)
+            {
+                entry.cache->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    BlockPool::BlockPool(const size_t block_size, const size_t blocks_per_slab, std::pmr::memory_resource *upstream)
+        : pool_id{next_pool_id.fetch_add(1, std::memory_order_relaxed)},
+          block_bytes{block_size},
+          block_stride{sizeof(Header) + round_up(std::max<size_t>(block_size, 1), alignof(std::max_align_t))},
+          blocks_per_slab{std::max<size_t>(blocks_per_slab, 1)},
+          upstream{upstream},
+          registry{std::make_shared<Registry>()},
+          fallbacks{0}
+    {
+    }
+
+    BlockPool::~BlockPool() noexcept
+    {
+        std::lock_guard<std::mutex> lock{slab_mutex};
+        for (auto slab : slabs)
+        {
+            upstream->deallocate(slab, block_stride * blocks_per_slab, alignof(std::max_align_t));
+        }
+    }
+
+    BlockPool::Statistics BlockPool::statistics() const
+    {
+        Statistics stats{0, 0, 0, fallbacks.load(std::memory_order_relaxed), 0};
+        for (Cache *cache = registry->head.load(std::memory_order_acquire); cache; cache = cache->next_cache)
+        {
+            stats.hits += cache->hits.load(std::memory_order_relaxed);
+            stats.misses += cache->misses.load(std::memory_order_relaxed);
+            stats.remote_frees += cache->remote_frees.load(std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock{slab_mutex};
+        stats.slabs = slabs.size();
+        return stats;
+    }
+
+    BlockPool::ThreadCaches &BlockPool::thread_caches()
+    {
+        static thread_local ThreadCaches caches;
+        return caches;
+    }
+
+    BlockPool::Cache *BlockPool::find_cache() const
+    {
+        for (auto &entry : thread_caches().entries)
+        {
+            if (entry.pool_id == pool_id)
+            {
+                return entry.cache;
+            }
+        }
+        return nullptr;
+    }
+
+    BlockPool::Cache *BlockPool::acquire_cache()
+    {
+        Cache *cache = find_cache();
+        if (cache)
+        {
+            return cache;
+        }
+
+        // adopt a cache released by an exited thread, or register a new one
+        for (cache = registry->head.load(std::memory_order_acquire); cache; cache = cache->next_cache)
+        {
+            bool expected = false;
+            if (cache->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                break;
+            }
+        }
+        if (!cache)
+        {
+            cache = new Cache{};
+            cache->next_cache = registry->head.load(std::memory_order_relaxed);
+            while (!registry->head.compare_exchange_weak(cache->next_cache, cache, std::memory_order_release))
+            {
+            }
+        }
+        thread_caches().entries.push_back({pool_id, registry, cache});
+        return cache;
+    }
+
+    BlockPool::Header *BlockPool::allocate_slab()
+    {
+        auto slab = static_cast<unsigned char *>(upstream->allocate(block_stride * blocks_per_slab, alignof(std::max_align_t)));
+        {
+            std::lock_guard<std::mutex> lock{slab_mutex};
+            slabs.push_back(slab);
+        }
+        for (size_t i = 0; i < blocks_per_slab; i++)
+        {
+            auto header = reinterpret_cast<Header *>(slab + i * block_stride);
+            header->next = i + 1 < blocks_per_slab ? reinterpret_cast<Header *>(slab + (i + 1) * block_stride) : nullptr;
+        }
+        return reinterpret_cast<Header *>(slab);
+    }
+
+    void *BlockPool::do_allocate(size_t bytes, size_t alignment)
+    {
+        if (!is_pooled(bytes, alignment))
+        {
+            fallbacks.fetch_add(1, std::memory_order_relaxed);
+            return upstream->allocate(bytes, alignment);
+        }
+
+        Cache *cache = acquire_cache();
+        Header *header = cache->local;
+        if (!header)
+        {
+            header = cache->remote.exchange(nullptr, std::memory_order_acquire);
+        }
+        if (header)
+        {
+            cache->hits.store(cache->hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else
+        {
+            cache->misses.store(cache->misses.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            header = allocate_slab();
+        }
+        cache->local = header->next;
+        header->owner = cache;
+        return header + 1;
+    }
+
+    void BlockPool::do_deallocate(void *p, size_t bytes, size_t alignment)
+    {
+        if (!is_pooled(bytes, alignment))
+        {
+            upstream->deallocate(p, bytes, alignment);
+            return;
+        }
+
+        Header *header = static_cast<Header *>(p) - 1;
+        Cache *owner = header->owner;
+        if (owner == find_cache())
+        {
+            header->next = owner->local;
+            owner->local = header;
+        }
+        else
+        {
+            owner->remote_frees.fetch_add(1, std::memory_order_relaxed);
+            header->next = owner->remote.load(std::memory_order_relaxed);
+            while (!owner->remote.compare_exchange_weak(header->next, header, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+
+    bool BlockPool::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+    {
+        return this == &other;
+    }
+
+} // namespace SeriStruct
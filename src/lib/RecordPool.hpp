@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief A std::pmr::memory_resource that hands out fixed-size blocks carved from larger slabs.
+     * Each thread allocates from and frees to its own free list without locking. Blocks freed on a
+     * thread other than the one that allocated them are pushed onto a lock-free list belonging to the
+     * allocating thread, which reclaims them the next time its own list runs dry.
+     *
+     * Requests larger than block_size() (for example forward compatible records read from a stream)
+     * are passed through to the upstream resource.
+     *
+     * The pool must outlive every block allocated from it. Slabs are only returned to the upstream
+     * resource when the pool is destroyed.
+     */
+    class BlockPool : public std::pmr::memory_resource
+    {
+    public:
+        /**
+         * @brief Counters describing how allocations were served.
+         */
+        struct Statistics
+        {
+            /** Allocations served from a free list */
+            size_t hits;
+            /** Allocations that had to carve a new slab */
+            size_t misses;
+            /** Blocks freed on a thread other than the one that allocated them */
+            size_t remote_frees;
+            /** Allocations passed through to the upstream resource */
+            size_t fallbacks;
+            /** Slabs allocated from the upstream resource */
+            size_t slabs;
+        };
+
+        /**
+         * @brief Construct a new BlockPool object
+         *
+         * @param block_size is the size of each block in bytes
+         * @param blocks_per_slab is how many blocks are carved from each slab
+         * @param upstream is the resource used to allocate slabs and oversized requests
+         */
+        BlockPool(const size_t block_size, const size_t blocks_per_slab = 64,
+                  std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+        BlockPool(const BlockPool &) = delete;
+        BlockPool &operator=(const BlockPool &) = delete;
+
+        /**
+         * @brief Destroy the BlockPool object, releasing all slabs.
+         */
+        ~BlockPool() noexcept;
+
+        /**
+         * @brief Returns the size of the blocks handed out by this pool.
+         *
+         * @return size_t
+         */
+        inline size_t block_size() const { return block_bytes; };
+
+        /**
+         * @brief Returns a snapshot of the allocation counters, summed over all threads.
+         *
+         * @return Statistics
+         */
+        Statistics statistics() const;
+
+    protected:
+        void *do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+    private:
+        struct Cache;
+        struct Registry;
+        struct ThreadCaches;
+        union Header;
+
+        const uint64_t pool_id;
+        const size_t block_bytes;
+        const size_t block_stride;
+        const size_t blocks_per_slab;
+        std::pmr::memory_resource *const upstream;
+        std::shared_ptr<Registry> registry;
+        std::atomic<size_t> fallbacks;
+        mutable std::mutex slab_mutex;
+        std::vector<void *> slabs;
+
+        inline bool is_pooled(size_t bytes, size_t alignment) const
+        {
+            return bytes <= block_bytes && alignment <= alignof(std::max_align_t);
+        }
+        static ThreadCaches &thread_caches();
+        Cache *find_cache() const;
+        Cache *acquire_cache();
+        Header *allocate_slab();
+    };
+
+    /**
+     * @brief The BlockPool for one record type, with blocks of T::buffer_size bytes. Pass the
+     * instance to a record's constructor to allocate its buffer from the pool:
+     *
+     * \code
+     * GenRecordOne record{..., &SeriStruct::RecordPool<GenRecordOne>::instance()};
+     * \endcode
+     *
+     * @tparam T is the record type, which must expose a static buffer_size
+     */
+    template <typename T>
+    class RecordPool : public BlockPool
+    {
+    public:
+        /**
+         * @brief Returns the pool shared by all records of type \p T.
+         *
+         * @return RecordPool&
+         */
+        static RecordPool &instance()
+        {
+            static RecordPool pool;
+            return pool;
+        }
+
+    private:
+        RecordPool() : BlockPool{T::buffer_size} {}
+    };
+
+} // namespace SeriStruct
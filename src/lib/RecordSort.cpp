@@ -0,0 +1,179 @@
+#include "RecordSort.hpp"
+#include "ParallelDetail.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace SeriStruct
+{
+    namespace
+    {
+        constexpr size_t radix = 256;
+        constexpr size_t max_key_width = 8;
+
+        struct Entry
+        {
+            uint64_t key;
+            size_t position;
+        };
+
+        using Histogram = std::array<size_t, radix>;
+
+        /**
+         * Returns (key, position) pairs of every record, in ascending order of key and then position.
+         * sorted is false if every key was equal, in which case the pairs are in their original order.
+         */
+        std::vector<Entry> sort_entries(const unsigned char *records, const size_t count, const size_t stride,
+                                        const SortKey &key, const unsigned threads, bool &sorted)
+        {
+            std::vector<Entry> entries(count);
+            // histogram of each byte of the key, per slice
+            std::vector<std::array<Histogram, max_key_width>> counts(threads);
+
+            parallel_slices(count, threads, [&](const unsigned slice, const size_t begin, const size_t end) {
+                auto &histograms = counts[slice];
+                for (auto &histogram : histograms)
+                {
+                    histogram.fill(0);
+                }
+                for (size_t i = begin; i < end; i++)
+                {
+                    const uint64_t bits = sort_bits(records + i * stride, key);
+                    entries[i] = Entry{bits, i};
+                    for (size_t byte = 0; byte < key.width; byte++)
+                    {
+                        histograms[byte][(bits >> (byte * 8)) & 0xFF]++;
+                    }
+                }
+            });
+
+            std::vector<Entry> scratch(count);
+            std::vector<Histogram> offsets(threads);
+            // the histograms match the slices until the first pass moves entries between them
+            bool counts_current = true;
+            sorted = false;
+            for (size_t byte = 0; byte < key.width; byte++)
+            {
+                const unsigned shift = static_cast<unsigned>(byte * 8);
+                bool uniform = false;
+                for (size_t digit = 0; digit < radix && !uniform; digit++)
+                {
+                    size_t total = 0;
+                    for (unsigned t = 0; t < threads; t++)
+                    {
+                        total += counts[t][byte][digit];
+                    }
+                    uniform = total == count;
+                }
+                if (uniform)
+                {
+                    // every key has the same byte here, so this pass would not move anything
+                    continue;
+                }
+
+                if (!counts_current)
+                {
+                    parallel_slices(count, threads, [&](const unsigned slice, const size_t begin, const size_t end) {
+                        auto &histogram = counts[slice][byte];
+                        histogram.fill(0);
+                        for (size_t i = begin; i < end; i++)
+                        {
+                            histogram[(entries[i].key >> shift) & 0xFF]++;
+                        }
+                    });
+                }
+
+                // each slice writes its entries of a digit after those of the slices before it, so the sort is stable
+                size_t next = 0;
+                for (size_t digit = 0; digit < radix; digit++)
+                {
+                    for (unsigned t = 0; t < threads; t++)
+                    {
+                        offsets[t][digit] = next;
+                        next += counts[t][byte][digit];
+                    }
+                }
+
+                parallel_slices(count, threads, [&](const unsigned slice, const size_t begin, const size_t end) {
+                    Histogram offset = offsets[slice];
+                    for (size_t i = begin; i < end; i++)
+                    {
+                        const Entry &entry = entries[i];
+                        scratch[offset[(entry.key >> shift) & 0xFF]++] = entry;
+                    }
+                });
+
+                entries.swap(scratch);
+                counts_current = false;
+                sorted = true;
+            }
+            return entries;
+        }
+    } // namespace
+
+    SortKey sort_key(const FieldInfo *fields, const size_t field_count, const char *name)
+    {
+        const std::string_view wanted{name};
+        for (size_t f = 0; f < field_count; f++)
+        {
+            const FieldInfo &field = fields[f];
+            if (wanted != field.name)
+            {
+                continue;
+            }
+            const bool valid_width = field.width == 1 || field.width == 2 || field.width == 4 || field.width == 8;
+            if (field.kind == ValueKind::other || field.count != 1 || field.size != field.width || !valid_width)
+            {
+                throw std::invalid_argument{"Field " + std::string{wanted} + " is not a single integral or floating point value"};
+            }
+            return SortKey{field.offset, field.width, field.kind};
+        }
+        throw std::invalid_argument{"No field named " + std::string{wanted}};
+    }
+
+    void radix_sort(unsigned char *records, const size_t count, const size_t stride, const SortKey &key,
+                    const unsigned threads)
+    {
+        if (count < 2)
+        {
+            return;
+        }
+        const unsigned used = thread_count(count, threads, min_records_per_thread);
+        bool sorted;
+        const std::vector<Entry> entries = sort_entries(records, count, stride, key, used, sorted);
+        if (!sorted)
+        {
+            return;
+        }
+
+        // gather whole records in order, then copy them back over the batch
+        std::vector<unsigned char> ordered(count * stride);
+        parallel_slices(count, used, [&](const unsigned, const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                std::memcpy(ordered.data() + i * stride, records + entries[i].position * stride, stride);
+            }
+        });
+        parallel_slices(count, used, [&](const unsigned, const size_t begin, const size_t end) {
+            std::memcpy(records + begin * stride, ordered.data() + begin * stride, (end - begin) * stride);
+        });
+    }
+
+    void radix_sort_index(const unsigned char *records, const size_t count, const size_t stride, const SortKey &key,
+                          size_t *index, const unsigned threads)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        bool sorted;
+        const unsigned used = thread_count(count, threads, min_records_per_thread);
+        const std::vector<Entry> entries = sort_entries(records, count, stride, key, used, sorted);
+        for (size_t i = 0; i < count; i++)
+        {
+            index[i] = entries[i].position;
+        }
+    }
+
+} // namespace SeriStruct
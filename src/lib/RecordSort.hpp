@@ -0,0 +1,168 @@
+#pragma once
+#include "RecordArray.hpp"
+#include "SeriStruct.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <vector>
+
+namespace SeriStruct
+{
+    /**
+     * @brief A single integral or floating point field that records are sorted by.
+     */
+    struct SortKey
+    {
+        /** Offset of the value in the record */
+        size_t offset;
+        /** Size of the value in bytes: 1, 2, 4 or 8 */
+        size_t width;
+        /** How the value is ordered */
+        ValueKind kind;
+    };
+
+    /**
+     * @brief Returns the sort key for the field named \p name.
+     *
+     * @param fields describes the fields of the record
+     * @param field_count is the number of fields
+     * @param name is the name of the field in the IDL
+     * @return SortKey
+     *
+     * @exception std::invalid_argument if there is no such field, or it is not a single integral or
+     * floating point value (arrays, optionals and strings cannot be sort keys)
+     */
+    SortKey sort_key(const FieldInfo *fields, const size_t field_count, const char *name);
+
+    /**
+     * @brief Returns the sort key for the field of generated record type \p T named \p name.
+     *
+     * @tparam T is a generated record type
+     * @param name is the name of the field in the IDL
+     * @return SortKey
+     *
+     * @exception std::invalid_argument if the field cannot be a sort key
+     */
+    template <typename T>
+    SortKey sort_key(const char *name)
+    {
+        return sort_key(T::field_info, std::size(T::field_info), name);
+    }
+
+    /**
+     * @brief Maps the key of \p record to an unsigned integer that orders the same way: signed values
+     * have their sign bit flipped, and floating point values are flipped so that negative numbers order
+     * first. -0.0 orders just before 0.0, and NaNs order after infinity (or before negative infinity,
+     * if their sign bit is set).
+     *
+     * @param record is the first byte of a record
+     * @param key is the field to read
+     * @return uint64_t
+     */
+    inline uint64_t sort_bits(const unsigned char *record, const SortKey &key)
+    {
+        uint64_t bits;
+        switch (key.width)
+        {
+        case 1:
+            uint8_t value_8;
+            std::memcpy(&value_8, record + key.offset, 1);
+            bits = value_8;
+            break;
+        case 2:
+            uint16_t value_16;
+            std::memcpy(&value_16, record + key.offset, 2);
+            bits = value_16;
+            break;
+        case 4:
+            uint32_t value_32;
+            std::memcpy(&value_32, record + key.offset, 4);
+            bits = value_32;
+            break;
+        default:
+            std::memcpy(&bits, record + key.offset, 8);
+            break;
+        }
+        const uint64_t sign = uint64_t{1} << (key.width * 8 - 1);
+        if (key.kind == ValueKind::signed_integer)
+        {
+            bits ^= sign;
+        }
+        else if (key.kind == ValueKind::floating)
+        {
+            const uint64_t all = sign | (sign - 1);
+            bits = (bits & sign) ? ~bits & all : bits | sign;
+        }
+        return bits;
+    }
+
+    /**
+     * @brief Sorts \p count records stored back to back by the value of \p key, in ascending order. The
+     * sort is stable.
+     *
+     * It is an LSD radix sort over (key, position) pairs, one pass per byte of the key; passes where every
+     * key has the same byte are skipped. Each pass is split across \p threads threads. Once the order is
+     * known each record is copied once, as a whole, to its place.
+     *
+     * @param records is the first byte of the first record
+     * @param count is the number of records
+     * @param stride is the distance in bytes between consecutive records
+     * @param key is the field to sort by
+     * @param threads is the number of threads to use, or 0 for one per hardware thread. Small batches use fewer.
+     */
+    void radix_sort(unsigned char *records, const size_t count, const size_t stride, const SortKey &key,
+                    const unsigned threads = 0);
+
+    /**
+     * @brief Sorts positions instead of records: fills \p index with 0 to \p count - 1, ordered so that
+     * the records at those positions are in ascending order of \p key. The records are not moved. The
+     * sort is stable.
+     *
+     * @param records is the first byte of the first record
+     * @param count is the number of records
+     * @param stride is the distance in bytes between consecutive records
+     * @param key is the field to sort by
+     * @param index receives \p count positions
+     * @param threads is the number of threads to use, or 0 for one per hardware thread. Small batches use fewer.
+     */
+    void radix_sort_index(const unsigned char *records, const size_t count, const size_t stride, const SortKey &key,
+                          size_t *index, const unsigned threads = 0);
+
+    /**
+     * @brief Sorts a batch of records by the field named \p field, in ascending order. The sort is stable.
+     *
+     * @tparam T is a generated record type
+     * @param records is the batch to sort
+     * @param field is the name of an integral or floating point field
+     * @param threads is the number of threads to use, or 0 for one per hardware thread
+     *
+     * @exception std::invalid_argument if the field cannot be a sort key
+     */
+    template <typename T>
+    void radix_sort(RecordArray<T> &records, const char *field, const unsigned threads = 0)
+    {
+        radix_sort(records.data(), records.size(), RecordArray<T>::stride, sort_key<T>(field), threads);
+    }
+
+    /**
+     * @brief Returns the positions of the records in \p records, ordered by the field named \p field.
+     * The batch is not changed.
+     *
+     * @tparam T is a generated record type
+     * @param records is the batch to sort
+     * @param field is the name of an integral or floating point field
+     * @param threads is the number of threads to use, or 0 for one per hardware thread
+     * @return std::vector<size_t>
+     *
+     * @exception std::invalid_argument if the field cannot be a sort key
+     */
+    template <typename T>
+    std::vector<size_t> radix_sort_index(const RecordArray<T> &records, const char *field, const unsigned threads = 0)
+    {
+        std::vector<size_t> index(records.size());
+        radix_sort_index(records.data(), records.size(), RecordArray<T>::stride, sort_key<T>(field), index.data(), threads);
+        return index;
+    }
+
+} // namespace SeriStruct
@@ -0,0 +1,50 @@
+#include "RecordStream.hpp"
+#include <cstring>
+
+namespace SeriStruct
+{
+    void write_frame(std::ostream &ostr, const uint64_t fingerprint, const size_t record_size,
+                     const unsigned char *records, const size_t count)
+    {
+        FrameHeader header;
+        std::memcpy(header.magic, FrameHeader::magic_value, sizeof(header.magic));
+        header.fingerprint = fingerprint;
+        header.record_size = record_size;
+        header.record_count = count;
+        ostr.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        ostr.write(reinterpret_cast<const char *>(records), static_cast<std::streamsize>(record_size * count));
+    }
+
+    bool read_frame_header(std::istream &istr, FrameHeader &header)
+    {
+        istr.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (istr.gcount() == 0 && istr.eof())
+        {
+            return false;
+        }
+        if (static_cast<size_t>(istr.gcount()) < sizeof(header))
+        {
+            throw not_enough_data{};
+        }
+        if (std::memcmp(header.magic, FrameHeader::magic_value, sizeof(header.magic)) != 0)
+        {
+            throw invalid_size{};
+        }
+        return true;
+    }
+
+    bool read_frame_header(const unsigned char *bytes, const size_t size, FrameHeader &header)
+    {
+        if (size < sizeof(header))
+        {
+            return false;
+        }
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::memcmp(header.magic, FrameHeader::magic_value, sizeof(header.magic)) != 0)
+        {
+            throw invalid_size{};
+        }
+        return true;
+    }
+
+} // namespace SeriStruct
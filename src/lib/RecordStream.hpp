@@ -0,0 +1,117 @@
+#pragma once
+#include "RecordArray.hpp"
+#include "SeriStruct.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+namespace SeriStruct
+{
+    /**
+     * @brief Fixed 32-byte header in front of every batch of a framed stream, stored in host byte
+     * order. The records of the batch follow it back to back.
+     */
+    struct FrameHeader
+    {
+        static constexpr char magic_value[8] = {'S', 'S', 'T', 'R', 'F', 'R', 'M', '1'};
+        static constexpr size_t size = 32;
+
+        /** Identifies the start of a frame */
+        char magic[8];
+        /** Fingerprint of the record layout (T::fingerprint for generated records) */
+        uint64_t fingerprint;
+        /** Size of each record in bytes */
+        uint64_t record_size;
+        /** Number of records in the frame */
+        uint64_t record_count;
+    };
+    static_assert(sizeof(FrameHeader) == FrameHeader::size, "Frame header must be 32 bytes");
+
+    /**
+     * @brief Writes one frame: a header followed by \p count records stored back to back in \p records.
+     *
+     * @param ostr is a std::ostream ready for writing
+     * @param fingerprint identifies the record layout
+     * @param record_size is the size of each record in bytes
+     * @param records is the first byte of the first record
+     * @param count is the number of records
+     */
+    void write_frame(std::ostream &ostr, const uint64_t fingerprint, const size_t record_size,
+                     const unsigned char *records, const size_t count);
+
+    /**
+     * @brief Reads the header of the next frame from \p istr.
+     *
+     * @param istr is an open stream for reading the bytes
+     * @param header receives the header
+     * @return true if a header was read
+     * @return false if \p istr was already at EOF
+     *
+     * @exception SeriStruct::not_enough_data if EOF is reached part way through the header
+     * @exception SeriStruct::invalid_size if the bytes are not a frame header
+     */
+    bool read_frame_header(std::istream &istr, FrameHeader &header);
+
+    /**
+     * @brief Reads the header of the frame at the start of \p bytes.
+     *
+     * @param bytes holds the frame
+     * @param size is the number of bytes available in \p bytes
+     * @param header receives the header
+     * @return true if a header was read
+     * @return false if \p size is too small to hold a header
+     *
+     * @exception SeriStruct::invalid_size if the bytes are not a frame header
+     */
+    bool read_frame_header(const unsigned char *bytes, const size_t size, FrameHeader &header);
+
+    /**
+     * @brief Writes every record in \p records to \p ostr as one frame.
+     *
+     * @tparam T is a generated record type
+     * @param ostr is a std::ostream ready for writing
+     * @param records is the batch of records to write
+     */
+    template <typename T>
+    void write_frame(std::ostream &ostr, const RecordArray<T> &records)
+    {
+        write_frame(ostr, T::fingerprint, T::buffer_size, records.data(), records.size());
+    }
+
+    /**
+     * @brief Reads the next frame from \p istr and appends its records to \p records. The frame is
+     * checked once, against T's fingerprint and size, rather than record by record.
+     *
+     * @tparam T is a generated record type
+     * @param istr is an open stream for reading the bytes
+     * @param records receives the records of the frame
+     * @return true if a frame was read
+     * @return false if \p istr was already at EOF
+     *
+     * @exception SeriStruct::schema_mismatch if the frame holds records of another layout
+     * @exception SeriStruct::not_enough_data if EOF is reached part way through the frame. \p records
+     * is left as it was.
+     * @exception SeriStruct::invalid_size if the bytes are not a frame, or it holds too many records to fit in memory
+     */
+    template <typename T>
+    bool read_frame(std::istream &istr, RecordArray<T> &records)
+    {
+        FrameHeader header;
+        if (!read_frame_header(istr, header))
+        {
+            return false;
+        }
+        if (header.fingerprint != T::fingerprint || header.record_size != T::buffer_size)
+        {
+            throw schema_mismatch{};
+        }
+        if (header.record_count > std::numeric_limits<size_t>::max() / T::buffer_size)
+        {
+            throw invalid_size{};
+        }
+        records.read(istr, static_cast<size_t>(header.record_count));
+        return true;
+    }
+
+} // namespace SeriStruct
@@ -2,18 +2,48 @@
 
 namespace SeriStruct
 {
+    namespace
+    {
+        // fingerprint and number of entries
+        constexpr size_t patch_header_size = sizeof(uint64_t) + sizeof(uint32_t);
+        // field index and value size
+        constexpr size_t patch_entry_header_size = 2 * sizeof(uint32_t);
+
+        bool is_vstr(const FieldInfo &field, const size_t *vstr_offsets, const size_t vstr_count)
+        {
+            return std::find(vstr_offsets, vstr_offsets + vstr_count, field.offset) != vstr_offsets + vstr_count;
+        }
+    } // namespace
+
+    void check_vstr_slots(const unsigned char *record, const size_t size, const size_t fixed_size,
+                          const size_t *vstr_offsets, const size_t vstr_count)
+    {
+        for (size_t i = 0; i < vstr_count; i++)
+        {
+            uint32_t slot[2];
+            std::memcpy(slot, record + vstr_offsets[i], vstr_slot_size);
+            if (slot[0] < fixed_size || slot[0] > size || slot[1] > size - slot[0])
+            {
+                throw invalid_size{};
+            }
+        }
+    }
+
     std::ostream &operator<<(std::ostream &ostr, const Record &record)
     {
         record.write(ostr);
         return ostr;
     }
 
+    std::ostream &operator<<(std::ostream &ostr, const RecordView &view)
+    {
+        view.write(ostr);
+        return ostr;
+    }
+
     void Record::write(std::ostream &ostr) const
     {
-        for (size_t i = 0; i < this->size() / sizeof(unsigned char); i++)
-        {
-            ostr << this->buffer[i];
-        }
+        ostr.write(reinterpret_cast<const char *>(this->buffer), size());
     }
 
     void Record::copy_to(unsigned char *buffer) const
@@ -28,11 +58,200 @@ namespace SeriStruct
 
     void Record::from_stream(std::istream &istr, const size_t read_size)
     {
-        istr.read(reinterpret_cast<char *>(buffer), read_size);
+        istr.read(reinterpret_cast<char *>(buffer), std::min(read_size, size()));
         if (istr.eof() && istr.fail())
         {
             throw not_enough_data{};
         }
+        if (read_size > size())
+        {
+            istr.ignore(read_size - size());
+            if (static_cast<size_t>(istr.gcount()) < read_size - size())
+            {
+                throw not_enough_data{};
+            }
+        }
+    }
+
+    void Record::replace_vstr(const size_t &offset, const std::string_view &value, const size_t &fixed_size,
+                              const size_t *vstr_offsets, const size_t &vstr_count)
+    {
+        assert(("Records with vstr fields cannot use inline storage", !inline_capacity));
+        size_t total_size = fixed_size;
+        for (size_t i = 0; i < vstr_count; i++)
+        {
+            total_size += vstr_offsets[i] == offset ? value.size() : buffer_at_vstr(vstr_offsets[i]).size();
+        }
+        if (total_size > UINT32_MAX)
+        {
+            throw invalid_size{};
+        }
+
+        // the old buffer stays alive until every value, including one that points into it, is copied
+        unsigned char *old_buffer = buffer;
+        const size_t old_size = alloc_size;
+        unsigned char *new_buffer = static_cast<unsigned char *>(resource->allocate(total_size, alignof(std::max_align_t)));
+        std::memcpy(new_buffer, old_buffer, fixed_size);
+        size_t heap_offset = fixed_size;
+        for (size_t i = 0; i < vstr_count; i++)
+        {
+            const std::string_view text = vstr_offsets[i] == offset ? value : vstr_field(old_buffer, vstr_offsets[i]);
+            const uint32_t slot[2] = {static_cast<uint32_t>(heap_offset), static_cast<uint32_t>(text.size())};
+            std::memcpy(new_buffer + vstr_offsets[i], slot, vstr_slot_size);
+            if (!text.empty())
+            {
+                std::memcpy(new_buffer + heap_offset, text.data(), text.size());
+            }
+            heap_offset += text.size();
+        }
+        buffer = new_buffer;
+        alloc_size = total_size;
+        resource->deallocate(old_buffer, old_size, alignof(std::max_align_t));
+    }
+
+    size_t Record::begin_patch(const uint64_t fingerprint, std::vector<unsigned char> &patch)
+    {
+        const size_t start = patch.size();
+        patch.resize(start + patch_header_size);
+        std::memcpy(patch.data() + start, &fingerprint, sizeof(uint64_t));
+        std::memset(patch.data() + start + sizeof(uint64_t), 0, sizeof(uint32_t));
+        return start;
+    }
+
+    void Record::append_patch_entry(const size_t index, const FieldInfo &field, const size_t *vstr_offsets, const size_t vstr_count,
+                                    std::vector<unsigned char> &patch) const
+    {
+        const unsigned char *bytes = buffer + field.offset;
+        const unsigned char *value = bytes;
+        size_t value_size = field.size;
+        bool is_present = false;
+        if (is_vstr(field, vstr_offsets, vstr_count))
+        {
+            const std::string_view text = vstr_field(buffer, field.offset);
+            value = reinterpret_cast<const unsigned char *>(text.data());
+            value_size = text.size();
+        }
+        else if (field.is_string)
+        {
+            // the presence flag, then only the text
+            const std::string_view text = string_field_str(bytes, field.size - string_header_size - 1);
+            is_present = string_field_cstr(bytes) != nullptr;
+            value = reinterpret_cast<const unsigned char *>(text.data());
+            value_size = text.size() + 1;
+        }
+
+        const uint32_t entry[2] = {static_cast<uint32_t>(index), static_cast<uint32_t>(value_size)};
+        const unsigned char *entry_bytes = reinterpret_cast<const unsigned char *>(entry);
+        patch.insert(patch.end(), entry_bytes, entry_bytes + patch_entry_header_size);
+        if (field.is_string)
+        {
+            patch.push_back(is_present);
+            value_size--;
+        }
+        patch.insert(patch.end(), value, value + value_size);
+    }
+
+    size_t Record::apply_patch(const uint64_t fingerprint, const FieldInfo *fields, const size_t field_count, const size_t fixed_size,
+                               const size_t *vstr_offsets, const size_t vstr_count, const unsigned char *patch, const size_t size)
+    {
+        if (size < patch_header_size)
+        {
+            throw not_enough_data{};
+        }
+        uint64_t patch_fingerprint;
+        uint32_t entries;
+        std::memcpy(&patch_fingerprint, patch, sizeof(uint64_t));
+        std::memcpy(&entries, patch + sizeof(uint64_t), sizeof(uint32_t));
+        if (patch_fingerprint != fingerprint)
+        {
+            throw schema_mismatch{};
+        }
+
+        // check every entry first, so a bad patch leaves the record as it was
+        size_t offset = patch_header_size;
+        for (uint32_t e = 0; e < entries; e++)
+        {
+            if (size - offset < patch_entry_header_size)
+            {
+                throw not_enough_data{};
+            }
+            uint32_t entry[2];
+            std::memcpy(entry, patch + offset, patch_entry_header_size);
+            offset += patch_entry_header_size;
+            if (entry[0] >= field_count)
+            {
+                throw invalid_size{};
+            }
+            if (size - offset < entry[1])
+            {
+                throw not_enough_data{};
+            }
+            const FieldInfo &field = fields[entry[0]];
+            if (field.offset + field.size > alloc_size)
+            {
+                throw invalid_size{};
+            }
+            if (is_vstr(field, vstr_offsets, vstr_count))
+            {
+                // any length
+            }
+            else if (field.is_string)
+            {
+                if (entry[1] < 1 || entry[1] - 1 > field.count - string_header_size - 1 || (!patch[offset] && entry[1] > 1))
+                {
+                    throw invalid_size{};
+                }
+            }
+            else if (entry[1] != field.size)
+            {
+                throw invalid_size{};
+            }
+            offset += entry[1];
+        }
+        const size_t patch_size = offset;
+
+        offset = patch_header_size;
+        for (uint32_t e = 0; e < entries; e++)
+        {
+            uint32_t entry[2];
+            std::memcpy(entry, patch + offset, patch_entry_header_size);
+            offset += patch_entry_header_size;
+            const FieldInfo &field = fields[entry[0]];
+            const unsigned char *value = patch + offset;
+            if (is_vstr(field, vstr_offsets, vstr_count))
+            {
+                replace_vstr(field.offset, std::string_view{reinterpret_cast<const char *>(value), entry[1]}, fixed_size, vstr_offsets, vstr_count);
+            }
+            else if (field.is_string)
+            {
+                unsigned char *bytes = buffer + field.offset;
+                const bool is_present = value[0] != 0;
+                const uint32_t length = entry[1] - 1;
+                std::memset(bytes, 0, field.count);
+                std::memcpy(bytes, &is_present, sizeof(bool));
+                bytes[string_length_offset] = static_cast<unsigned char>(length);
+                bytes[string_length_offset + 1] = static_cast<unsigned char>(length >> 8);
+                bytes[string_length_offset + 2] = static_cast<unsigned char>(length >> 16);
+                bytes[string_length_offset + 3] = static_cast<unsigned char>(length >> 24);
+                std::memcpy(bytes + string_header_size, value + 1, length);
+            }
+            else
+            {
+                std::memcpy(buffer + field.offset, value, entry[1]);
+            }
+            offset += entry[1];
+        }
+        return patch_size;
+    }
+
+    void RecordView::write(std::ostream &ostr) const
+    {
+        ostr.write(reinterpret_cast<const char *>(this->buffer), size());
+    }
+
+    void RecordView::copy_to(unsigned char *buffer) const
+    {
+        std::memcpy(buffer, this->buffer, size());
     }
 
 } // namespace SeriStruct
\ No newline at end of file
@@ -1,18 +1,26 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <bitset>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <exception>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
 #include <optional>
 #include <string_view>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace SeriStruct
 {
     class Record;
+    class RecordView;
     /**
      * @brief Writes a SeriStruct::Record to a std::ostream.
      * 
@@ -20,6 +28,13 @@ namespace SeriStruct
      */
     std::ostream &operator<<(std::ostream &, const Record &);
 
+    /**
+     * @brief Writes a SeriStruct::RecordView to a std::ostream.
+     * 
+     * @return std::ostream&
+     */
+    std::ostream &operator<<(std::ostream &, const RecordView &);
+
     /**
      * @brief Exception thrown when reading a stream of bytes to a SeriStruct::Record
      * and the size in the stream doesn't match the expected size of the struct.
@@ -44,12 +59,198 @@ namespace SeriStruct
         }
     };
 
+    /**
+     * @brief Exception thrown when framed data was written with a record layout
+     * other than the one it is being read as.
+     */
+    class schema_mismatch : public std::exception
+    {
+        const char *what() const throw()
+        {
+            return "Record schema mismatch";
+        }
+    };
+
+    /**
+     * @brief How the values of a field are ordered: as unsigned or signed integers, as floating point
+     * numbers, or not at all (strings and vstr slots).
+     */
+    enum class ValueKind : uint8_t
+    {
+        other,
+        unsigned_integer,
+        signed_integer,
+        floating
+    };
+
+    /**
+     * @brief Returns the ValueKind of values of type \p T.
+     *
+     * @tparam T is the type of the values
+     * @return ValueKind
+     */
+    template <typename T>
+    constexpr ValueKind value_kind()
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return ValueKind::floating;
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            return std::is_signed_v<T> ? ValueKind::signed_integer : ValueKind::unsigned_integer;
+        }
+        else
+        {
+            return ValueKind::other;
+        }
+    }
+
+    /**
+     * @brief Layout of one field of a generated record: \p count values of \p width bytes each,
+     * starting \p offset bytes into the record and spanning \p size bytes in all. Generated records list
+     * their fields in a static field_info array. Values with a width of 1 (bools, chars and the bytes of
+     * strings) are the same in every byte order.
+     */
+    struct FieldInfo
+    {
+        /** Name of the field in the IDL */
+        const char *name;
+        /** Offset of the first value in the record */
+        size_t offset;
+        /** Size of each value in bytes */
+        size_t width;
+        /** Number of values */
+        size_t count;
+        /** True for cstr and str fields, which are encoded as described at string_header_size */
+        bool is_string = false;
+        /** Bytes the whole field takes in the record, such as the values and presence flag of an optional */
+        size_t size = 0;
+        /** How each value is ordered */
+        ValueKind kind = ValueKind::other;
+    };
+
+    /**
+     * @brief Encoded cstr and str fields start with this many header bytes: a presence flag in the
+     * first byte and the length of the text, little-endian, in the four bytes at string_length_offset.
+     * The NUL terminated text follows the header and the rest of the field is zero.
+     */
+    constexpr size_t string_header_size = 8;
+    constexpr size_t string_length_offset = 4;
+
+    /**
+     * @brief Decodes a cstr or str field from its encoded bytes.
+     * 
+     * @param field is the first byte of the encoded field
+     * @return const char* is the text, or nullptr if no string was assigned
+     */
+    inline const char *string_field_cstr(const unsigned char *field)
+    {
+        bool is_present;
+        std::memcpy(&is_present, field, sizeof(bool));
+        return is_present ? reinterpret_cast<const char *>(field + string_header_size) : nullptr;
+    }
+
+    /**
+     * @brief Decodes a cstr or str field from its encoded bytes as a std::string_view, in constant time.
+     * The stored length may come from untrusted bytes, so the text is clamped to the field.
+     * 
+     * @param field is the first byte of the encoded field
+     * @param maxlen is the maximum length allowed for the field
+     * @return std::string_view is the text, or an empty view if no string was assigned
+     */
+    inline std::string_view string_field_str(const unsigned char *field, const size_t maxlen)
+    {
+        const char *cstr = string_field_cstr(field);
+        if (cstr == nullptr)
+        {
+            return std::string_view{};
+        }
+        const unsigned char *length_bytes = field + string_length_offset;
+        const size_t length = static_cast<size_t>(length_bytes[0]) | static_cast<size_t>(length_bytes[1]) << 8 |
+                              static_cast<size_t>(length_bytes[2]) << 16 | static_cast<size_t>(length_bytes[3]) << 24;
+        if (length == 0 && cstr[0] != '\0')
+        {
+            // encoded before lengths were stored, so the text ends at its NUL or the end of the field
+            return std::string_view{cstr, static_cast<size_t>(std::find(cstr, cstr + maxlen, '\0') - cstr)};
+        }
+        return std::string_view{cstr, std::min(length, maxlen)};
+    }
+
+    /**
+     * @brief Encodes \p value into the cstr or str field at \p field, which holds up to \p maxlen
+     * characters. Only the text is copied and the rest of the field is cleared, so no bytes of a
+     * previous, longer value remain.
+     * 
+     * @param field is the first byte of the encoded field
+     * @param value is the NUL terminated string, or nullptr. Characters past \p maxlen are dropped.
+     * @param maxlen is the maximum length allowed for the field
+     */
+    inline void encode_string_field(unsigned char *field, const char *value, const size_t maxlen)
+    {
+        // stops at the NUL or maxlen, so long values are never scanned to the end
+        const size_t length = value ? static_cast<size_t>(std::find(value, value + maxlen, '\0') - value) : 0;
+        std::memset(field, 0, string_header_size);
+        const bool is_present = value != nullptr;
+        std::memcpy(field, &is_present, sizeof(bool));
+        field[string_length_offset] = static_cast<unsigned char>(length);
+        field[string_length_offset + 1] = static_cast<unsigned char>(length >> 8);
+        field[string_length_offset + 2] = static_cast<unsigned char>(length >> 16);
+        field[string_length_offset + 3] = static_cast<unsigned char>(length >> 24);
+        if (length)
+        {
+            std::memcpy(field + string_header_size, value, length);
+        }
+        std::memset(field + string_header_size + length, 0, maxlen + 1 - length);
+    }
+
+    /**
+     * @brief A vstr field keeps two uint32_t values in the fixed part of the record: the offset of its
+     * text from the start of the record, then the length of the text. The text of every vstr field is
+     * stored after the fixed part (buffer_size bytes) in declaration order, without NUL terminators, so
+     * the record stays a single buffer that size() and copy_to() cover in full.
+     */
+    constexpr size_t vstr_slot_size = 2 * sizeof(uint32_t);
+
+    /**
+     * @brief Decodes the vstr field whose slot is \p offset bytes into \p record.
+     * 
+     * @param record is the first byte of the record
+     * @param offset is the offset of the field's slot
+     * @return std::string_view is the text, which points into \p record
+     */
+    inline std::string_view vstr_field(const unsigned char *record, const size_t offset)
+    {
+        uint32_t slot[2];
+        std::memcpy(slot, record + offset, vstr_slot_size);
+        return std::string_view{reinterpret_cast<const char *>(record + slot[0]), slot[1]};
+    }
+
+    /**
+     * @brief Checks that the text of every vstr field of the record in \p record lies between the end of
+     * the fixed part and the end of the record. Generated records and views call this when built from
+     * bytes they did not write, so that their getters can trust the slots.
+     * 
+     * @param record is the first byte of the record
+     * @param size is the size of the record in bytes
+     * @param fixed_size is the size of the fixed part of the record (buffer_size)
+     * @param vstr_offsets are the slot offsets of the vstr fields
+     * @param vstr_count is the number of vstr fields
+     * 
+     * @exception SeriStruct::invalid_size if a slot points outside the record's heap
+     */
+    void check_vstr_slots(const unsigned char *record, const size_t size, const size_t fixed_size,
+                          const size_t *vstr_offsets, const size_t vstr_count);
+
     /**
      * @brief A set of data that can be serialized/deserialized into raw bytes. Classes
      * that derive from Record should insert data in the constructor using Record::assign_buffer() and
      * implement getters that read from the internal buffer using Record::buffer_at().
      * Optionally setters can be implemented with the same calls to Record::assign_buffer().
      * 
+     * The internal buffer is allocated from a std::pmr::memory_resource (the default resource unless one is
+     * supplied), so records can be allocated from an arena such as std::pmr::monotonic_buffer_resource.
+     * 
      */
     class Record
     {
@@ -60,17 +261,20 @@ namespace SeriStruct
          * @param istr is an open stream for reading the bytes
          * @param read_size is the numer of bytes to read from \p istr
          * @param expected_size is the minimum size of data this struct expects
+         * @param resource is the memory resource used to allocate the internal buffer
          * 
          * @exception SeriStruct::invalid_size if \p read_size < \p expected_size
          * @exception SeriStruct::not_enough_data if EOF is reached on \p istr before all data could be read
          */
-        Record(std::istream &istr, const size_t read_size, const size_t expected_size) : Record{}
+        Record(std::istream &istr, const size_t read_size, const size_t expected_size,
+               std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : Record{resource}
         {
             if (read_size < expected_size)
             {
                 throw invalid_size{};
             }
-            alloc(read_size);
+            alloc(read_size, false);
             from_stream(istr, read_size);
         }
 
@@ -80,30 +284,35 @@ namespace SeriStruct
          * @param buffer is a buffer of bytes that matches the underling struct (such as from copy_to())
          * @param buffer_size is the size of \p buffer
          * @param expected_size is the minimum size of data this struct expects
+         * @param resource is the memory resource used to allocate the internal buffer
          * 
          * @exception SeriStruct::invalid_size if \p buffer_size < \p expected_size
          */
-        Record(const unsigned char *buffer, const size_t buffer_size, const size_t expected_size) : Record{}
+        Record(const unsigned char *buffer, const size_t buffer_size, const size_t expected_size,
+               std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+            : Record{resource}
         {
             if (buffer_size < expected_size)
             {
                 throw invalid_size{};
             }
-            alloc(buffer_size);
+            alloc(buffer_size, false);
             from_array(buffer, buffer_size);
         }
 
         /**
          * @brief Construct a new Record object by copying \p other. Note that this operation will not likely be meaningful
-         * if \p other and this instance are not the same derived type.
+         * if \p other and this instance are not the same derived type. As with std::pmr containers, the copy does not
+         * inherit the memory resource of \p other.
          * 
          * @param other 
+         * @param resource is the memory resource used to allocate the internal buffer
          */
-        Record(const Record &other) : Record{}
+        Record(const Record &other, std::pmr::memory_resource *resource = std::pmr::get_default_resource()) : Record{resource}
         {
             if (&other != this)
             {
-                alloc(other.alloc_size);
+                alloc(other.alloc_size, false);
                 from_array(other.buffer, alloc_size);
             }
         }
@@ -118,7 +327,7 @@ namespace SeriStruct
         {
             if (&other != this)
             {
-                alloc(other.alloc_size);
+                alloc(other.alloc_size, false);
                 from_array(other.buffer, other.alloc_size);
             }
             return *this;
@@ -127,7 +336,8 @@ namespace SeriStruct
         /**
          * @brief Construct a new Record object by moving \p other. Note that this operation will not likely be meaningful
          * if \p other and this instance are not the same derived type. Attempts to access the fields of \p other after
-         * the move operation are undefined behavior.
+         * the move operation are undefined behavior. The buffer and memory resource of \p other are taken over, unless
+         * \p other uses inline storage (see SeriStruct::InlineRecord), in which case its bytes are copied instead.
          * 
          * @param other 
          */
@@ -135,13 +345,23 @@ namespace SeriStruct
         {
             if (&other != this)
             {
-                std::swap(alloc_size, other.alloc_size);
-                std::swap(buffer, other.buffer);
+                if (other.inline_capacity)
+                {
+                    alloc(other.alloc_size, false);
+                    from_array(other.buffer, other.alloc_size);
+                }
+                else
+                {
+                    std::swap(alloc_size, other.alloc_size);
+                    std::swap(buffer, other.buffer);
+                    std::swap(resource, other.resource);
+                }
             }
         }
 
         /**
-         * @brief Move assignment operator
+         * @brief Move assignment operator. Buffers are only swapped if both records allocate from equal
+         * memory resources, otherwise the bytes of \p other are copied.
          *
          * @param other
          * @return Record&
@@ -149,8 +369,16 @@ namespace SeriStruct
         Record& operator=(Record&& other) noexcept {
             if (&other != this)
             {
-                std::swap(alloc_size, other.alloc_size);
-                std::swap(buffer, other.buffer);
+                if (inline_capacity || other.inline_capacity || !(*resource == *other.resource))
+                {
+                    alloc(other.alloc_size, false);
+                    from_array(other.buffer, other.alloc_size);
+                }
+                else
+                {
+                    std::swap(alloc_size, other.alloc_size);
+                    std::swap(buffer, other.buffer);
+                }
             }
             return *this;
         }
@@ -160,9 +388,9 @@ namespace SeriStruct
          */
         virtual ~Record() noexcept
         {
-            if (buffer)
+            if (buffer && !inline_capacity)
             {
-                delete[] buffer;
+                resource->deallocate(buffer, alloc_size, alignof(std::max_align_t));
             }
         };
 
@@ -174,7 +402,8 @@ namespace SeriStruct
         inline size_t size() const { return alloc_size; };
 
         /**
-         * @brief Writes this Record to \p ostr.
+         * @brief Writes this Record to \p ostr as a single block of bytes. Formatting state
+         * of the stream (such as width or fill) does not affect the output.
          * 
          * @param ostr is a std::ostream ready for writing
          */
@@ -189,12 +418,46 @@ namespace SeriStruct
          */
         void copy_to(unsigned char *buffer) const;
 
+        /**
+         * @brief Returns a pointer to the internal buffer, suitable for constructing a RecordView.
+         * The pointer is invalidated if this Record is reassigned or destroyed.
+         * 
+         * @return const unsigned char* 
+         */
+        inline const unsigned char *data() const { return buffer; };
+
+        /**
+         * @brief Returns the memory resource the internal buffer is allocated from, or nullptr
+         * if this record uses inline storage.
+         * 
+         * @return std::pmr::memory_resource* 
+         */
+        inline std::pmr::memory_resource *get_memory_resource() const { return resource; };
+
     protected:
         /**
          * @brief Construct a new Record object
          * 
          */
-        Record() noexcept : alloc_size{0}, buffer{nullptr} {}
+        Record() noexcept : Record{std::pmr::get_default_resource()} {}
+
+        /**
+         * @brief Construct a new Record object that allocates from \p resource
+         * 
+         * @param resource is the memory resource used to allocate the internal buffer
+         */
+        explicit Record(std::pmr::memory_resource *resource) noexcept
+            : alloc_size{0}, inline_capacity{0}, buffer{nullptr}, resource{resource} {}
+
+        /**
+         * @brief Construct a new Record object that keeps its bytes in \p storage instead of allocating.
+         * \p storage is owned by the derived class and must live as long as this object (see SeriStruct::InlineRecord).
+         * 
+         * @param storage is the fixed storage for the internal buffer
+         * @param capacity is the size of \p storage in bytes
+         */
+        Record(unsigned char *storage, const size_t capacity) noexcept
+            : alloc_size{0}, inline_capacity{capacity}, buffer{storage}, resource{nullptr} {}
 
         /**
          * @brief Assigns a value to a particular offset in the buffer. Note that \p value must be an
@@ -231,7 +494,8 @@ namespace SeriStruct
 
         /**
          * @brief Assign an optional value to a particular offset in the buffer. \p value can be an integral,
-         * floating point, or a std::array of such.
+         * floating point, or a std::array of such. The field is written whole from zeroed bytes, so its
+         * padding and the value of an empty optional are always zero and equal records have equal bytes.
          * 
          * @tparam T is the type of value in the optional
          * @param offset is the offset into the buffer
@@ -240,9 +504,18 @@ namespace SeriStruct
         template <typename T>
         inline void assign_buffer(const size_t &offset, const std::optional<T> &value)
         {
+            static_assert(std::is_trivially_copyable<std::optional<T>>::value, "Optional fields must be trivially copyable");
             assert(("Buffer was not allocated", buffer));
             assert(("Attempt to write past end of buffer", offset + sizeof(std::optional<T>) <= alloc_size));
-            *(reinterpret_cast<std::optional<T> *>(buffer + offset)) = value;
+            // the value then the engaged flag, as ssgen.py lays optionals out. Constructing the optional in
+            // place would let the compiler drop the clearing of its padding as a store to a dead object.
+            unsigned char bytes[sizeof(std::optional<T>)] = {};
+            if (value)
+            {
+                std::memcpy(bytes, &*value, sizeof(T));
+                bytes[sizeof(T)] = 1;
+            }
+            std::memcpy(buffer + offset, bytes, sizeof(bytes));
         }
 
         /**
@@ -255,18 +528,108 @@ namespace SeriStruct
         inline void assign_buffer(const size_t &offset, const char *value, const size_t &maxlen)
         {
             assert(("Buffer was not allocated", buffer));
-            assert(("Attempt to write past end of buffer", offset + maxlen + alignof(char *) + 1 <= alloc_size));
-            if (value == nullptr)
+            assert(("Attempt to write past end of buffer", offset + string_header_size + maxlen + 1 <= alloc_size));
+            encode_string_field(buffer + offset, value, maxlen);
+        }
+
+        /**
+         * @brief Assigns a vstr field while the record is being constructed, copying the text of \p value
+         * to \p heap_offset. The buffer must have been allocated with room for the text of every vstr field.
+         * 
+         * @param offset is the offset of the field's slot
+         * @param value is the text
+         * @param heap_offset is where the text goes, just after the text of the previous vstr field
+         * @return size_t is where the text of the next vstr field goes
+         * 
+         * @exception SeriStruct::invalid_size if the record would grow past 4 GiB
+         */
+        inline size_t assign_vstr(const size_t &offset, const std::string_view &value, const size_t &heap_offset)
+        {
+            assert(("Buffer was not allocated", buffer));
+            assert(("Attempt to write past end of buffer", heap_offset + value.size() <= alloc_size));
+            if (heap_offset + value.size() > UINT32_MAX)
             {
-                *(reinterpret_cast<char *>(buffer + offset)) = false;
+                throw invalid_size{};
             }
-            else
+            const uint32_t slot[2] = {static_cast<uint32_t>(heap_offset), static_cast<uint32_t>(value.size())};
+            std::memcpy(buffer + offset, slot, vstr_slot_size);
+            if (!value.empty())
+            {
+                std::memcpy(buffer + heap_offset, value.data(), value.size());
+            }
+            return heap_offset + value.size();
+        }
+
+        /**
+         * @brief Replaces the text of a vstr field. The buffer is reallocated to fit and the text of every
+         * vstr field is laid out again after the fixed part, so no bytes of the old value remain.
+         * \p value may point into this record.
+         * 
+         * @param offset is the offset of the field's slot
+         * @param value is the new text
+         * @param fixed_size is the size of the fixed part of the record (buffer_size)
+         * @param vstr_offsets are the slot offsets of every vstr field, in declaration order
+         * @param vstr_count is the number of vstr fields
+         * 
+         * @exception SeriStruct::invalid_size if the record would grow past 4 GiB
+         */
+        void replace_vstr(const size_t &offset, const std::string_view &value, const size_t &fixed_size,
+                          const size_t *vstr_offsets, const size_t &vstr_count);
+
+        /**
+         * @brief Appends a patch with the current value of every field set in \p dirty to \p patch.
+         * The patch starts with \p fingerprint and the number of entries. Each entry is the index of
+         * the field, the size of its value and the value: the field's bytes, or for strings the presence
+         * flag and text only. Everything is in host byte order.
+         * 
+         * @tparam N is the number of fields
+         * @param fingerprint identifies the record layout
+         * @param fields describes the fields of the record
+         * @param dirty selects the fields to include, by index in \p fields
+         * @param vstr_offsets are the slot offsets of the vstr fields
+         * @param vstr_count is the number of vstr fields
+         * @param patch receives the patch
+         * @return size_t is the number of bytes appended
+         */
+        template <size_t N>
+        size_t write_patch(const uint64_t fingerprint, const FieldInfo (&fields)[N], const std::bitset<N> &dirty,
+                           const size_t *vstr_offsets, const size_t vstr_count, std::vector<unsigned char> &patch) const
+        {
+            const size_t start = begin_patch(fingerprint, patch);
+            uint32_t entries = 0;
+            for (size_t i = 0; i < N; i++)
             {
-                *(reinterpret_cast<char *>(buffer + offset)) = true;
-                strncpy(reinterpret_cast<char *>(buffer + offset + alignof(char *)), value, std::min(maxlen, strlen(value)));
+                if (dirty.test(i))
+                {
+                    append_patch_entry(i, fields[i], vstr_offsets, vstr_count, patch);
+                    entries++;
+                }
             }
+            std::memcpy(patch.data() + start + sizeof(uint64_t), &entries, sizeof(uint32_t));
+            return patch.size() - start;
         }
 
+        /**
+         * @brief Applies a patch written by write_patch() for a record of the same layout. The whole patch
+         * is checked before any field is changed.
+         * 
+         * @param fingerprint identifies the record layout
+         * @param fields describes the fields of the record
+         * @param field_count is the number of fields
+         * @param fixed_size is the size of the fixed part of the record (buffer_size)
+         * @param vstr_offsets are the slot offsets of the vstr fields
+         * @param vstr_count is the number of vstr fields
+         * @param patch holds the patch
+         * @param size is the number of bytes available in \p patch
+         * @return size_t is the size of the patch in bytes
+         * 
+         * @exception SeriStruct::schema_mismatch if the patch was written for another layout
+         * @exception SeriStruct::not_enough_data if \p patch ends part way through the patch
+         * @exception SeriStruct::invalid_size if an entry names an unknown field or has the wrong size
+         */
+        size_t apply_patch(const uint64_t fingerprint, const FieldInfo *fields, const size_t field_count, const size_t fixed_size,
+                           const size_t *vstr_offsets, const size_t vstr_count, const unsigned char *patch, const size_t size);
+
         /**
          * @brief Gets a value at a particular offset in the buffer. Note that the return value must
          * be an integral or floating point.
@@ -292,50 +655,406 @@ namespace SeriStruct
         inline const char *buffer_at_cstr(const size_t &offset) const
         {
             assert(("Buffer was not allocated", buffer));
-            assert(("Attempt to read past end of buffer", offset + alignof(char *) + sizeof(char *) <= alloc_size));
-            bool is_present = buffer_at<bool>(offset);
-            if (is_present)
-            {
-                return reinterpret_cast<const char *>(buffer + offset + alignof(char *));
-            }
-            else
-            {
-                return nullptr;
-            }
+            assert(("Attempt to read past end of buffer", offset + string_header_size + 1 <= alloc_size));
+            return string_field_cstr(buffer + offset);
         }
 
         /**
          * @brief Gets a string view at a particular offset in the buffer.
          * 
          * @param offset is the offset into the buffer
+         * @param maxlen is the maximum length allowed for the field
          * @return std::string_view is the view of the string at \p offset
          */
-        inline std::string_view buffer_at_str(const size_t &offset) const
+        inline std::string_view buffer_at_str(const size_t &offset, const size_t &maxlen) const
+        {
+            assert(("Buffer was not allocated", buffer));
+            assert(("Attempt to read past end of buffer", offset + string_header_size + maxlen + 1 <= alloc_size));
+            return string_field_str(buffer + offset, maxlen);
+        }
+
+        /**
+         * @brief Gets the text of a vstr field.
+         * 
+         * @param offset is the offset of the field's slot
+         * @return std::string_view is the view of the text, which lives in the heap after the fixed part
+         */
+        inline std::string_view buffer_at_vstr(const size_t &offset) const
         {
-            return std::basic_string_view{buffer_at_cstr(offset)};
+            assert(("Buffer was not allocated", buffer));
+            assert(("Attempt to read past end of buffer", offset + vstr_slot_size <= alloc_size));
+            const std::string_view text = vstr_field(buffer, offset);
+            assert(("Attempt to read past end of buffer", text.data() + text.size() <= reinterpret_cast<const char *>(buffer) + alloc_size));
+            return text;
         }
 
         /**
          * @brief Allocates the underlying buffer. Implementations must call this
          * at least once before attempting to assign to or read from the buffer.
+         * Records with inline storage never allocate and sizes larger than the storage are
+         * truncated to fit. An existing buffer of the same size is reused.
          * 
          * @param alloc_size is the size to allocate in bytes
+         * @param clear is whether to zero the buffer. Pass false only if every byte will be overwritten right away.
          */
-        void alloc(const size_t &alloc_size)
+        void alloc(const size_t &alloc_size, const bool clear = true)
         {
-            this->alloc_size = alloc_size;
-            if (buffer)
+            if (inline_capacity)
             {
-                delete[] buffer;
+                this->alloc_size = std::min(alloc_size, inline_capacity);
+            }
+            else if (!buffer || this->alloc_size != alloc_size)
+            {
+                if (buffer)
+                {
+                    resource->deallocate(buffer, this->alloc_size, alignof(std::max_align_t));
+                    buffer = nullptr;
+                    this->alloc_size = 0;
+                }
+                buffer = static_cast<unsigned char *>(resource->allocate(alloc_size, alignof(std::max_align_t)));
+                this->alloc_size = alloc_size;
+            }
+            if (clear)
+            {
+                std::memset(buffer, 0, this->alloc_size);
             }
-            buffer = new unsigned char[alloc_size]();
         }
 
+        /**
+         * @brief Copies size() bytes from \p buffer into the internal buffer.
+         * 
+         * @param buffer is the source buffer
+         * @param buffer_size is the size of \p buffer
+         */
+        void from_array(const unsigned char *buffer, const size_t buffer_size);
+
+        /**
+         * @brief Reads \p read_size bytes from \p istr into the internal buffer. Bytes past size() are
+         * read and discarded.
+         * 
+         * @param istr is an open stream for reading the bytes
+         * @param read_size is the numer of bytes to read from \p istr
+         * 
+         * @exception SeriStruct::not_enough_data if EOF is reached on \p istr before all data could be read
+         */
+        void from_stream(std::istream &istr, const size_t read_size);
+
     private:
+        static size_t begin_patch(const uint64_t fingerprint, std::vector<unsigned char> &patch);
+        void append_patch_entry(const size_t index, const FieldInfo &field, const size_t *vstr_offsets, const size_t vstr_count,
+                                std::vector<unsigned char> &patch) const;
+
         size_t alloc_size;
+        size_t inline_capacity;
         unsigned char *buffer;
-        void from_array(const unsigned char *buffer, const size_t buffer_size);
-        void from_stream(std::istream &istr, const size_t read_size);
+        std::pmr::memory_resource *resource;
+    };
+
+    /**
+     * @brief A Record that keeps its bytes in an aligned member array of \p N bytes rather than on the heap,
+     * so constructing, copying, or destroying it never allocates. Generated classes derive from this
+     * instead of Record when declared \c inline (see the IDL README).
+     * 
+     * Because the storage is fixed, reading a larger, forward compatible record into an InlineRecord only
+     * keeps the first \p N bytes. Moves copy the bytes instead of swapping buffers.
+     * 
+     * @tparam N is the capacity in bytes, normally the buffer_size of the derived record
+     */
+    template <size_t N>
+    class InlineRecord : public Record
+    {
+    public:
+        /**
+         * @brief Construct a new InlineRecord object from a stream of bytes
+         * 
+         * @param istr is an open stream for reading the bytes
+         * @param read_size is the numer of bytes to read from \p istr
+         * @param expected_size is the minimum size of data this struct expects
+         * 
+         * @exception SeriStruct::invalid_size if \p read_size < \p expected_size
+         * @exception SeriStruct::not_enough_data if EOF is reached on \p istr before all data could be read
+         */
+        InlineRecord(std::istream &istr, const size_t read_size, const size_t expected_size) : Record{storage, N}
+        {
+            if (read_size < expected_size)
+            {
+                throw invalid_size{};
+            }
+            alloc(read_size, false);
+            from_stream(istr, read_size);
+        }
+
+        /**
+         * @brief Construct a new InlineRecord object by copying from \p buffer.
+         * 
+         * @param buffer is a buffer of bytes that matches the underling struct (such as from copy_to())
+         * @param buffer_size is the size of \p buffer
+         * @param expected_size is the minimum size of data this struct expects
+         * 
+         * @exception SeriStruct::invalid_size if \p buffer_size < \p expected_size
+         */
+        InlineRecord(const unsigned char *buffer, const size_t buffer_size, const size_t expected_size) : Record{storage, N}
+        {
+            if (buffer_size < expected_size)
+            {
+                throw invalid_size{};
+            }
+            alloc(buffer_size, false);
+            from_array(buffer, buffer_size);
+        }
+
+        /**
+         * @brief Construct a new InlineRecord object by copying \p other.
+         * 
+         * @param other 
+         */
+        InlineRecord(const InlineRecord &other) noexcept : Record{storage, N}
+        {
+            Record::operator=(other);
+        }
+
+        /**
+         * @brief Construct a new InlineRecord object by copying the bytes of \p other, which remains valid.
+         * 
+         * @param other 
+         */
+        InlineRecord(InlineRecord &&other) noexcept : Record{storage, N}
+        {
+            Record::operator=(other);
+        }
+
+        /**
+         * @brief Copy assignment operator
+         * 
+         * @param other 
+         * @return InlineRecord& 
+         */
+        InlineRecord &operator=(const InlineRecord &other) noexcept
+        {
+            Record::operator=(other);
+            return *this;
+        }
+
+        /**
+         * @brief Move assignment operator (copies the bytes of \p other)
+         * 
+         * @param other 
+         * @return InlineRecord& 
+         */
+        InlineRecord &operator=(InlineRecord &&other) noexcept
+        {
+            Record::operator=(other);
+            return *this;
+        }
+
+        /**
+         * @brief Destroy the InlineRecord object
+         */
+        ~InlineRecord() noexcept {}
+
+    protected:
+        /**
+         * @brief Construct a new InlineRecord object
+         * 
+         */
+        InlineRecord() noexcept : Record{storage, N} {}
+
+    private:
+        alignas(alignof(std::max_align_t)) unsigned char storage[N];
     };
 
+    /**
+     * @brief A read-only, non-owning view of a Record's bytes in a caller-owned buffer (such as one
+     * filled by copy_to() or received from a transport). The size of the buffer is checked once at
+     * construction, after which getters read directly from the buffer without allocating. The buffer
+     * need not be aligned: values are copied out and strings are viewed in place.
+     * Classes that derive from RecordView should implement getters using RecordView::buffer_at().
+     * 
+     * The buffer must outlive the view.
+     */
+    class RecordView
+    {
+    public:
+        /**
+         * @brief Construct a new RecordView object over \p buffer.
+         * 
+         * @param buffer is a buffer of bytes that matches the underlying struct (such as from copy_to())
+         * @param buffer_size is the size of \p buffer
+         * @param expected_size is the minimum size of data this struct expects
+         * 
+         * @exception SeriStruct::invalid_size if \p buffer_size < \p expected_size
+         */
+        RecordView(const unsigned char *buffer, const size_t buffer_size, const size_t expected_size)
+            : view_size{buffer_size}, buffer{buffer}
+        {
+            if (buffer_size < expected_size)
+            {
+                throw invalid_size{};
+            }
+        }
+
+        /**
+         * @brief Returns the size of the viewed buffer.
+         * 
+         * @return size_t 
+         */
+        inline size_t size() const { return view_size; };
+
+        /**
+         * @brief Returns a pointer to the viewed buffer.
+         * 
+         * @return const unsigned char* 
+         */
+        inline const unsigned char *data() const { return buffer; };
+
+        /**
+         * @brief Writes the viewed bytes to \p ostr.
+         * 
+         * @param ostr is a std::ostream ready for writing
+         */
+        void write(std::ostream &ostr) const;
+
+        friend std::ostream &operator<<(std::ostream &, const RecordView &);
+
+        /**
+         * @brief Copies the viewed bytes to \p buffer.
+         * 
+         * @param buffer is the destination buffer. Make sure at least size() bytes are available.
+         */
+        void copy_to(unsigned char *buffer) const;
+
+    protected:
+        /**
+         * @brief Gets a copy of the value at a particular offset in the buffer. Viewed records may be
+         * packed back to back (as in a RecordArray or a mapped file), so the value is copied out
+         * rather than referenced where it may be misaligned.
+         * 
+         * @tparam T is the type of the return value
+         * @param offset is the offset into the buffer
+         * @return T the value found at \p offset
+         */
+        template <typename T>
+        inline T buffer_at(const size_t &offset) const
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Views read trivially copyable values");
+            assert(("Attempt to read past end of buffer", offset + sizeof(T) <= view_size));
+            T value;
+            std::memcpy(&value, buffer + offset, sizeof(T));
+            return value;
+        }
+
+        /**
+         * @brief Gets a C string at a particular offset in the buffer.
+         * 
+         * @param offset is the offset into the buffer
+         * @return const char* the C string at \p offset. May be nullptr.
+         */
+        inline const char *buffer_at_cstr(const size_t &offset) const
+        {
+            assert(("Attempt to read past end of buffer", offset + string_header_size + 1 <= view_size));
+            return string_field_cstr(buffer + offset);
+        }
+
+        /**
+         * @brief Gets a string view at a particular offset in the buffer.
+         * 
+         * @param offset is the offset into the buffer
+         * @param maxlen is the maximum length allowed for the field
+         * @return std::string_view is the view of the string at \p offset
+         */
+        inline std::string_view buffer_at_str(const size_t &offset, const size_t &maxlen) const
+        {
+            assert(("Attempt to read past end of buffer", offset + string_header_size + maxlen + 1 <= view_size));
+            return string_field_str(buffer + offset, maxlen);
+        }
+
+        /**
+         * @brief Gets the text of a vstr field.
+         * 
+         * @param offset is the offset of the field's slot
+         * @return std::string_view is the view of the text, which lives in the heap after the fixed part
+         */
+        inline std::string_view buffer_at_vstr(const size_t &offset) const
+        {
+            assert(("Attempt to read past end of buffer", offset + vstr_slot_size <= view_size));
+            const std::string_view text = vstr_field(buffer, offset);
+            assert(("Attempt to read past end of buffer", text.data() + text.size() <= reinterpret_cast<const char *>(buffer) + view_size));
+            return text;
+        }
+
+    private:
+        size_t view_size;
+        const unsigned char *buffer;
+    };
+
+    /**
+     * @brief Returns true if \p a and \p b hold the same bytes. Generated records keep their bytes
+     * canonical, so this is true exactly when every field holds the same value. Floating point fields
+     * are compared by their bits: -0.0 differs from 0.0, and a NaN equals a NaN with the same bits.
+     * Generated operator== calls it.
+     * 
+     * @tparam R is a SeriStruct::Record or SeriStruct::RecordView type
+     * @param a is a record
+     * @param b is a record
+     * @return bool
+     */
+    template <typename R>
+    inline bool equal_bytes(const R &a, const R &b)
+    {
+        return a.size() == b.size() && (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+    }
+
+    /**
+     * @brief Writes a sequence of records (or record views) to \p ostr back to back, exactly as if
+     * write() had been called on each in turn. Records are gathered into large chunks so the stream
+     * sees a few big writes instead of one per record.
+     * 
+     * @tparam Iterator is an input iterator over SeriStruct::Record or SeriStruct::RecordView objects
+     * @param ostr is a std::ostream ready for writing
+     * @param first is the first record to write
+     * @param last is one past the last record to write
+     */
+    template <typename Iterator>
+    void write_many(std::ostream &ostr, Iterator first, Iterator last)
+    {
+        constexpr size_t chunk_size = 64 * 1024;
+        std::unique_ptr<unsigned char[]> chunk{new unsigned char[chunk_size]};
+        size_t chunk_used = 0;
+        for (; first != last; ++first)
+        {
+            const auto &record = *first;
+            if (chunk_used + record.size() > chunk_size)
+            {
+                ostr.write(reinterpret_cast<const char *>(chunk.get()), chunk_used);
+                chunk_used = 0;
+            }
+            if (record.size() > chunk_size)
+            {
+                record.write(ostr);
+            }
+            else
+            {
+                record.copy_to(chunk.get() + chunk_used);
+                chunk_used += record.size();
+            }
+        }
+        if (chunk_used)
+        {
+            ostr.write(reinterpret_cast<const char *>(chunk.get()), chunk_used);
+        }
+    }
+
+    /**
+     * @brief Writes every record (or record view) in \p records to \p ostr back to back.
+     * 
+     * @tparam Range is a container of SeriStruct::Record or SeriStruct::RecordView objects
+     * @param ostr is a std::ostream ready for writing
+     * @param records are the records to write
+     */
+    template <typename Range>
+    void write_many(std::ostream &ostr, const Range &records)
+    {
+        write_many(ostr, std::begin(records), std::end(records));
+    }
+
 } // namespace SeriStruct
\ No newline at end of file
@@ -0,0 +1,121 @@
+/**
+ * @file tests_array.cpp
+ * @brief Tests for contiguous batches of Records. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ * 
+ */
+#include "SeriStruct.hpp"
+#include "RecordArray.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "GenRecordThree.gen.hpp"
+#include "GenRecordTwo.gen.hpp"
+#include "InlineGenRecord.gen.hpp"
+#include <algorithm>
+#include <sstream>
+
+using namespace Catch::literals;
+using SeriStruct::RecordArray;
+
+TEST_CASE("Record array stores records back to back", "[recordarray]")
+{
+    RecordArray<GenRecordOne> records;
+    REQUIRE(records.empty());
+
+    GenRecordOne record{5, -1, 'a', true, 99999.99999, -1.5f};
+    records.push_back(record);
+    records.push_back(record.view());
+    auto view = records.emplace_back(1997, -1883, '-', false, -999.99, 1.0f);
+    REQUIRE(view.uint_field() == 1997);
+
+    REQUIRE(records.size() == 3);
+    REQUIRE(records.size_bytes() == 3 * GenRecordOne::buffer_size);
+    REQUIRE(records[0].data() == records.data());
+    REQUIRE(records[1].data() == records.data() + GenRecordOne::buffer_size);
+    REQUIRE(std::memcmp(records[1].data(), record.data(), record.size()) == 0);
+
+    REQUIRE(records[0].uint_field() == 5);
+    REQUIRE(records[1].dbl_field() == 99999.99999_a);
+    REQUIRE(records[2].int_field() == -1883);
+    REQUIRE(records.back().float_field() == 1.0_a);
+    REQUIRE_THROWS_AS(records.at(3), std::out_of_range);
+
+    GenRecordOne copy = records.get(2);
+    REQUIRE(copy.char_field() == '-');
+    REQUIRE(copy.size() == GenRecordOne::buffer_size);
+}
+
+TEST_CASE("Record array of inline records", "[recordarray][inline]")
+{
+    RecordArray<InlineGenRecord> records;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        records.emplace_back(i, -static_cast<int32_t>(i), 'x', false, i * 2.0, 0.0f);
+    }
+    REQUIRE(records.size() == 10);
+    REQUIRE(records[9].dbl_field() == 18.0_a);
+}
+
+TEST_CASE("Record array iterators", "[recordarray]")
+{
+    RecordArray<GenRecordOne> records;
+    records.reserve(100);
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        records.emplace_back(i, 0, 'x', false, 0.0, 0.0f);
+    }
+
+    uint32_t expected = 0;
+    for (auto view : records)
+    {
+        REQUIRE(view.uint_field() == expected++);
+    }
+    REQUIRE(records.end() - records.begin() == 100);
+    REQUIRE(records.begin()[42].uint_field() == 42);
+
+    auto found = std::find_if(records.begin(), records.end(), [](const GenRecordOne::View &view) { return view.uint_field() == 77; });
+    REQUIRE(found - records.begin() == 77);
+}
+
+TEST_CASE("Record array bulk copy and write", "[recordarray][stream][buffer]")
+{
+    RecordArray<GenRecordOne> records;
+    std::stringstream expected;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        auto view = records.emplace_back(i, -static_cast<int32_t>(i), 'a', true, i * 0.5, 0.0f);
+        view.write(expected);
+    }
+
+    std::stringstream s;
+    s << records;
+    REQUIRE(s.str() == expected.str());
+
+    auto buffer = new unsigned char[records.size_bytes()];
+    records.copy_to(buffer);
+    RecordArray<GenRecordOne> records2{buffer, records.size_bytes()};
+    REQUIRE(records2.size() == 1000);
+    REQUIRE(records2[999].uint_field() == 999);
+    REQUIRE_THROWS_AS(RecordArray<GenRecordOne>(buffer, records.size_bytes() - 1), SeriStruct::invalid_size);
+    delete[] buffer;
+
+    s.seekg(0);
+    RecordArray<GenRecordOne> records3;
+    records3.read(s, 600);
+    records3.read(s, 400);
+    REQUIRE(records3.size() == 1000);
+    REQUIRE(records3[700].dbl_field() == 350.0_a);
+    REQUIRE_THROWS_AS(records3.read(s, 1), SeriStruct::not_enough_data);
+    REQUIRE(records3.size() == 1000);
+}
+
+TEST_CASE("Record array keeps only known fields of forward compatible records", "[recordarray][generated]")
+{
+    GenRecordThree record{1, -1, 'b', true, 0xdead, 0xbeef};
+    GenRecordTwo record2{record.data(), record.size()};
+
+    RecordArray<GenRecordTwo> records;
+    records.push_back(record2);
+    REQUIRE(records.size_bytes() == GenRecordTwo::buffer_size);
+    REQUIRE(records[0].uint_field() == 1);
+}
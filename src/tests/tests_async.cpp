@@ -0,0 +1,129 @@
+/**
+ * @file tests_async.cpp
+ * @brief Tests for asynchronous batch reads and writes. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "AsyncIo.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using namespace Catch::literals;
+using SeriStruct::AsyncFile;
+using SeriStruct::AsyncIo;
+using SeriStruct::AsyncRecordFile;
+using SeriStruct::RecordArray;
+
+namespace
+{
+    constexpr uint32_t batch_size = 100;
+    constexpr uint32_t batch_count = 12;
+
+    GenRecordOne make_record(const uint32_t i)
+    {
+        return GenRecordOne{i, -static_cast<int32_t>(i), 'a', i % 2 == 0, i * 0.5, 1.5f};
+    }
+
+    // Writes batch_count batches with several in flight, then reads them back in a different order
+    void write_and_read(const AsyncIo::Backend backend)
+    {
+        const std::string path = "tests_async.bin";
+        AsyncIo::Options options;
+        options.queue_depth = 4;
+        options.backend = backend;
+        AsyncIo io{options};
+
+        {
+            std::vector<RecordArray<GenRecordOne>> batches(batch_count);
+            AsyncRecordFile<GenRecordOne> file{path, AsyncFile::Mode::write, io};
+            size_t written = 0;
+            for (uint32_t b = 0; b < batch_count; b++)
+            {
+                for (uint32_t i = 0; i < batch_size; i++)
+                {
+                    batches[b].push_back(make_record(b * batch_size + i));
+                }
+                file.append(batches[b], b, [&written](const AsyncIo::Completion &completion) {
+                    REQUIRE(completion.result == batch_size * GenRecordOne::buffer_size);
+                    written++;
+                });
+            }
+            io.wait_all();
+            REQUIRE(written == batch_count);
+            REQUIRE(io.pending() == 0);
+            REQUIRE(file.size() == batch_size * batch_count);
+        }
+
+        {
+            AsyncRecordFile<GenRecordOne> file{path, AsyncFile::Mode::read, io};
+            std::vector<RecordArray<GenRecordOne>> batches(batch_count);
+            for (uint32_t b = 0; b < batch_count; b++)
+            {
+                const uint32_t index = batch_count - 1 - b;
+                file.read(batches[index], index * batch_size, batch_size, index);
+            }
+            // a read past the end of the file returns the records that are there
+            RecordArray<GenRecordOne> tail;
+            file.read(tail, batch_size * batch_count - 10, batch_size, batch_count);
+
+            std::vector<AsyncIo::Completion> completed;
+            while (io.pending())
+            {
+                io.poll(1, &completed);
+            }
+            REQUIRE(completed.size() == batch_count + 1);
+            for (const auto &completion : completed)
+            {
+                const size_t records = completion.tag == batch_count ? 10 : batch_size;
+                REQUIRE(completion.result == static_cast<int64_t>(records * GenRecordOne::buffer_size));
+            }
+            for (uint32_t b = 0; b < batch_count; b++)
+            {
+                REQUIRE(batches[b].size() == batch_size);
+                for (uint32_t i = 0; i < batch_size; i++)
+                {
+                    REQUIRE(batches[b][i].uint_field() == b * batch_size + i);
+                    REQUIRE(batches[b][i].dbl_field() == Approx((b * batch_size + i) * 0.5));
+                }
+            }
+            REQUIRE(tail.size() == 10);
+            REQUIRE(tail[9].uint_field() == batch_size * batch_count - 1);
+        }
+        std::remove(path.c_str());
+    }
+} // namespace
+
+TEST_CASE("Async batches round trip with the thread backend", "[async]")
+{
+    write_and_read(AsyncIo::Backend::threads);
+}
+
+TEST_CASE("Async batches round trip with the default backend", "[async]")
+{
+    AsyncIo io;
+    REQUIRE(io.backend() != AsyncIo::Backend::automatic);
+    write_and_read(AsyncIo::Backend::automatic);
+}
+
+TEST_CASE("Async requests report errors", "[async]")
+{
+    AsyncIo io;
+    REQUIRE_THROWS_AS((AsyncRecordFile<GenRecordOne>{"no/such/file.bin", AsyncFile::Mode::read, io}), std::system_error);
+
+    unsigned char buffer[16];
+    std::vector<AsyncIo::Completion> completed;
+    io.read(-1, buffer, sizeof(buffer), 0, 7);
+    io.write(-1, buffer, 0, 0, 8);
+    REQUIRE(io.wait_all(&completed) == 2);
+    REQUIRE(completed.size() == 2);
+    for (const auto &completion : completed)
+    {
+        REQUIRE(completion.result == (completion.tag == 7 ? -EBADF : 0));
+    }
+}
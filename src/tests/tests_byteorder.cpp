@@ -0,0 +1,144 @@
+/**
+ * @file tests_byteorder.cpp
+ * @brief Tests for big-endian conversion of records and batches. Every instruction set
+ * supported by the processor is checked against single record conversion.
+ *
+ */
+#include "ByteOrder.hpp"
+#include "Kernels.hpp"
+#include "catch.hpp"
+#include "ColumnRecord.gen.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Catch::literals;
+using SeriStruct::ByteOrderPlan;
+using SeriStruct::FieldInfo;
+using SeriStruct::RecordArray;
+using SeriStruct::SimdLevel;
+
+namespace
+{
+    const SimdLevel all_levels[] = {SimdLevel::scalar, SimdLevel::sse42, SimdLevel::avx2};
+
+    const FieldInfo &field(const std::string &name)
+    {
+        for (const auto &info : ColumnRecord::field_info)
+        {
+            if (name == info.name)
+            {
+                return info;
+            }
+        }
+        throw std::out_of_range{name};
+    }
+
+    uint64_t read_big_endian(const unsigned char *bytes, const size_t width)
+    {
+        uint64_t value = 0;
+        for (size_t b = 0; b < width; b++)
+        {
+            value = (value << 8) | bytes[b];
+        }
+        return value;
+    }
+
+    ColumnRecord make_record(const uint32_t i)
+    {
+        return ColumnRecord{0x0102030405060708ull + i, i * 1.25, -static_cast<int32_t>(i), "SYM" + std::to_string(i % 100),
+                            i % 3 ? std::optional<uint16_t>{static_cast<uint16_t>(i)} : std::nullopt, {{i * 0.5f, -1.0f}}};
+    }
+} // namespace
+
+TEST_CASE("Generated field info describes the layout", "[byteorder]")
+{
+    REQUIRE(std::size(ColumnRecord::field_info) == 6);
+    REQUIRE(field("id").offset == 0);
+    REQUIRE(field("id").width == 8);
+    REQUIRE(field("quantity").width == 4);
+    REQUIRE(field("symbol").width == 1);
+    REQUIRE(field("flags").width == 2);
+    REQUIRE(field("ranges").width == 4);
+    REQUIRE(field("ranges").count == 2);
+    REQUIRE(field("ranges").offset + 8 == ColumnRecord::buffer_size);
+}
+
+TEST_CASE("Single records convert to and from big-endian", "[byteorder]")
+{
+    const ColumnRecord record = make_record(43);
+    unsigned char wire[ColumnRecord::buffer_size];
+    SeriStruct::to_big_endian(record, wire);
+
+    REQUIRE(read_big_endian(wire + field("id").offset, 8) == record.id());
+    REQUIRE(static_cast<int32_t>(read_big_endian(wire + field("quantity").offset, 4)) == -43);
+    REQUIRE(read_big_endian(wire + field("flags").offset, 2) == 43);
+    const uint32_t half = static_cast<uint32_t>(read_big_endian(wire + field("ranges").offset, 4));
+    float value;
+    std::memcpy(&value, &half, sizeof(value));
+    REQUIRE(value == 21.5_a);
+    REQUIRE(std::memcmp(wire + field("symbol").offset, record.data() + field("symbol").offset, field("symbol").count) == 0);
+
+    const ColumnRecord back = SeriStruct::from_big_endian<ColumnRecord>(wire, sizeof(wire));
+    REQUIRE(std::memcmp(back.data(), record.data(), ColumnRecord::buffer_size) == 0);
+    REQUIRE(back.symbol() == "SYM43");
+    REQUIRE_THROWS_AS(SeriStruct::from_big_endian<ColumnRecord>(wire, sizeof(wire) - 1), SeriStruct::invalid_size);
+}
+
+TEST_CASE("Batches convert to and from big-endian with every instruction set", "[byteorder]")
+{
+    RecordArray<ColumnRecord> original;
+    std::vector<unsigned char> expected(257 * ColumnRecord::buffer_size);
+    for (uint32_t i = 0; i < 257; i++)
+    {
+        const ColumnRecord record = make_record(i);
+        original.push_back(record);
+        SeriStruct::to_big_endian(record, expected.data() + i * ColumnRecord::buffer_size);
+    }
+
+    for (const auto level : all_levels)
+    {
+        SeriStruct::set_simd_level(level);
+        for (const size_t count : {size_t{1}, size_t{2}, size_t{7}, size_t{257}})
+        {
+            RecordArray<ColumnRecord> batch;
+            for (size_t i = 0; i < count; i++)
+            {
+                batch.push_back(original[i]);
+            }
+            SeriStruct::to_big_endian(batch);
+            REQUIRE(std::memcmp(batch.data(), expected.data(), batch.size_bytes()) == 0);
+            SeriStruct::from_big_endian(batch);
+            REQUIRE(std::memcmp(batch.data(), original.data(), batch.size_bytes()) == 0);
+        }
+    }
+    SeriStruct::set_simd_level(SimdLevel::avx2);
+}
+
+TEST_CASE("Byte order plans handle unaligned values and reject bad layouts", "[byteorder]")
+{
+    // a value that straddles a 16 byte boundary cannot be shuffled, so the scalar path is used
+    const FieldInfo fields[] = {{"a", 0, 2, 3}, {"b", 14, 4, 1}};
+    const ByteOrderPlan plan{fields, 20};
+    for (const auto level : all_levels)
+    {
+        SeriStruct::set_simd_level(level);
+        unsigned char bytes[40];
+        for (unsigned char i = 0; i < 40; i++)
+        {
+            bytes[i] = i;
+        }
+        plan.swap(bytes, 2);
+        REQUIRE(bytes[0] == 1);
+        REQUIRE(bytes[5] == 4);
+        REQUIRE(bytes[6] == 6);
+        REQUIRE(bytes[14] == 17);
+        REQUIRE(bytes[17] == 14);
+        REQUIRE(bytes[34] == 37);
+        REQUIRE(bytes[39] == 39);
+    }
+    SeriStruct::set_simd_level(SimdLevel::avx2);
+
+    const FieldInfo too_long[] = {{"a", 16, 8, 1}};
+    REQUIRE_THROWS_AS((ByteOrderPlan{too_long, 20}), SeriStruct::invalid_size);
+}
@@ -0,0 +1,108 @@
+/**
+ * @file tests_columns.cpp
+ * @brief Tests for generated struct-of-arrays batches. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "RecordArray.hpp"
+#include "RecordColumns.hpp"
+#include "catch.hpp"
+#include "ColumnRecord.gen.hpp"
+#include <cstdint>
+#include <numeric>
+
+using namespace Catch::literals;
+using SeriStruct::Column;
+using SeriStruct::RecordArray;
+
+namespace
+{
+    RecordArray<ColumnRecord> make_rows(const size_t count)
+    {
+        RecordArray<ColumnRecord> rows;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::optional<uint16_t> flags;
+            if (i % 2)
+            {
+                flags = static_cast<uint16_t>(i);
+            }
+            rows.emplace_back(i, i * 0.5, -static_cast<int32_t>(i), "SYM" + std::to_string(i), flags,
+                              std::array<float, 2>{static_cast<float>(i), -1.0f});
+        }
+        return rows;
+    }
+} // namespace
+
+TEST_CASE("Column stores aligned values", "[columns]")
+{
+    Column<double> column;
+    REQUIRE(column.empty());
+    for (int i = 0; i < 100; i++)
+    {
+        column.push_back(i * 1.5);
+    }
+    REQUIRE(column.size() == 100);
+    REQUIRE(reinterpret_cast<uintptr_t>(column.data()) % Column<double>::alignment == 0);
+    REQUIRE(column[99] == 148.5_a);
+    REQUIRE(std::accumulate(column.begin(), column.end(), 0.0) == 7425.0_a);
+
+    Column<double> copy{column};
+    column.clear();
+    REQUIRE(column.empty());
+    REQUIRE(copy.size() == 100);
+    REQUIRE(copy[1] == 1.5_a);
+
+    copy.resize(102);
+    REQUIRE(copy[101] == 0.0_a);
+}
+
+TEST_CASE("Columns from records", "[columns]")
+{
+    ColumnRecordColumns columns;
+    ColumnRecord record{42, 99.25, 7, "ABC", std::nullopt, {1.0f, 2.0f}};
+    columns.push_back(record);
+    columns.push_back(record.view());
+    REQUIRE(columns.size() == 2);
+
+    REQUIRE(columns.id()[1] == 42);
+    REQUIRE(columns.price()[0] == 99.25_a);
+    REQUIRE(columns.quantity()[0] == 7);
+    REQUIRE(columns.symbol(1) == "ABC");
+    REQUIRE_FALSE(columns.flags()[0].has_value());
+    REQUIRE(columns.ranges()[1][1] == 2.0_a);
+
+    // mutable fields have writable columns
+    columns.quantity()[1] = 8;
+    REQUIRE(columns.row(1).quantity() == 8);
+    REQUIRE(columns.row(0).quantity() == 7);
+}
+
+TEST_CASE("Columns round trip through row layout", "[columns][recordarray]")
+{
+    auto rows = make_rows(1000);
+    ColumnRecordColumns columns{rows};
+    REQUIRE(columns.size() == rows.size());
+
+    double total = 0.0;
+    for (double price : columns.price())
+    {
+        total += price;
+    }
+    REQUIRE(total == 249750.0_a);
+    REQUIRE(columns.flags()[3].value() == 3);
+    REQUIRE(columns.symbol(999) == "SYM999");
+
+    RecordArray<ColumnRecord> back;
+    columns.to_rows(back);
+    REQUIRE(back.size_bytes() == rows.size_bytes());
+    REQUIRE(std::memcmp(back.data(), rows.data(), rows.size_bytes()) == 0);
+
+    auto record = columns.row(10);
+    REQUIRE(std::memcmp(record.data(), rows[10].data(), ColumnRecord::buffer_size) == 0);
+    REQUIRE(record.symbol() == "SYM10");
+
+    columns.clear();
+    REQUIRE(columns.empty());
+}
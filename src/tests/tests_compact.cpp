@@ -0,0 +1,102 @@
+/**
+ * @file tests_compact.cpp
+ * @brief Tests for the compact encoding of records with string fields. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "CompactEncoding.hpp"
+#include "catch.hpp"
+#include "CStringRecord.gen.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Catch::literals;
+using namespace std::string_literals;
+using SeriStruct::RecordArray;
+
+TEST_CASE("Compact encoding keeps only the text of strings", "[compact]")
+{
+    const StringRecord record{true, "hello", "a somewhat longer string"s, 1.5f};
+    std::vector<unsigned char> bytes;
+    SeriStruct::encode_compact(record, bytes);
+    REQUIRE(bytes.size() < StringRecord::buffer_size / 10);
+    REQUIRE(bytes.size() <= SeriStruct::compact_layout<StringRecord>().max_encoded_size());
+
+    size_t consumed = 0;
+    const StringRecord decoded = SeriStruct::decode_compact<StringRecord>(bytes.data(), bytes.size(), consumed);
+    REQUIRE(consumed == bytes.size());
+    REQUIRE(decoded.bool_field());
+    REQUIRE(decoded.str_field_1() == "hello"s);
+    REQUIRE(decoded.str_field_2() == "a somewhat longer string"s);
+    REQUIRE(decoded.float_field() == 1.5_a);
+    REQUIRE(std::memcmp(decoded.data(), record.data(), StringRecord::buffer_size) == 0);
+
+    // a record without strings encodes to its full size
+    REQUIRE(SeriStruct::compact_layout<GenRecordOne>().max_encoded_size() == GenRecordOne::buffer_size);
+
+    const CStringRecord cstrings{'c', nullptr, "text", -4};
+    bytes.clear();
+    SeriStruct::encode_compact(cstrings, bytes);
+    const CStringRecord decoded_cstrings = SeriStruct::decode_compact<CStringRecord>(bytes.data(), bytes.size(), consumed);
+    REQUIRE(decoded_cstrings.cstr_field_1() == nullptr);
+    REQUIRE(std::strcmp(decoded_cstrings.cstr_field_2(), "text") == 0);
+    REQUIRE(decoded_cstrings.int_field() == -4);
+}
+
+TEST_CASE("Compact encoding round trips batches through buffers and streams", "[compact]")
+{
+    RecordArray<StringRecord> batch;
+    for (int i = 0; i < 20; i++)
+    {
+        batch.push_back(StringRecord{i % 2 == 0, std::to_string(i), std::string(static_cast<size_t>(i) * 3, 'x'), i * 0.5f});
+    }
+
+    std::vector<unsigned char> bytes;
+    SeriStruct::encode_compact(batch, bytes);
+    RecordArray<StringRecord> decoded;
+    REQUIRE(SeriStruct::decode_compact(bytes.data(), bytes.size(), batch.size(), decoded) == bytes.size());
+    REQUIRE(decoded.size() == batch.size());
+
+    std::stringstream stream;
+    SeriStruct::write_compact(stream, batch);
+    REQUIRE(stream.str().size() == bytes.size());
+    RecordArray<StringRecord> read;
+    SeriStruct::read_compact(stream, batch.size(), read);
+
+    for (size_t i = 0; i < batch.size(); i++)
+    {
+        REQUIRE(std::memcmp(decoded[i].data(), batch[i].data(), StringRecord::buffer_size) == 0);
+        REQUIRE(std::memcmp(read[i].data(), batch[i].data(), StringRecord::buffer_size) == 0);
+    }
+    REQUIRE(read[7].str_field_1() == "7"s);
+    REQUIRE(read[7].str_field_2().size() == 21);
+}
+
+TEST_CASE("Compact decoding rejects truncated and oversized input", "[compact]")
+{
+    RecordArray<StringRecord> batch;
+    batch.push_back(StringRecord{true, "hello", "world"s, 2.0f});
+    std::vector<unsigned char> bytes;
+    SeriStruct::encode_compact(batch, bytes);
+
+    RecordArray<StringRecord> records;
+    REQUIRE_THROWS_AS(SeriStruct::decode_compact(bytes.data(), bytes.size() - 1, 1, records), SeriStruct::not_enough_data);
+    REQUIRE_THROWS_AS(SeriStruct::decode_compact(bytes.data(), bytes.size(), 2, records), SeriStruct::not_enough_data);
+    REQUIRE(records.empty());
+
+    std::stringstream truncated{std::string{bytes.begin(), bytes.end() - 1}};
+    REQUIRE_THROWS_AS(SeriStruct::read_compact(truncated, 1, records), SeriStruct::not_enough_data);
+    REQUIRE(records.empty());
+
+    // claim a length for str_field_1 beyond its capacity
+    const size_t header = StringRecord::field_info[1].offset;
+    bytes[header + 1] = 0xff;
+    REQUIRE_THROWS_AS(SeriStruct::decode_compact(bytes.data(), bytes.size(), 1, records), SeriStruct::invalid_size);
+    std::stringstream oversized{std::string{bytes.begin(), bytes.end()}};
+    REQUIRE_THROWS_AS(SeriStruct::read_compact(oversized, 1, records), SeriStruct::invalid_size);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file tests_diff.cpp
+ * @brief Tests for field level record comparison. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "Kernels.hpp"
+#include "RecordDiff.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace std::string_literals;
+using SeriStruct::RecordArray;
+using SeriStruct::SimdLevel;
+
+namespace
+{
+    const SimdLevel all_levels[] = {SimdLevel::scalar, SimdLevel::sse42, SimdLevel::avx2};
+} // namespace
+
+TEST_CASE("Diffs name the fields that changed", "[diff]")
+{
+    for (const auto level : all_levels)
+    {
+        SeriStruct::set_simd_level(level);
+        const GenRecordOne a{1, -1, 'a', true, 1.5, 2.5f};
+        REQUIRE(SeriStruct::diff(a, a).empty());
+
+        const GenRecordOne b{1, -2, 'a', true, 1.5, 3.5f};
+        REQUIRE(SeriStruct::diff(a, b) == std::vector<size_t>{1, 5});
+        REQUIRE(SeriStruct::diff<GenRecordOne>(a.view(), b.view()) == std::vector<size_t>{1, 5});
+
+        const StringRecord s1{true, "same", std::string(600, 'x'), 1.0f};
+        std::string changed(600, 'x');
+        changed[590] = 'y';
+        const StringRecord s2{true, "same", changed, 1.0f};
+        const StringRecord s3{false, "same", std::string(600, 'x'), 1.0f};
+        REQUIRE(SeriStruct::diff(s1, s2) == std::vector<size_t>{2});
+        REQUIRE(SeriStruct::diff(s1, s3) == std::vector<size_t>{0});
+        REQUIRE(SeriStruct::diff_plan<StringRecord>().equal(s1.data(), s1.data()));
+    }
+    SeriStruct::set_simd_level(SimdLevel::avx2);
+}
+
+TEST_CASE("Diffs ignore padding", "[diff]")
+{
+    const GenRecordOne a{7, 8, 'c', false, 9.0, 10.0f};
+    std::array<unsigned char, GenRecordOne::buffer_size> bytes;
+    a.copy_to(bytes.data());
+    // the bytes between bool_field and dbl_field are padding
+    const size_t padding = GenRecordOne::field_info[3].offset + 1;
+    std::memset(bytes.data() + padding, 0xAB, GenRecordOne::field_info[4].offset - padding);
+    for (const auto level : all_levels)
+    {
+        SeriStruct::set_simd_level(level);
+        REQUIRE(SeriStruct::diff<GenRecordOne>(a.view(), GenRecordOne::View{bytes.data(), bytes.size()}).empty());
+    }
+    SeriStruct::set_simd_level(SimdLevel::avx2);
+}
+
+TEST_CASE("Bulk diffs find the rows that changed", "[diff]")
+{
+    RecordArray<GenRecordOne> before;
+    RecordArray<GenRecordOne> after;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        before.push_back(GenRecordOne{i, 0, 'x', false, i * 1.0, 0.0f});
+        after.push_back(GenRecordOne{i, 0, 'x', i % 97 == 3, i * 1.0, i == 999 ? 1.0f : 0.0f});
+    }
+    std::vector<size_t> expected;
+    for (size_t i = 3; i < 1000; i += 97)
+    {
+        expected.push_back(i);
+    }
+    expected.push_back(999);
+
+    for (const auto level : all_levels)
+    {
+        SeriStruct::set_simd_level(level);
+        REQUIRE(SeriStruct::diff_rows(before, after) == expected);
+        REQUIRE(SeriStruct::diff_rows(before, before).empty());
+    }
+    SeriStruct::set_simd_level(SimdLevel::avx2);
+
+    after.resize(999);
+    REQUIRE_THROWS_AS(SeriStruct::diff_rows(before, after), SeriStruct::invalid_size);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file tests_external.cpp
+ * @brief Tests for sorting record streams larger than memory. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "ExternalSort.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+using SeriStruct::ExternalSortOptions;
+using SeriStruct::RecordArray;
+
+namespace
+{
+    RecordArray<GenRecordOne> random_records(const size_t count)
+    {
+        std::mt19937 random{7};
+        std::uniform_int_distribution<int32_t> ints{-50, 50};
+        RecordArray<GenRecordOne> records;
+        records.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const int32_t value = ints(random);
+            records.emplace_back(static_cast<uint32_t>(i), value, 'e', false, value * 0.5, 0.0f);
+        }
+        return records;
+    }
+
+    std::string bytes_of(const RecordArray<GenRecordOne> &records)
+    {
+        std::ostringstream ostr;
+        ostr << records;
+        return ostr.str();
+    }
+} // namespace
+
+TEST_CASE("External sort merges spilled runs", "[external]")
+{
+    const auto records = random_records(20000);
+    auto expected = records;
+    SeriStruct::radix_sort(expected, "dbl_field");
+
+    ExternalSortOptions options;
+    options.prefix = "tests_external";
+    // 18 runs merged through buffers of a few records each
+    options.run_size = 1111 * GenRecordOne::buffer_size;
+    options.buffer_size = 7 * GenRecordOne::buffer_size + 5;
+    options.threads = 2;
+
+    std::istringstream input{bytes_of(records)};
+    std::ostringstream output;
+    REQUIRE(SeriStruct::external_sort<GenRecordOne>(input, output, "dbl_field", options) == records.size());
+    // stable, so the same bytes as sorting in memory
+    REQUIRE(output.str() == bytes_of(expected));
+    // runs are removed
+    REQUIRE_FALSE(std::ifstream{"./tests_external-0000000000.run"}.is_open());
+}
+
+TEST_CASE("External sort keeps small inputs in memory", "[external]")
+{
+    const auto records = random_records(500);
+    auto expected = records;
+    SeriStruct::radix_sort(expected, "int_field");
+
+    ExternalSortOptions options;
+    options.prefix = "tests_external_small";
+    std::istringstream input{bytes_of(records)};
+    std::ostringstream output;
+    REQUIRE(SeriStruct::external_sort<GenRecordOne>(input, output, "int_field", options) == 500);
+    REQUIRE(output.str() == bytes_of(expected));
+    REQUIRE_FALSE(std::ifstream{"./tests_external_small-0000000000.run"}.is_open());
+
+    // exactly one full run
+    options.run_size = 500 * GenRecordOne::buffer_size;
+    std::istringstream exact{bytes_of(records)};
+    std::ostringstream exact_output;
+    REQUIRE(SeriStruct::external_sort<GenRecordOne>(exact, exact_output, "int_field", options) == 500);
+    REQUIRE(exact_output.str() == bytes_of(expected));
+
+    std::istringstream empty;
+    std::ostringstream empty_output;
+    REQUIRE(SeriStruct::external_sort<GenRecordOne>(empty, empty_output, "int_field", options) == 0);
+    REQUIRE(empty_output.str().empty());
+}
+
+TEST_CASE("External sort rejects partial records", "[external]")
+{
+    const std::string bytes = bytes_of(random_records(10));
+    std::istringstream input{bytes.substr(0, bytes.size() - 3)};
+    std::ostringstream output;
+    REQUIRE_THROWS_AS(SeriStruct::external_sort<GenRecordOne>(input, output, "uint_field"), SeriStruct::not_enough_data);
+
+    // truncated after several runs have been spilled
+    const std::string many = bytes_of(random_records(5000));
+    ExternalSortOptions options;
+    options.prefix = "tests_external_partial";
+    options.run_size = 1000 * GenRecordOne::buffer_size;
+    std::istringstream truncated{many.substr(0, many.size() - 3)};
+    REQUIRE_THROWS_AS(SeriStruct::external_sort<GenRecordOne>(truncated, output, "uint_field", options), SeriStruct::not_enough_data);
+    REQUIRE_FALSE(std::ifstream{"./tests_external_partial-0000000000.run"}.is_open());
+
+    options.run_size = GenRecordOne::buffer_size - 1;
+    std::istringstream valid{bytes};
+    REQUIRE_THROWS_AS(SeriStruct::external_sort<GenRecordOne>(valid, output, "uint_field", options), SeriStruct::invalid_size);
+}
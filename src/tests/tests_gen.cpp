@@ -11,6 +11,7 @@
 #include "GenRecordThree.gen.hpp"
 #include <iterator>
 #include <sstream>
+#include <vector>
 
 using namespace Catch::literals;
 using Catch::WithinRel;
@@ -233,4 +234,40 @@ TEST_CASE("Buffer copy forward compatible records", "[generated][buffer]")
     REQUIRE(record.uint_field_3() == record3.uint_field_3());
 
     delete[] buffer, buffer2;
+}
+
+TEST_CASE("Write many generated records", "[generated][stream]")
+{
+    std::vector<GenRecordOne> records;
+    std::stringstream expected;
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        records.emplace_back(i, -static_cast<int32_t>(i), 'a', i % 2 == 0, i * 0.5, i * 0.25f);
+        records.back().write(expected);
+    }
+
+    std::stringstream s;
+    SeriStruct::write_many(s, records);
+    s.sync();
+
+    REQUIRE(static_cast<size_t>(s.tellp()) == records.size() * G1_EXPECTED_BUFFER_SIZE);
+    REQUIRE(s.str() == expected.str());
+
+    s.seekg(0);
+    for (uint32_t i = 0; i < 5000; i++)
+    {
+        GenRecordOne record{s, G1_EXPECTED_BUFFER_SIZE};
+        REQUIRE(record.uint_field() == i);
+        REQUIRE(record.dbl_field() == Approx(i * 0.5));
+    }
+
+    // views can be written the same way
+    std::vector<GenRecordOne::View> views;
+    for (auto &record : records)
+    {
+        views.push_back(record.view());
+    }
+    std::stringstream s2;
+    SeriStruct::write_many(s2, views.begin(), views.end());
+    REQUIRE(s2.str() == expected.str());
 }
\ No newline at end of file
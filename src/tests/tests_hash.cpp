@@ -0,0 +1,58 @@
+/**
+ * @file tests_hash.cpp
+ * @brief Tests for canonical record bytes and record hashing. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "RecordHash.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "OptionalRecord.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include "TrackedRecord.gen.hpp"
+#include <cstring>
+#include <functional>
+#include <string>
+
+using namespace std::string_literals;
+
+TEST_CASE("Hashes match the reference XXH64", "[hash]")
+{
+    REQUIRE(SeriStruct::hash_bytes("", 0) == 0xEF46DB3751D8E999ull);
+    REQUIRE(SeriStruct::hash_bytes("a", 1) == 0xD24EC4F1A98C6E5Bull);
+    REQUIRE(SeriStruct::hash_bytes("abc", 3) == 0x44BC2CF5AD770999ull);
+    const std::string long_input = "Nobody inspects the spammish repetition";
+    REQUIRE(SeriStruct::hash_bytes(long_input.data(), long_input.size()) == 0xFBCEA83C8A378BF1ull);
+    REQUIRE(SeriStruct::hash_bytes("abc", 3, 1) != SeriStruct::hash_bytes("abc", 3));
+}
+
+TEST_CASE("Equal records have equal bytes", "[hash]")
+{
+    TrackedRecord changed{1, {0.0, 0.0, 0.0}, 0xBEEF, "a much longer label"s, "", 2};
+    changed.status(std::nullopt);
+    changed.label("short"s);
+    const TrackedRecord fresh{1, {0.0, 0.0, 0.0}, std::nullopt, "short"s, "", 2};
+    REQUIRE(changed.size() == fresh.size());
+    REQUIRE(std::memcmp(changed.data(), fresh.data(), fresh.size()) == 0);
+    REQUIRE(SeriStruct::record_hash(changed) == SeriStruct::record_hash(fresh));
+
+    const OptionalRecord a{'x', std::nullopt};
+    const OptionalRecord b{'x', std::optional<uint32_t>{}};
+    REQUIRE(std::memcmp(a.data(), b.data(), OptionalRecord::buffer_size) == 0);
+}
+
+TEST_CASE("Records hash with std::hash", "[hash]")
+{
+    const GenRecordOne a{1, 2, 'c', true, 4.0, 5.0f};
+    const GenRecordOne b{1, 2, 'c', true, 4.0, 5.0f};
+    const GenRecordOne c{1, 2, 'c', false, 4.0, 5.0f};
+    const std::hash<GenRecordOne> hasher;
+    REQUIRE(hasher(a) == hasher(b));
+    REQUIRE(hasher(a) != hasher(c));
+    REQUIRE(std::hash<GenRecordOne::View>{}(a.view()) == hasher(a));
+
+    const StringRecord s1{true, "key", std::string(500, 'v'), 1.0f};
+    const StringRecord s2{true, "key", std::string(500, 'w'), 1.0f};
+    REQUIRE(std::hash<StringRecord>{}(s1) != std::hash<StringRecord>{}(s2));
+}
@@ -0,0 +1,204 @@
+/**
+ * @file tests_index.cpp
+ * @brief Tests for hash indexes over record files. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "HashIndex.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "GenRecordTwo.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+using SeriStruct::HashIndex;
+using SeriStruct::MappedRecordFile;
+using SeriStruct::RecordArray;
+
+namespace
+{
+    // Overwrites the bytes at offset in the file at path with value
+    template <typename V>
+    void patch_file(const char *path, const size_t offset, const V &value)
+    {
+        std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    // Writes count GenRecordOne records to path. Every int_field value is shared by 3 records.
+    void write_records(const char *path, const size_t count)
+    {
+        RecordArray<GenRecordOne> records;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            records.emplace_back(i * 7, static_cast<int32_t>(i / 3) - 1000, 'h', false, i * -0.5, 0.25f);
+        }
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out << records;
+    }
+} // namespace
+
+TEST_CASE("Hash index finds records by a numeric key", "[index]")
+{
+    const char *records_path = "tests_index_records.bin";
+    const char *index_path = "tests_index_records.idx";
+    write_records(records_path, 60000);
+    {
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        const unsigned threads = GENERATE(1u, 3u);
+
+        HashIndex<GenRecordOne>::build(records, "uint_field", index_path, threads);
+        {
+            const HashIndex<GenRecordOne> index{records, index_path};
+            REQUIRE(index.index_file().header().slot_count == 131072);
+            for (uint32_t i = 0; i < records.size(); i += 37)
+            {
+                REQUIRE(index.find(i * 7) == std::optional<size_t>{i});
+            }
+            REQUIRE(index.find(records.back().uint_field()) == std::optional<size_t>{records.size() - 1});
+            REQUIRE_FALSE(index.find(8));
+            REQUIRE_FALSE(index.find(-7));
+            REQUIRE_FALSE(index.find(uint64_t{1} << 40));
+            REQUIRE_THROWS_AS(index.find(7.0), std::invalid_argument);
+            REQUIRE_THROWS_AS(index.find("7"), std::invalid_argument);
+        }
+
+        HashIndex<GenRecordOne>::build(records, "int_field", index_path, threads);
+        {
+            const HashIndex<GenRecordOne> index{records, index_path};
+            REQUIRE(index.find_all(-1000) == std::vector<size_t>{0, 1, 2});
+            REQUIRE(index.find_all(int8_t{5}) == std::vector<size_t>{3015, 3016, 3017});
+            REQUIRE(index.find(-1000) == std::optional<size_t>{0});
+            REQUIRE(index.find_all(1000000).empty());
+        }
+
+        HashIndex<GenRecordOne>::build(records, "dbl_field", index_path, threads);
+        {
+            const HashIndex<GenRecordOne> index{records, index_path};
+            REQUIRE(index.find(-0.0) == std::optional<size_t>{0});
+            REQUIRE(index.find(0.0) == std::optional<size_t>{0});
+            REQUIRE(index.find(-1.5) == std::optional<size_t>{3});
+            REQUIRE(index.find(-2) == std::optional<size_t>{4});
+            REQUIRE_FALSE(index.find(1.5));
+        }
+    }
+    std::remove(records_path);
+    std::remove(index_path);
+}
+
+TEST_CASE("Hash index finds records by a string key", "[index]")
+{
+    const char *records_path = "tests_index_strings.bin";
+    const char *index_path = "tests_index_strings.idx";
+    {
+        RecordArray<StringRecord> records;
+        for (int i = 0; i < 1000; i++)
+        {
+            records.emplace_back(true, "key " + std::to_string(i % 500), std::string(), static_cast<float>(i));
+        }
+        std::ofstream out{records_path, std::ios::binary | std::ios::trunc};
+        out << records;
+    }
+    {
+        const MappedRecordFile<StringRecord> records{records_path};
+        HashIndex<StringRecord>::build(records, "str_field_1", index_path);
+        const HashIndex<StringRecord> index{records, index_path};
+        REQUIRE(index.find_all("key 42") == std::vector<size_t>{42, 542});
+        REQUIRE(index.find(std::string{"key 499"}) == std::optional<size_t>{499});
+        REQUIRE_FALSE(index.find("key 500"));
+        REQUIRE_FALSE(index.find(""));
+        REQUIRE_THROWS_AS(index.find(42), std::invalid_argument);
+
+        REQUIRE_THROWS_AS(HashIndex<StringRecord>::build(records, "missing", index_path), std::invalid_argument);
+    }
+    std::remove(records_path);
+    std::remove(index_path);
+}
+
+TEST_CASE("Hash index rejects other files", "[index]")
+{
+    const char *records_path = "tests_index_stale.bin";
+    const char *index_path = "tests_index_stale.idx";
+    write_records(records_path, 100);
+    {
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        HashIndex<GenRecordOne>::build(records, "uint_field", index_path);
+    }
+    {
+        // the records file grew since the index was built
+        write_records(records_path, 101);
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        REQUIRE_THROWS_AS((HashIndex<GenRecordOne>{records, index_path}), SeriStruct::invalid_size);
+        REQUIRE_THROWS_AS((HashIndex<GenRecordOne>{records, records_path}), SeriStruct::invalid_size);
+
+        std::ofstream out{records_path, std::ios::binary | std::ios::trunc};
+        out << GenRecordTwo{1, 2, 'c', true};
+    }
+    {
+        const MappedRecordFile<GenRecordTwo> records{records_path};
+        REQUIRE_THROWS_AS((HashIndex<GenRecordTwo>{records, index_path}), SeriStruct::schema_mismatch);
+    }
+    std::remove(records_path);
+    std::remove(index_path);
+}
+
+TEST_CASE("Hash index rejects damaged files", "[index]")
+{
+    using SeriStruct::HashIndexHeader;
+    using SeriStruct::HashIndexSlot;
+    const char *records_path = "tests_index_damaged.bin";
+    const char *index_path = "tests_index_damaged.idx";
+    write_records(records_path, 100);
+    {
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        const auto rebuild = [&] { HashIndex<GenRecordOne>::build(records, "int_field", index_path); };
+
+        // a key width no field can have
+        rebuild();
+        patch_file(index_path, offsetof(HashIndexHeader, key_width), uint64_t{0});
+        REQUIRE_THROWS_AS((HashIndex<GenRecordOne>{records, index_path}), SeriStruct::invalid_size);
+
+        // a valid key, but not the field at that offset
+        rebuild();
+        patch_file(index_path, offsetof(HashIndexHeader, key_kind), static_cast<uint8_t>(SeriStruct::ValueKind::floating));
+        REQUIRE_THROWS_AS((HashIndex<GenRecordOne>{records, index_path}), SeriStruct::invalid_size);
+
+        // a slot holding an ordinal past the last record
+        rebuild();
+        {
+            const HashIndex<GenRecordOne> index{records, index_path};
+            const uint64_t slot_count = index.index_file().header().slot_count;
+            for (uint64_t slot = 0; slot < slot_count; slot++)
+            {
+                patch_file(index_path, HashIndexHeader::size + slot * sizeof(HashIndexSlot) + offsetof(HashIndexSlot, ordinal), uint64_t{101});
+            }
+        }
+        {
+            const HashIndex<GenRecordOne> index{records, index_path};
+            REQUIRE_THROWS_AS(index.find(-1000), SeriStruct::invalid_size);
+        }
+
+        // a table with no empty slot is probed once through
+        rebuild();
+        {
+            const HashIndex<GenRecordOne> index{records, index_path};
+            const uint64_t slot_count = index.index_file().header().slot_count;
+            for (uint64_t slot = 0; slot < slot_count; slot++)
+            {
+                patch_file(index_path, HashIndexHeader::size + slot * sizeof(HashIndexSlot), HashIndexSlot{0, 1});
+            }
+        }
+        {
+            const HashIndex<GenRecordOne> index{records, index_path};
+            REQUIRE(index.find_all(-1000).empty());
+        }
+    }
+    std::remove(records_path);
+    std::remove(index_path);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file tests_inline.cpp
+ * @brief Tests for Records with inline (non-heap) storage. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ * 
+ */
+#include "SeriStruct.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "GenRecordThree.gen.hpp"
+#include "InlineGenRecord.gen.hpp"
+#include <sstream>
+#include <vector>
+
+using namespace Catch::literals;
+
+// Used in tests below, should be expected InlineGenRecord.buffer_size
+#define INLINE_EXPECTED_BUFFER_SIZE 28UL
+
+static bool is_stored_inline(const InlineGenRecord &record)
+{
+    auto begin = reinterpret_cast<const unsigned char *>(&record);
+    return record.data() >= begin && record.data() + record.size() <= begin + sizeof(record);
+}
+
+TEST_CASE("Inline record stores its bytes in the object", "[inline]")
+{
+    InlineGenRecord record{5, -1, 'a', true, 99999.99999, -1.5f};
+
+    REQUIRE(record.uint_field() == 5);
+    REQUIRE(record.int_field() == -1);
+    REQUIRE(record.char_field() == 'a');
+    REQUIRE(record.bool_field());
+    REQUIRE(record.dbl_field() == 99999.99999_a);
+    REQUIRE(record.float_field() == -1.5_a);
+
+    REQUIRE(record.size() == INLINE_EXPECTED_BUFFER_SIZE);
+    REQUIRE(is_stored_inline(record));
+}
+
+TEST_CASE("Inline record has the same layout as a heap record", "[inline][buffer]")
+{
+    GenRecordOne record{5, -1, 'a', true, 99999.99999, -1.5f};
+    InlineGenRecord record2{5, -1, 'a', true, 99999.99999, -1.5f};
+
+    REQUIRE(record.size() == record2.size());
+    REQUIRE(std::memcmp(record.data(), record2.data(), record.size()) == 0);
+
+    InlineGenRecord record3{record.data(), record.size()};
+    REQUIRE(record3.dbl_field() == 99999.99999_a);
+    REQUIRE(is_stored_inline(record3));
+}
+
+TEST_CASE("Inline record copy and move", "[inline]")
+{
+    InlineGenRecord record{5, -1, 'a', true, 99999.99999, -1.5f};
+    InlineGenRecord record2{record};
+
+    REQUIRE(is_stored_inline(record2));
+    REQUIRE(record2.uint_field() == 5);
+    REQUIRE(record2.float_field() == -1.5_a);
+
+    record2.float_field(2.5f);
+    REQUIRE(record.float_field() == -1.5_a);
+
+    InlineGenRecord record3{std::move(record2)};
+    REQUIRE(is_stored_inline(record3));
+    REQUIRE(record3.float_field() == 2.5_a);
+
+    record3 = record;
+    REQUIRE(is_stored_inline(record3));
+    REQUIRE(record3.float_field() == -1.5_a);
+
+    InlineGenRecord record4{1997, -1883, '-', false, -999.99f, 1.0f};
+    record4 = std::move(record3);
+    REQUIRE(is_stored_inline(record4));
+    REQUIRE(record4.uint_field() == 5);
+}
+
+TEST_CASE("Inline records in a vector", "[inline]")
+{
+    std::vector<InlineGenRecord> records;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        records.emplace_back(i, -static_cast<int32_t>(i), 'x', i % 2 == 0, i * 1.5, 0.0f);
+    }
+
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        REQUIRE(is_stored_inline(records[i]));
+        REQUIRE(records[i].uint_field() == i);
+        REQUIRE(records[i].int_field() == -static_cast<int32_t>(i));
+    }
+}
+
+TEST_CASE("Inline record read from a larger forward compatible stream", "[inline][stream]")
+{
+    std::stringstream s;
+    GenRecordThree record{1, -1, 'b', true, 0xdead, 0xbeef};
+    GenRecordOne record2{5, -1, 'a', true, 99999.99999, -1.5f};
+    s << record2 << record;
+    s.sync();
+    s.seekg(0);
+
+    // fixed storage can only hold buffer_size bytes, the rest of the record is skipped
+    InlineGenRecord record3{s, record2.size() + 4};
+    REQUIRE(record3.size() == INLINE_EXPECTED_BUFFER_SIZE);
+    REQUIRE(record3.uint_field() == 5);
+    REQUIRE(static_cast<size_t>(s.tellg()) == record2.size() + 4);
+}
+
+TEST_CASE("Inline record read with insufficent data throws exception", "[inline][stream]")
+{
+    std::stringstream s;
+    GenRecordOne record{5, -1, 'a', true, 99999.99999, -1.5f};
+    s << record;
+    s.sync();
+    s.seekg(0);
+
+    REQUIRE_THROWS_AS(InlineGenRecord(s, record.size() + 4), SeriStruct::not_enough_data);
+}
@@ -0,0 +1,236 @@
+/**
+ * @file tests_kernels.cpp
+ * @brief Tests for the vectorized filter and aggregate kernels. Every instruction set
+ * supported by the processor is checked against plain loops.
+ *
+ */
+#include "Kernels.hpp"
+#include "catch.hpp"
+#include "ColumnRecord.gen.hpp"
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Catch::literals;
+using SeriStruct::Aggregate;
+using SeriStruct::Compare;
+using SeriStruct::SelectionBitmap;
+using SeriStruct::SimdLevel;
+
+namespace
+{
+    const SimdLevel all_levels[] = {SimdLevel::scalar, SimdLevel::sse42, SimdLevel::avx2};
+    const Compare all_compares[] = {Compare::equal, Compare::not_equal, Compare::less,
+                                    Compare::less_equal, Compare::greater, Compare::greater_equal};
+
+    template <typename T>
+    bool expected(const T value, const Compare op, const T operand)
+    {
+        switch (op)
+        {
+        case Compare::equal:
+            return value == operand;
+        case Compare::not_equal:
+            return value != operand;
+        case Compare::less:
+            return value < operand;
+        case Compare::less_equal:
+            return value <= operand;
+        case Compare::greater:
+            return value > operand;
+        default:
+            return value >= operand;
+        }
+    }
+
+    template <typename T>
+    std::vector<T> make_values(const size_t count)
+    {
+        std::mt19937_64 random{42};
+        std::vector<T> values(count);
+        for (auto &value : values)
+        {
+            // a narrow range so equal comparisons match, spread across the sign bit
+            if constexpr (std::is_floating_point_v<T>)
+                value = static_cast<T>(static_cast<int>(random() % 41) - 20) / 4;
+            else if constexpr (std::is_signed_v<T>)
+                value = static_cast<T>(static_cast<int>(random() % 41) - 20);
+            else
+                value = static_cast<T>(std::numeric_limits<T>::max() / 2 - 20 + random() % 41);
+        }
+        // extremes
+        values[3] = std::numeric_limits<T>::max();
+        values[4] = std::numeric_limits<T>::lowest();
+        return values;
+    }
+
+    // Returns true if every filter matches a plain loop on every instruction set
+    template <typename T>
+    bool check_filters()
+    {
+        // not a multiple of any vector width, and read from an unaligned start
+        const auto storage = make_values<T>(1000 + 37 + 1);
+        const T *values = storage.data() + 1;
+        const size_t count = storage.size() - 1;
+        const T operand = values[10];
+        const T low = values[11] < values[12] ? values[11] : values[12];
+        const T high = values[11] < values[12] ? values[12] : values[11];
+
+        bool ok = true;
+        for (auto level : all_levels)
+        {
+            SeriStruct::set_simd_level(level);
+            SelectionBitmap selection;
+            for (auto op : all_compares)
+            {
+                SeriStruct::filter(values, count, op, operand, selection);
+                ok = ok && selection.size() == count;
+                for (size_t i = 0; i < count; i++)
+                {
+                    ok = ok && selection.test(i) == expected(values[i], op, operand);
+                }
+            }
+            SeriStruct::filter_range(values, count, low, high, selection);
+            for (size_t i = 0; i < count; i++)
+            {
+                ok = ok && selection.test(i) == (values[i] >= low && values[i] <= high);
+            }
+            ok = ok && (selection.words()[count / 64] >> (count % 64)) == 0;
+        }
+        SeriStruct::set_simd_level(SimdLevel::avx2);
+        return ok;
+    }
+
+    // Returns true if aggregates match a plain loop on every instruction set
+    template <typename T>
+    bool check_aggregates()
+    {
+        auto values = make_values<T>(1000 + 37);
+        if constexpr (std::is_floating_point_v<T> || std::is_same_v<T, int64_t>)
+        {
+            // keep sums exact and free of overflow
+            values[3] = values[4] = 0;
+        }
+        SelectionBitmap selection;
+        SeriStruct::filter(values.data(), values.size(), Compare::greater, values[20], selection);
+
+        typename Aggregate<T>::sum_type sum = 0, selected_sum = 0;
+        T min = values[0], max = values[0];
+        size_t selected_count = 0;
+        for (size_t i = 0; i < values.size(); i++)
+        {
+            sum += values[i];
+            min = std::min(min, values[i]);
+            max = std::max(max, values[i]);
+            if (selection.test(i))
+            {
+                selected_sum += values[i];
+                selected_count++;
+            }
+        }
+
+        bool ok = true;
+        for (auto level : all_levels)
+        {
+            SeriStruct::set_simd_level(level);
+            const auto all = SeriStruct::aggregate(values.data(), values.size());
+            const auto selected = SeriStruct::aggregate(values.data(), selection);
+            ok = ok && all.min == min && all.max == max && all.count == values.size();
+            ok = ok && selected.count == selected_count && selected.min > values[20];
+            ok = ok && all.sum == sum && selected.sum == selected_sum;
+        }
+        SeriStruct::set_simd_level(SimdLevel::avx2);
+        return ok;
+    }
+} // namespace
+
+TEST_CASE("Filters match scalar comparisons", "[kernels]")
+{
+    REQUIRE(check_filters<int8_t>());
+    REQUIRE(check_filters<int16_t>());
+    REQUIRE(check_filters<int32_t>());
+    REQUIRE(check_filters<int64_t>());
+    REQUIRE(check_filters<uint8_t>());
+    REQUIRE(check_filters<uint16_t>());
+    REQUIRE(check_filters<uint32_t>());
+    REQUIRE(check_filters<uint64_t>());
+    REQUIRE(check_filters<float>());
+    REQUIRE(check_filters<double>());
+}
+
+TEST_CASE("Aggregates match scalar loops", "[kernels]")
+{
+    REQUIRE(check_aggregates<int8_t>());
+    REQUIRE(check_aggregates<int16_t>());
+    REQUIRE(check_aggregates<int32_t>());
+    REQUIRE(check_aggregates<int64_t>());
+    REQUIRE(check_aggregates<uint8_t>());
+    REQUIRE(check_aggregates<uint16_t>());
+    REQUIRE(check_aggregates<uint32_t>());
+    REQUIRE(check_aggregates<uint64_t>());
+    REQUIRE(check_aggregates<float>());
+    REQUIRE(check_aggregates<double>());
+}
+
+TEST_CASE("Float filters treat NaN like the scalar operators", "[kernels]")
+{
+    std::vector<float> values(100, 1.0f);
+    values[7] = std::nanf("");
+    for (auto level : all_levels)
+    {
+        SeriStruct::set_simd_level(level);
+        SelectionBitmap selection;
+        SeriStruct::filter(values.data(), values.size(), Compare::not_equal, 1.0f, selection);
+        REQUIRE(selection.count() == 1);
+        SeriStruct::filter(values.data(), values.size(), Compare::less_equal, 1.0f, selection);
+        REQUIRE(selection.count() == 99);
+        auto result = SeriStruct::aggregate(values.data(), values.size());
+        REQUIRE(result.min == 1.0f);
+        REQUIRE(result.max == 1.0f);
+        REQUIRE(std::isnan(result.sum));
+    }
+    SeriStruct::set_simd_level(SimdLevel::avx2);
+}
+
+TEST_CASE("Selection bitmaps combine and compact to indices", "[kernels]")
+{
+    SelectionBitmap all{130, true};
+    REQUIRE(all.count() == 130);
+    REQUIRE(all.word_count() == 3);
+
+    SelectionBitmap some{130};
+    some.set(0);
+    some.set(64);
+    some.set(129);
+    REQUIRE(some.indices() == std::vector<size_t>{0, 64, 129});
+
+    all &= some;
+    REQUIRE(all.count() == 3);
+    all.flip();
+    REQUIRE(all.count() == 127);
+    REQUIRE_FALSE(all.test(64));
+    all |= some;
+    REQUIRE(all.count() == 130);
+}
+
+TEST_CASE("Kernels over generated columns", "[kernels][columns]")
+{
+    ColumnRecordColumns columns;
+    for (int i = 0; i < 500; i++)
+    {
+        columns.push_back(ColumnRecord{static_cast<uint64_t>(i), i * 0.5, i % 10, "X", std::nullopt, {0.0f, 0.0f}});
+    }
+
+    auto cheap = SeriStruct::filter(columns.price(), Compare::less, 100.0);
+    REQUIRE(cheap.count() == 200);
+    auto mid = SeriStruct::filter_range(columns.quantity(), 3, 4);
+    REQUIRE(mid.count() == 100);
+
+    cheap &= mid;
+    auto total = SeriStruct::aggregate(columns.price(), cheap);
+    REQUIRE(total.count == 40);
+    REQUIRE(total.min == 1.5_a);
+    REQUIRE(total.max == 97.0_a);
+    REQUIRE(cheap.indices().front() == 3);
+    REQUIRE(SeriStruct::aggregate(columns.id()).sum == 124750);
+}
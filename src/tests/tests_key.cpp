@@ -0,0 +1,106 @@
+/**
+ * @file tests_key.cpp
+ * @brief Tests for generated equality and key ordering. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include "VarStringRecord.gen.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using namespace std::string_literals;
+
+TEST_CASE("Records compare equal when every field is equal", "[key]")
+{
+    const GenRecordOne a{1, 2, 'c', true, 4.0, 5.0f};
+    const GenRecordOne b{1, 2, 'c', true, 4.0, 5.0f};
+    const GenRecordOne c{1, 2, 'c', true, 4.0, 5.5f};
+    REQUIRE(a == b);
+    REQUIRE(a != c);
+    REQUIRE(a.view() == b.view());
+    REQUIRE(a.view() != c.view());
+
+    const VarStringRecord v1{1, "name", 0.0, "text"s};
+    const VarStringRecord v2{1, "name", 0.0, "text, but longer"s};
+    VarStringRecord v3{v2};
+    v3.description("text"s);
+    REQUIRE(v1 != v2);
+    REQUIRE(v1 == v3);
+
+    std::unordered_set<GenRecordOne> seen{a, b, c};
+    REQUIRE(seen.size() == 2);
+}
+
+TEST_CASE("Records order by their declared key", "[key]")
+{
+    std::vector<GenRecordOne> records;
+    records.emplace_back(2, -1, 'a', false, 0.0, 0.0f);
+    records.emplace_back(1, 5, 'b', false, 0.0, 0.0f);
+    records.emplace_back(2, -3, 'c', false, 0.0, 0.0f);
+    records.emplace_back(1, 4, 'd', false, 0.0, 0.0f);
+    std::sort(records.begin(), records.end());
+    std::string order;
+    for (const auto &record : records)
+    {
+        order += record.char_field();
+    }
+    REQUIRE(order == "dbca");
+
+    // the key ignores other fields
+    const GenRecordOne x{1, 1, 'x', true, 1.0, 1.0f};
+    const GenRecordOne y{1, 1, 'y', false, 2.0, 2.0f};
+    REQUIRE_FALSE(x < y);
+    REQUIRE_FALSE(y < x);
+    REQUIRE(GenRecordOne::key_order::compare(x.data(), y.data()) == 0);
+    REQUIRE(GenRecordOne::key_less{}(x.view(), GenRecordOne{2, 0, 'z', false, 0.0, 0.0f}));
+}
+
+TEST_CASE("String keys order like std::string_view", "[key]")
+{
+    const StringRecord apple{true, "apple", ""s, 2.0f};
+    const StringRecord apple_early{true, "apple", ""s, 1.0f};
+    const StringRecord banana{true, "banana", ""s, 0.0f};
+    REQUIRE(apple_early < apple);
+    REQUIRE(apple < banana);
+    REQUIRE(apple.view() < banana.view());
+
+    const VarStringRecord a{9, "alpha", 0.0, ""s};
+    const VarStringRecord b{1, "beta", 0.0, ""s};
+    const VarStringRecord b2{2, "beta", 0.0, ""s};
+    REQUIRE(a < b);
+    REQUIRE(b < b2);
+    REQUIRE_FALSE(b2 < b);
+}
+
+TEST_CASE("Floating point keys order like the radix sort", "[key]")
+{
+    const float values[] = {std::numeric_limits<float>::quiet_NaN(), 1.0f, -0.0f, std::numeric_limits<float>::infinity(), 0.0f, -1.0f};
+    std::vector<StringRecord> records;
+    for (const float value : values)
+    {
+        records.emplace_back(true, "same", ""s, value);
+    }
+    std::sort(records.begin(), records.end());
+    REQUIRE(records[0].float_field() == -1.0f);
+    REQUIRE(std::signbit(records[1].float_field()));
+    REQUIRE(records[2].float_field() == 0.0f);
+    REQUIRE_FALSE(std::signbit(records[2].float_field()));
+    REQUIRE(records[3].float_field() == 1.0f);
+    REQUIRE(std::isinf(records[4].float_field()));
+    REQUIRE(std::isnan(records[5].float_field()));
+
+    // equality is by bits, unlike == on the values
+    REQUIRE(records[1] != records[2]);
+    const StringRecord nan{true, "same", ""s, std::numeric_limits<float>::quiet_NaN()};
+    REQUIRE(nan == records[5]);
+    REQUIRE_FALSE(nan < records[5]);
+    REQUIRE_FALSE(records[5] < nan);
+}
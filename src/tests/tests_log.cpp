@@ -0,0 +1,195 @@
+/**
+ * @file tests_log.cpp
+ * @brief Tests for the append-only record log. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "MappedRecordFile.hpp"
+#include "RecordLog.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/resource.h>
+#include <system_error>
+#include <unistd.h>
+
+using namespace Catch::literals;
+using SeriStruct::LogWriter;
+using SeriStruct::MappedRecordFile;
+using SeriStruct::RecordArray;
+using SeriStruct::RecordLogWriter;
+using SeriStruct::SegmentHeader;
+
+namespace
+{
+    // A scratch directory that is emptied and removed when done
+    struct ScratchDirectory
+    {
+        std::string path;
+
+        ScratchDirectory()
+        {
+            char name[] = "tests_log_XXXXXX";
+            path = ::mkdtemp(name);
+        }
+
+        ~ScratchDirectory()
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "/segment-%010d.log", i);
+                std::remove((path + name).c_str());
+            }
+            ::rmdir(path.c_str());
+        }
+    };
+
+    GenRecordOne make_record(const uint32_t i)
+    {
+        return GenRecordOne{i, -static_cast<int32_t>(i), 'l', true, i * 2.0, 0.5f};
+    }
+} // namespace
+
+TEST_CASE("Record log rolls segments with headers", "[log]")
+{
+    ScratchDirectory directory;
+    LogWriter::Options options;
+    options.directory = directory.path;
+    options.segment_size = SegmentHeader::size + 100 * GenRecordOne::buffer_size;
+    options.schema = 0x5eed;
+
+    {
+        RecordLogWriter<GenRecordOne> log{options};
+        RecordArray<GenRecordOne> batch;
+        for (uint32_t i = 0; i < 230; i++)
+        {
+            batch.push_back(make_record(i));
+        }
+        log.append(batch);
+        for (uint32_t i = 230; i < 250; i++)
+        {
+            auto record = make_record(i);
+            if (i % 2)
+            {
+                log.append(record);
+            }
+            else
+            {
+                log.append(record.view());
+            }
+        }
+        REQUIRE(log.record_count() == 250);
+        REQUIRE(log.segment_index() == 2);
+        log.close();
+        REQUIRE_THROWS_AS(log.append(batch.data(), 1), std::system_error);
+    }
+
+    uint32_t expected = 0;
+    for (uint64_t segment = 0; segment < 3; segment++)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/segment-%010llu.log", static_cast<unsigned long long>(segment));
+        const std::string path = directory.path + name;
+
+        auto header = SeriStruct::read_segment_header(path);
+        REQUIRE(header.schema == 0x5eed);
+        REQUIRE(header.record_size == GenRecordOne::buffer_size);
+        REQUIRE(header.segment_index == segment);
+        REQUIRE(header.first_record == segment * 100);
+        REQUIRE(header.record_count == (segment < 2 ? 100 : 50));
+
+        MappedRecordFile<GenRecordOne> file{path, SegmentHeader::size};
+        REQUIRE(file.size() == header.record_count);
+        for (auto view : file)
+        {
+            REQUIRE(view.uint_field() == expected);
+            REQUIRE(view.dbl_field() == Approx(expected * 2.0));
+            expected++;
+        }
+    }
+    REQUIRE(expected == 250);
+}
+
+TEST_CASE("Record log syncs in groups", "[log]")
+{
+    ScratchDirectory directory;
+    LogWriter::Options options;
+    options.directory = directory.path;
+    options.sync_bytes = 10 * GenRecordOne::buffer_size;
+    options.sync_interval = std::chrono::hours{1};
+
+    RecordLogWriter<GenRecordOne> log{options};
+    const std::string path = log.segment_path(0);
+    for (uint32_t i = 0; i < 25; i++)
+    {
+        log.append(make_record(i));
+    }
+    // only complete groups have been synced and counted
+    REQUIRE(SeriStruct::read_segment_header(path).record_count == 20);
+    REQUIRE(SeriStruct::read_segment_header(path).schema == GenRecordOne::fingerprint);
+    log.sync();
+    REQUIRE(SeriStruct::read_segment_header(path).record_count == 25);
+
+    // an existing log is never overwritten
+    REQUIRE_THROWS_AS(RecordLogWriter<GenRecordOne>{options}, std::system_error);
+}
+
+TEST_CASE("Record log writes each record once after a failed write", "[log]")
+{
+    ScratchDirectory directory;
+    LogWriter::Options options;
+    options.directory = directory.path;
+    options.buffer_size = 64 * GenRecordOne::buffer_size;
+    options.sync_interval = std::chrono::hours{1};
+
+    RecordLogWriter<GenRecordOne> log{options};
+    RecordArray<GenRecordOne> batch;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        batch.push_back(make_record(i));
+    }
+
+    // the file cannot grow past the middle of the 11th record, so the first block is only partly written
+    rlimit unlimited;
+    ::getrlimit(RLIMIT_FSIZE, &unlimited);
+    rlimit limited = unlimited;
+    limited.rlim_cur = SegmentHeader::size + 10 * GenRecordOne::buffer_size + GenRecordOne::buffer_size / 2;
+    const auto handler = std::signal(SIGXFSZ, SIG_IGN);
+    ::setrlimit(RLIMIT_FSIZE, &limited);
+    REQUIRE_THROWS_AS(log.append(batch), std::system_error);
+    ::setrlimit(RLIMIT_FSIZE, &unlimited);
+    std::signal(SIGXFSZ, handler);
+
+    // the records of the first block were appended, and the rest of it is written now
+    REQUIRE(log.record_count() == 64);
+    log.sync();
+    const std::string path = log.segment_path(0);
+    log.close();
+
+    MappedRecordFile<GenRecordOne> file{path, SegmentHeader::size};
+    REQUIRE(file.size() == 64);
+    for (uint32_t i = 0; i < file.size(); i++)
+    {
+        REQUIRE(file[i] == batch[i]);
+    }
+}
+
+TEST_CASE("Record log rejects bad files and options", "[log]")
+{
+    ScratchDirectory directory;
+    LogWriter::Options options;
+    options.directory = directory.path;
+    options.segment_size = SegmentHeader::size;
+    REQUIRE_THROWS_AS(RecordLogWriter<GenRecordOne>{options}, SeriStruct::invalid_size);
+
+    const std::string path = directory.path + "/segment-0000000000.log";
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+    std::fputs("not a segment", file);
+    std::fclose(file);
+    REQUIRE_THROWS_AS(SeriStruct::read_segment_header(path), SeriStruct::invalid_size);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file tests_mapped.cpp
+ * @brief Tests for memory-mapped record files. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "MappedRecordFile.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <system_error>
+
+using namespace Catch::literals;
+using SeriStruct::MappedFile;
+using SeriStruct::MappedRecordFile;
+using SeriStruct::RecordArray;
+
+namespace
+{
+    // Writes count GenRecordOne records after header to path
+    void write_file(const char *path, const size_t count, const std::string &header = "")
+    {
+        RecordArray<GenRecordOne> records;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            records.emplace_back(i, -static_cast<int32_t>(i), 'm', i % 2 == 0, i * 0.25, 1.5f);
+        }
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out << header << records;
+    }
+} // namespace
+
+TEST_CASE("Mapped record file reads records in place", "[mapped]")
+{
+    const char *path = "tests_mapped_records.bin";
+    write_file(path, 10000);
+    {
+        MappedRecordFile<GenRecordOne> file{path};
+        REQUIRE(file.size() == 10000);
+        REQUIRE_FALSE(file.empty());
+        REQUIRE(file.size_bytes() == 10000 * GenRecordOne::buffer_size);
+
+        REQUIRE(file[0].uint_field() == 0);
+        REQUIRE(file[1234].int_field() == -1234);
+        REQUIRE(file.back().dbl_field() == 2499.75_a);
+        REQUIRE(file[5000].data() == file.data() + 5000 * GenRecordOne::buffer_size);
+        REQUIRE_THROWS_AS(file.at(10000), std::out_of_range);
+
+        file.advise(MappedFile::Advice::sequential);
+        size_t even = std::count_if(file.begin(), file.end(), [](const GenRecordOne::View &view) { return view.bool_field(); });
+        REQUIRE(even == 5000);
+
+        file.advise(MappedFile::Advice::random, 100, 10);
+        GenRecordOne copy = file.get(9999);
+        REQUIRE(copy.uint_field() == 9999);
+        REQUIRE(copy.float_field() == 1.5_a);
+
+        // moving keeps the mapping alive
+        MappedRecordFile<GenRecordOne> moved{std::move(file)};
+        REQUIRE(moved[42].uint_field() == 42);
+    }
+    std::remove(path);
+}
+
+TEST_CASE("Mapped record file skips a header", "[mapped]")
+{
+    const char *path = "tests_mapped_header.bin";
+    write_file(path, 3, "HEADER");
+    {
+        MappedRecordFile<GenRecordOne> file{path, 6};
+        REQUIRE(file.size() == 3);
+        REQUIRE(file[2].uint_field() == 2);
+        REQUIRE(std::string(reinterpret_cast<const char *>(file.mapped_file().data()), 6) == "HEADER");
+
+        REQUIRE_THROWS_AS(MappedRecordFile<GenRecordOne>(path), SeriStruct::invalid_size);
+    }
+    std::remove(path);
+}
+
+TEST_CASE("Mapped record file edge cases", "[mapped]")
+{
+    REQUIRE_THROWS_AS(MappedRecordFile<GenRecordOne>("tests_mapped_missing.bin"), std::system_error);
+
+    const char *path = "tests_mapped_empty.bin";
+    write_file(path, 0);
+    {
+        MappedRecordFile<GenRecordOne> file{path};
+        REQUIRE(file.empty());
+        REQUIRE(file.begin() == file.end());
+        file.advise(MappedFile::Advice::will_need);
+    }
+    std::remove(path);
+}
@@ -47,4 +47,31 @@ TEST_CASE("Mutable C string field set to exceed max length is truncated", "[muta
 
     REQUIRE(strlen(record.cstr_field()) == 90);
     REQUIRE(strcmp("Four score and seven years ago our fathers brought forth on this continent, a new nation, ", record.cstr_field()) == 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("Shortening a mutable string field clears the old value", "[mutable][string]")
+{
+    MutableRecord record{1, 1.0f, 'a', false, "The quick brown fox jumps over the lazy dog", "Hello world, this is a long value"s};
+    record.str_field("Hi"s);
+    record.cstr_field("Dog");
+
+    REQUIRE(record.str_field() == "Hi"s);
+    REQUIRE(record.str_field().length() == 2);
+    REQUIRE(strcmp(record.cstr_field(), "Dog") == 0);
+    // no byte of the longer values remains after the new text
+    const char *text = record.cstr_field();
+    for (size_t i = 3; i <= 90; i++)
+    {
+        REQUIRE(text[i] == '\0');
+    }
+    const char *str_text = record.str_field().data();
+    for (size_t i = 2; i <= 60; i++)
+    {
+        REQUIRE(str_text[i] == '\0');
+    }
+
+    record.cstr_field(nullptr);
+    REQUIRE(record.cstr_field() == nullptr);
+    record.str_field(""s);
+    REQUIRE(record.str_field().empty());
+}
@@ -0,0 +1,111 @@
+/**
+ * @file tests_patch.cpp
+ * @brief Tests for dirty field tracking and patches. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "catch.hpp"
+#include "TrackedRecord.gen.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace Catch::literals;
+using namespace std::string_literals;
+
+namespace
+{
+    TrackedRecord make_record()
+    {
+        return TrackedRecord{9, {1.0, 2.0, 3.0}, std::nullopt, "label"s, "notes", 4};
+    }
+} // namespace
+
+TEST_CASE("Setters mark fields dirty", "[patch]")
+{
+    TrackedRecord record = make_record();
+    REQUIRE(record.dirty_fields().none());
+
+    record.count(5);
+    record.label("new label"s);
+    REQUIRE(record.dirty_fields().count() == 2);
+    REQUIRE(record.dirty_fields().test(5));
+    REQUIRE(record.dirty_fields().test(3));
+
+    const TrackedRecord copy{record};
+    REQUIRE(copy.dirty_fields() == record.dirty_fields());
+
+    record.clear_dirty();
+    REQUIRE(record.dirty_fields().none());
+
+    // a patch with nothing dirty holds only its header
+    std::vector<unsigned char> patch;
+    const size_t size = record.write_patch(patch);
+    REQUIRE(size == patch.size());
+    TrackedRecord replica = make_record();
+    REQUIRE(replica.apply_patch(patch.data(), patch.size()) == size);
+    REQUIRE(replica.count() == 4);
+}
+
+TEST_CASE("Patches bring a replica up to date", "[patch]")
+{
+    TrackedRecord primary = make_record();
+    TrackedRecord replica = make_record();
+
+    primary.position({-1.0, -2.0, -3.0});
+    primary.status(7);
+    primary.label("a longer label than before"s);
+    primary.notes("notes that grow the record past its fixed part");
+    std::vector<unsigned char> patch;
+    const size_t size = primary.write_patch(patch);
+    REQUIRE(size == patch.size());
+    REQUIRE(size < primary.size());
+
+    REQUIRE(replica.apply_patch(patch.data(), patch.size()) == size);
+    REQUIRE(replica.dirty_fields().none());
+    REQUIRE(replica.position()[2] == -3.0_a);
+    REQUIRE(replica.status() == 7);
+    REQUIRE(replica.label() == "a longer label than before"s);
+    REQUIRE(replica.notes() == "notes that grow the record past its fixed part"s);
+    REQUIRE(replica.size() == primary.size());
+    REQUIRE(std::memcmp(replica.data(), primary.data(), primary.size()) == 0);
+
+    // later patches follow on from the last one
+    primary.clear_dirty();
+    primary.count(-12);
+    primary.status(std::nullopt);
+    primary.label("x"s);
+    patch.clear();
+    primary.write_patch(patch);
+    replica.apply_patch(patch.data(), patch.size());
+    REQUIRE(replica.count() == -12);
+    REQUIRE_FALSE(replica.status().has_value());
+    REQUIRE(replica.label() == "x"s);
+    REQUIRE(replica.notes() == primary.notes());
+}
+
+TEST_CASE("Damaged patches are rejected without changing the record", "[patch]")
+{
+    TrackedRecord primary = make_record();
+    primary.count(100);
+    primary.label("changed"s);
+    std::vector<unsigned char> patch;
+    primary.write_patch(patch);
+
+    TrackedRecord replica = make_record();
+    REQUIRE_THROWS_AS(replica.apply_patch(patch.data(), patch.size() - 1), SeriStruct::not_enough_data);
+    REQUIRE_THROWS_AS(replica.apply_patch(patch.data(), 4), SeriStruct::not_enough_data);
+    REQUIRE(replica.count() == 4);
+    REQUIRE(replica.label() == "label"s);
+
+    std::vector<unsigned char> other = patch;
+    other[0] ^= 0xff;
+    REQUIRE_THROWS_AS(replica.apply_patch(other.data(), other.size()), SeriStruct::schema_mismatch);
+
+    // the first entry names a field that does not exist
+    other = patch;
+    other[12] = 200;
+    REQUIRE_THROWS_AS(replica.apply_patch(other.data(), other.size()), SeriStruct::invalid_size);
+    REQUIRE(replica.count() == 4);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file tests_pool.cpp
+ * @brief Tests for Records allocated from a RecordPool. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ * 
+ */
+#include "SeriStruct.hpp"
+#include "RecordPool.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "GenRecordThree.gen.hpp"
+#include "GenRecordTwo.gen.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Catch::literals;
+using SeriStruct::BlockPool;
+using SeriStruct::RecordPool;
+
+TEST_CASE("Records allocated from a pool reuse freed blocks", "[pool]")
+{
+    BlockPool pool{GenRecordOne::buffer_size, 4};
+
+    const unsigned char *first_buffer;
+    {
+        GenRecordOne record{5, -1, 'a', true, 99999.99999, -1.5f, &pool};
+        first_buffer = record.data();
+        REQUIRE(record.uint_field() == 5);
+        REQUIRE(record.dbl_field() == 99999.99999_a);
+    }
+    GenRecordOne record2{1997, -1883, '-', false, -999.99f, 1.0f, &pool};
+    REQUIRE(record2.data() == first_buffer);
+
+    auto stats = pool.statistics();
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.hits == 1);
+    REQUIRE(stats.slabs == 1);
+
+    // a second slab is carved once the first is used up
+    std::vector<GenRecordOne> records;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        records.emplace_back(i, 0, 'x', false, 0.0, 0.0f, &pool);
+    }
+    REQUIRE(pool.statistics().slabs == 2);
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        REQUIRE(records[i].uint_field() == i);
+    }
+}
+
+TEST_CASE("Oversized records fall back to the upstream resource", "[pool]")
+{
+    BlockPool pool{GenRecordTwo::buffer_size};
+    GenRecordThree record{1, -1, 'b', true, 0xdead, 0xbeef};
+
+    GenRecordTwo record2{record.data(), record.size(), &pool};
+    REQUIRE(record2.size() == record.size());
+    REQUIRE(record2.uint_field() == 1);
+    REQUIRE(pool.statistics().fallbacks == 1);
+}
+
+TEST_CASE("Records freed on another thread are returned to the pool", "[pool][thread]")
+{
+    BlockPool pool{GenRecordOne::buffer_size, 8};
+
+    auto record = std::make_unique<GenRecordOne>(5, -1, 'a', true, 99999.99999, -1.5f, &pool);
+    const unsigned char *buffer = record->data();
+
+    uint32_t consumed = 0;
+    std::thread consumer{[&record, &consumed]() {
+        consumed = record->uint_field();
+        record.reset();
+    }};
+    consumer.join();
+    REQUIRE(consumed == 5);
+    REQUIRE(pool.statistics().remote_frees == 1);
+
+    // drain this thread's free list until the remotely freed block comes back
+    std::vector<GenRecordOne> records;
+    bool reused = false;
+    for (int i = 0; i < 8 && !reused; i++)
+    {
+        records.emplace_back(i, 0, 'x', false, 0.0, 0.0f, &pool);
+        reused = records.back().data() == buffer;
+    }
+    REQUIRE(reused);
+    REQUIRE(pool.statistics().slabs == 1);
+}
+
+TEST_CASE("Record pool shared by many threads", "[pool][thread]")
+{
+    auto &pool = RecordPool<GenRecordOne>::instance();
+    REQUIRE(&pool == &RecordPool<GenRecordOne>::instance());
+    REQUIRE(pool.block_size() == GenRecordOne::buffer_size);
+
+    std::atomic<bool> overwritten{false};
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&pool, &overwritten, t]() {
+            std::vector<GenRecordOne> records;
+            for (uint32_t i = 0; i < 1000; i++)
+            {
+                records.emplace_back(t, static_cast<int32_t>(i), 'x', false, 0.0, 0.0f, &pool);
+            }
+            for (uint32_t i = 0; i < 1000; i++)
+            {
+                if (records[i].uint_field() != t || records[i].int_field() != static_cast<int32_t>(i))
+                {
+                    overwritten = true;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE_FALSE(overwritten);
+    auto stats = pool.statistics();
+    REQUIRE(stats.hits + stats.misses >= 4000);
+}
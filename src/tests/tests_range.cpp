@@ -0,0 +1,211 @@
+/**
+ * @file tests_range.cpp
+ * @brief Tests for B+tree range indexes over record files. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "RangeIndex.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using SeriStruct::MappedRecordFile;
+using SeriStruct::RangeIndex;
+using SeriStruct::RecordArray;
+
+namespace
+{
+    // Overwrites the bytes at offset in the file at path with value
+    template <typename V>
+    void patch_file(const char *path, const size_t offset, const V &value)
+    {
+        std::fstream file{path, std::ios::binary | std::ios::in | std::ios::out};
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+
+    // Writes count GenRecordOne records with random keys to path
+    void write_records(const char *path, const size_t count)
+    {
+        std::mt19937 random{11};
+        std::uniform_int_distribution<int32_t> ints{-20000, 20000};
+        std::uniform_real_distribution<float> reals{-100.0f, 100.0f};
+        RecordArray<GenRecordOne> records;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const int32_t value = ints(random);
+            records.emplace_back(static_cast<uint32_t>(value + 20000), value, 'r', false, value / 8.0, reals(random));
+        }
+        std::ofstream out{path, std::ios::binary | std::ios::trunc};
+        out << records;
+    }
+
+    // Ordinals of records with low <= key <= high, in order of key and then ordinal
+    template <typename Get>
+    std::vector<size_t> scan(const MappedRecordFile<GenRecordOne> &records, const double low, const double high, Get get)
+    {
+        std::vector<std::pair<double, size_t>> matches;
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            const double key = get(records[i]);
+            if (key >= low && key <= high)
+            {
+                matches.emplace_back(key, i);
+            }
+        }
+        std::sort(matches.begin(), matches.end());
+        std::vector<size_t> ordinals;
+        for (const auto &match : matches)
+        {
+            ordinals.push_back(match.second);
+        }
+        return ordinals;
+    }
+
+    std::vector<size_t> to_vector(const SeriStruct::OrdinalRange &range)
+    {
+        return std::vector<size_t>(range.begin(), range.end());
+    }
+} // namespace
+
+TEST_CASE("Range index returns the records in a key range", "[range]")
+{
+    const char *records_path = "tests_range_records.bin";
+    const char *index_path = "tests_range_records.idx";
+    write_records(records_path, 30000);
+    {
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        // 8 keys per node gives a deep tree
+        const size_t node_size = GENERATE(size_t{64}, SeriStruct::RangeIndexFile::default_node_size);
+
+        RangeIndex<GenRecordOne>::build(records, "dbl_field", index_path, node_size, 2);
+        {
+            const RangeIndex<GenRecordOne> index{records, index_path};
+            const auto dbl = [](const GenRecordOne::View &view) { return view.dbl_field(); };
+            REQUIRE(to_vector(index.range(-10.0, 25.5)) == scan(records, -10.0, 25.5, dbl));
+            REQUIRE(to_vector(index.range(-1e9, 1e9)).size() == records.size());
+            REQUIRE(to_vector(index.range(0, 0)) == scan(records, 0.0, 0.0, dbl));
+            REQUIRE(to_vector(index.equal_range(-0.0)) == scan(records, 0.0, 0.0, dbl));
+            REQUIRE(index.range(3000.0, 4000.0).empty());
+            REQUIRE(index.range(5.0, -5.0).empty());
+            REQUIRE(index.range(std::numeric_limits<double>::quiet_NaN(), 1.0).empty());
+
+            const auto range = index.range(1.0, 1.25);
+            const auto views = index.views(range);
+            REQUIRE(views.size() == range.size());
+            for (const auto &view : views)
+            {
+                REQUIRE(view.dbl_field() >= 1.0);
+                REQUIRE(view.dbl_field() <= 1.25);
+            }
+        }
+
+        RangeIndex<GenRecordOne>::build(records, "int_field", index_path, node_size);
+        {
+            const RangeIndex<GenRecordOne> index{records, index_path};
+            const auto ints = [](const GenRecordOne::View &view) { return view.int_field(); };
+            REQUIRE(to_vector(index.range(-500, 500)) == scan(records, -500, 500, ints));
+            // fractional bounds are rounded inwards
+            REQUIRE(to_vector(index.range(-499.5, 499.5)) == scan(records, -499, 499, ints));
+            REQUIRE(to_vector(index.range(-(int64_t{1} << 40), int64_t{1} << 40)).size() == records.size());
+        }
+
+        RangeIndex<GenRecordOne>::build(records, "uint_field", index_path, node_size);
+        {
+            const RangeIndex<GenRecordOne> index{records, index_path};
+            const auto uints = [](const GenRecordOne::View &view) { return view.uint_field(); };
+            REQUIRE(to_vector(index.range(-5, 100)) == scan(records, 0, 100, uints));
+            REQUIRE(index.range(-5, -1).empty());
+            REQUIRE(to_vector(index.range(39000u, std::numeric_limits<uint64_t>::max())) == scan(records, 39000, 1e20, uints));
+        }
+
+        RangeIndex<GenRecordOne>::build(records, "float_field", index_path, node_size);
+        {
+            const RangeIndex<GenRecordOne> index{records, index_path};
+            const auto floats = [](const GenRecordOne::View &view) { return view.float_field(); };
+            // bounds that no float holds exactly
+            REQUIRE(to_vector(index.range(-0.1, 0.1)) == scan(records, -0.1, 0.1, floats));
+        }
+    }
+    std::remove(records_path);
+    std::remove(index_path);
+}
+
+TEST_CASE("Range index of a sorted file gives contiguous ordinals", "[range]")
+{
+    const char *records_path = "tests_range_sorted.bin";
+    const char *index_path = "tests_range_sorted.idx";
+    {
+        RecordArray<GenRecordOne> records;
+        for (uint32_t i = 0; i < 5000; i++)
+        {
+            records.emplace_back(i / 10, 0, 's', false, 0.0, 0.0f);
+        }
+        std::ofstream out{records_path, std::ios::binary | std::ios::trunc};
+        out << records;
+    }
+    {
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        RangeIndex<GenRecordOne>::build(records, "uint_field", index_path, 128);
+        const RangeIndex<GenRecordOne> index{records, index_path};
+        const auto range = index.range(20, 29);
+        REQUIRE(range.size() == 100);
+        REQUIRE(range.key_position() == 200);
+        REQUIRE(range[0] == 200);
+        REQUIRE(range[99] == 299);
+    }
+    std::remove(records_path);
+    std::remove(index_path);
+}
+
+TEST_CASE("Range index rejects other keys and files", "[range]")
+{
+    const char *records_path = "tests_range_invalid.bin";
+    const char *index_path = "tests_range_invalid.idx";
+    write_records(records_path, 100);
+    {
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        REQUIRE_THROWS_AS(RangeIndex<GenRecordOne>::build(records, "missing", index_path), std::invalid_argument);
+        REQUIRE_THROWS_AS(RangeIndex<GenRecordOne>::build(records, "dbl_field", index_path, 100), SeriStruct::invalid_size);
+        REQUIRE_THROWS_AS(RangeIndex<GenRecordOne>::build(records, "dbl_field", index_path, 32), SeriStruct::invalid_size);
+        RangeIndex<GenRecordOne>::build(records, "dbl_field", index_path);
+        REQUIRE_THROWS_AS((RangeIndex<GenRecordOne>{records, records_path}), SeriStruct::invalid_size);
+
+        // counts and node sizes whose layout would overflow
+        using SeriStruct::RangeIndexHeader;
+        patch_file(index_path, offsetof(RangeIndexHeader, record_count), uint64_t{1} << 61);
+        REQUIRE_THROWS_AS(SeriStruct::RangeIndexFile{index_path}, SeriStruct::invalid_size);
+        RangeIndex<GenRecordOne>::build(records, "dbl_field", index_path);
+        patch_file(index_path, offsetof(RangeIndexHeader, node_size), uint64_t{1} << 63);
+        REQUIRE_THROWS_AS(SeriStruct::RangeIndexFile{index_path}, SeriStruct::invalid_size);
+        RangeIndex<GenRecordOne>::build(records, "dbl_field", index_path);
+    }
+    {
+        write_records(records_path, 99);
+        const MappedRecordFile<GenRecordOne> records{records_path};
+        REQUIRE_THROWS_AS((RangeIndex<GenRecordOne>{records, index_path}), SeriStruct::invalid_size);
+    }
+    {
+        RecordArray<StringRecord> strings;
+        strings.emplace_back(true, "a", std::string(), 1.0f);
+        std::ofstream out{records_path, std::ios::binary | std::ios::trunc};
+        out << strings;
+    }
+    {
+        const MappedRecordFile<StringRecord> records{records_path};
+        REQUIRE_THROWS_AS(RangeIndex<StringRecord>::build(records, "str_field_1", index_path), std::invalid_argument);
+        REQUIRE_THROWS_AS((RangeIndex<StringRecord>{records, index_path}), SeriStruct::schema_mismatch);
+    }
+    std::remove(records_path);
+    std::remove(index_path);
+}
@@ -0,0 +1,115 @@
+/**
+ * @file tests_resource.cpp
+ * @brief Tests for Records allocated from a std::pmr::memory_resource. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ * 
+ */
+#include "SeriStruct.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <memory_resource>
+#include <sstream>
+#include <string>
+
+using namespace Catch::literals;
+using namespace std::string_literals;
+
+/**
+ * @brief Counts allocations and deallocations passed through to the default resource.
+ */
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_outstanding = 0;
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override
+    {
+        allocations++;
+        bytes_outstanding += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override
+    {
+        deallocations++;
+        bytes_outstanding -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+TEST_CASE("Record allocated from a memory resource", "[resource]")
+{
+    CountingResource resource;
+    {
+        GenRecordOne record{5, -1, 'a', true, 99999.99999, -1.5f, &resource};
+        REQUIRE(record.get_memory_resource() == &resource);
+        REQUIRE(resource.allocations == 1);
+        REQUIRE(resource.bytes_outstanding == record.size());
+        REQUIRE(record.uint_field() == 5);
+        REQUIRE(record.float_field() == -1.5_a);
+
+        // buffers of the same size are reused on assignment
+        GenRecordOne record2{1997, -1883, '-', false, -999.99f, 1.0f, &resource};
+        record2 = record;
+        REQUIRE(resource.allocations == 2);
+        REQUIRE(record2.uint_field() == 5);
+    }
+    REQUIRE(resource.deallocations == 2);
+    REQUIRE(resource.bytes_outstanding == 0);
+}
+
+TEST_CASE("Record stream and buffer constructors use a memory resource", "[resource][stream][buffer]")
+{
+    CountingResource resource;
+    {
+        StringRecord record{true, "Hello world"s, "What's in a name?"s, -99.99f};
+
+        std::stringstream s;
+        record.write(s);
+        s.sync();
+        s.seekg(0);
+
+        StringRecord record2{s, record.size(), &resource};
+        REQUIRE(record2.str_field_2() == "What's in a name?"s);
+
+        StringRecord record3{record.data(), record.size(), &resource};
+        REQUIRE(record3.str_field_1() == "Hello world"s);
+
+        StringRecord record4{record, &resource};
+        REQUIRE(record4.float_field() == -99.99_a);
+        REQUIRE(resource.allocations == 3);
+    }
+    REQUIRE(resource.bytes_outstanding == 0);
+}
+
+TEST_CASE("Records allocated from a monotonic arena", "[resource]")
+{
+    unsigned char arena_bytes[1024];
+    std::pmr::monotonic_buffer_resource arena{arena_bytes, sizeof(arena_bytes), std::pmr::null_memory_resource()};
+
+    GenRecordOne record{5, -1, 'a', true, 99999.99999, -1.5f, &arena};
+    GenRecordOne record2{record, &arena};
+    REQUIRE(record2.dbl_field() == 99999.99999_a);
+    REQUIRE(record2.data() >= arena_bytes);
+    REQUIRE(record2.data() < arena_bytes + sizeof(arena_bytes));
+
+    // moving takes over the buffer and its resource
+    GenRecordOne record3{std::move(record)};
+    REQUIRE(record3.get_memory_resource() == &arena);
+    REQUIRE(record3.uint_field() == 5);
+
+    // moving between unequal resources copies
+    GenRecordOne record4{1997, -1883, '-', false, -999.99f, 1.0f};
+    record4 = std::move(record3);
+    REQUIRE(record4.get_memory_resource() == std::pmr::get_default_resource());
+    REQUIRE(record4.uint_field() == 5);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file tests_sort.cpp
+ * @brief Tests for radix sorting of record batches. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "RecordSort.hpp"
+#include "catch.hpp"
+#include "ArrayRecord.gen.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "OptionalRecord.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using SeriStruct::RecordArray;
+
+namespace
+{
+    RecordArray<GenRecordOne> random_records(const size_t count)
+    {
+        std::mt19937_64 random{42};
+        std::uniform_int_distribution<int32_t> ints{-1000, 1000};
+        std::uniform_real_distribution<double> reals{-1e6, 1e6};
+        RecordArray<GenRecordOne> records;
+        records.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            const int32_t value = ints(random);
+            records.emplace_back(static_cast<uint32_t>(i), value, static_cast<char>(value), value > 0,
+                                 reals(random), static_cast<float>(reals(random)));
+        }
+        return records;
+    }
+} // namespace
+
+TEST_CASE("Radix sort orders records by any numeric field", "[sort]")
+{
+    const auto original = random_records(100000);
+    const unsigned threads = GENERATE(1u, 4u);
+
+    SECTION("Signed integers")
+    {
+        auto records = original;
+        SeriStruct::radix_sort(records, "int_field", threads);
+        REQUIRE(records.size() == original.size());
+        for (size_t i = 1; i < records.size(); i++)
+        {
+            REQUIRE(records[i - 1].int_field() <= records[i].int_field());
+            // stable: records with equal keys keep their order
+            if (records[i - 1].int_field() == records[i].int_field())
+            {
+                REQUIRE(records[i - 1].uint_field() < records[i].uint_field());
+            }
+        }
+        // whole records moved together
+        for (const auto &record : records)
+        {
+            REQUIRE(original[record.uint_field()] == record);
+        }
+    }
+
+    SECTION("Floating point")
+    {
+        auto records = original;
+        SeriStruct::radix_sort(records, "dbl_field", threads);
+        REQUIRE(std::is_sorted(records.begin(), records.end(),
+                               [](const auto &a, const auto &b) { return a.dbl_field() < b.dbl_field(); }));
+        SeriStruct::radix_sort(records, "float_field", threads);
+        REQUIRE(std::is_sorted(records.begin(), records.end(),
+                               [](const auto &a, const auto &b) { return a.float_field() < b.float_field(); }));
+    }
+
+    SECTION("Unsigned and single byte keys")
+    {
+        auto records = original;
+        SeriStruct::radix_sort(records, "char_field", threads);
+        REQUIRE(std::is_sorted(records.begin(), records.end(),
+                               [](const auto &a, const auto &b) { return a.char_field() < b.char_field(); }));
+        SeriStruct::radix_sort(records, "uint_field", threads);
+        for (size_t i = 0; i < records.size(); i++)
+        {
+            REQUIRE(records[i] == original[i]);
+        }
+    }
+}
+
+TEST_CASE("Radix sort orders special floating point values", "[sort]")
+{
+    const double inf = std::numeric_limits<double>::infinity();
+    const std::vector<double> values{0.0, -inf, 2.5, -0.0, inf, -2.5, std::numeric_limits<double>::denorm_min(),
+                                     -std::numeric_limits<double>::max(), 1e-300};
+    RecordArray<GenRecordOne> records;
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        records.emplace_back(static_cast<uint32_t>(i), 0, 'a', false, values[i], 0.0f);
+    }
+    SeriStruct::radix_sort(records, "dbl_field");
+
+    std::vector<double> sorted;
+    for (const auto &record : records)
+    {
+        sorted.push_back(record.dbl_field());
+    }
+    REQUIRE(sorted == std::vector<double>{-inf, -std::numeric_limits<double>::max(), -2.5, -0.0, 0.0,
+                                          std::numeric_limits<double>::denorm_min(), 1e-300, 2.5, inf});
+    REQUIRE(std::signbit(sorted[3]));
+    REQUIRE_FALSE(std::signbit(sorted[4]));
+}
+
+TEST_CASE("Indirect radix sort orders positions", "[sort]")
+{
+    const auto records = random_records(50000);
+    const auto before = records;
+    const auto index = SeriStruct::radix_sort_index(records, "dbl_field", 3);
+
+    REQUIRE(index.size() == records.size());
+    std::vector<size_t> expected(records.size());
+    std::iota(expected.begin(), expected.end(), size_t{0});
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](const size_t a, const size_t b) { return records[a].dbl_field() < records[b].dbl_field(); });
+    REQUIRE(index == expected);
+    REQUIRE(std::memcmp(records.data(), before.data(), records.size_bytes()) == 0);
+
+    REQUIRE(SeriStruct::radix_sort_index(RecordArray<GenRecordOne>{}, "dbl_field").empty());
+}
+
+TEST_CASE("Only single numeric fields are sort keys", "[sort]")
+{
+    const auto key = SeriStruct::sort_key<GenRecordOne>("float_field");
+    REQUIRE(key.width == sizeof(float));
+    REQUIRE(key.kind == SeriStruct::ValueKind::floating);
+    REQUIRE(SeriStruct::sort_key<GenRecordOne>("int_field").kind == SeriStruct::ValueKind::signed_integer);
+
+    REQUIRE_THROWS_AS(SeriStruct::sort_key<GenRecordOne>("missing"), std::invalid_argument);
+    REQUIRE_THROWS_AS(SeriStruct::sort_key<StringRecord>("str_field_1"), std::invalid_argument);
+    REQUIRE_THROWS_AS(SeriStruct::sort_key<ArrayRecord>("first_array"), std::invalid_argument);
+    REQUIRE_THROWS_AS(SeriStruct::sort_key<OptionalRecord>("second_opt"), std::invalid_argument);
+    REQUIRE_NOTHROW(SeriStruct::sort_key<ArrayRecord>("int_field"));
+}
@@ -5,6 +5,7 @@
  */
 #include "SeriStruct.hpp"
 #include "catch.hpp"
+#include <iomanip>
 #include <iterator>
 #include <sstream>
 
@@ -126,6 +127,21 @@ TEST_CASE("Write record to output stream", "[static][stream]")
     }
 }
 
+TEST_CASE("Write record ignores stream formatting", "[static][stream]")
+{
+    TestRecord record{3, -140, 0.0f, false, true, 14999.535f, 'Z'};
+
+    std::stringstream s;
+    s << std::setw(64) << std::setfill('*') << record;
+    s.sync();
+
+    REQUIRE(s.tellp() == EXPECTED_BUFFER_SIZE);
+
+    unsigned char buffer[EXPECTED_BUFFER_SIZE];
+    record.copy_to(buffer);
+    REQUIRE(s.str() == std::string(reinterpret_cast<const char *>(buffer), EXPECTED_BUFFER_SIZE));
+}
+
 TEST_CASE("Read record from input stream", "[static][stream]")
 {
     std::stringstream s;
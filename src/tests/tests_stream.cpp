@@ -0,0 +1,220 @@
+/**
+ * @file tests_stream.cpp
+ * @brief Tests for schema fingerprints and framed streams. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "MessageStream.hpp"
+#include "RecordStream.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "GenRecordTwo.gen.hpp"
+#include "GenRecordThree.gen.hpp"
+#include "InlineGenRecord.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <cstring>
+#include <sstream>
+#include <string>
+
+using namespace Catch::literals;
+using SeriStruct::FrameHeader;
+using SeriStruct::MessageReader;
+using SeriStruct::MessageWriter;
+using SeriStruct::RecordArray;
+
+namespace
+{
+    GenRecordOne make_record(const uint32_t i)
+    {
+        return GenRecordOne{i, -static_cast<int32_t>(i), 'f', i % 2 == 1, i * 3.0, 0.25f};
+    }
+
+    // Records what it is shown, one overload per message type
+    struct Recorder
+    {
+        std::string log;
+
+        void operator()(const GenRecordOne::View &view) { log += "one:" + std::to_string(view.uint_field()) + " "; }
+        void operator()(const GenRecordTwo::View &view) { log += "two:" + std::to_string(view.uint_field()) + " "; }
+        void operator()(const StringRecord::View &view) { log += "str:" + std::string{view.str_field_1()} + " "; }
+    };
+} // namespace
+
+TEST_CASE("Fingerprints identify record layouts", "[stream]")
+{
+    // the same fields at the same offsets give the same fingerprint, whatever the record is called
+    STATIC_REQUIRE(GenRecordOne::fingerprint == InlineGenRecord::fingerprint);
+    // extending a record changes it
+    STATIC_REQUIRE(GenRecordTwo::fingerprint != GenRecordThree::fingerprint);
+    STATIC_REQUIRE(GenRecordOne::fingerprint != GenRecordTwo::fingerprint);
+}
+
+TEST_CASE("Framed streams round trip batches", "[stream]")
+{
+    std::stringstream stream;
+    RecordArray<GenRecordOne> first;
+    RecordArray<GenRecordOne> second;
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        (i < 7 ? first : second).push_back(make_record(i));
+    }
+    SeriStruct::write_frame(stream, first);
+    SeriStruct::write_frame(stream, RecordArray<GenRecordOne>{});
+    SeriStruct::write_frame(stream, second);
+    REQUIRE(stream.str().size() == 3 * FrameHeader::size + 10 * GenRecordOne::buffer_size);
+
+    FrameHeader header;
+    REQUIRE(SeriStruct::read_frame_header(stream, header));
+    REQUIRE(header.fingerprint == GenRecordOne::fingerprint);
+    REQUIRE(header.record_size == GenRecordOne::buffer_size);
+    REQUIRE(header.record_count == 7);
+    stream.seekg(0);
+
+    RecordArray<GenRecordOne> records;
+    int frames = 0;
+    while (SeriStruct::read_frame(stream, records))
+    {
+        frames++;
+    }
+    REQUIRE(frames == 3);
+    REQUIRE(records.size() == 10);
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        REQUIRE(records[i].uint_field() == i);
+        REQUIRE(records[i].dbl_field() == Approx(i * 3.0));
+    }
+
+    // records with the same layout can be read as each other
+    stream.clear();
+    stream.seekg(0);
+    RecordArray<InlineGenRecord> inline_records;
+    REQUIRE(SeriStruct::read_frame(stream, inline_records));
+    REQUIRE(inline_records.size() == 7);
+    REQUIRE(inline_records[6].uint_field() == 6);
+}
+
+TEST_CASE("Framed streams reject other schemas and damaged frames", "[stream]")
+{
+    RecordArray<GenRecordTwo> batch;
+    batch.push_back(GenRecordTwo{1, 2, 'c', true});
+
+    std::stringstream stream;
+    SeriStruct::write_frame(stream, batch);
+    RecordArray<GenRecordThree> other;
+    REQUIRE_THROWS_AS(SeriStruct::read_frame(stream, other), SeriStruct::schema_mismatch);
+
+    // truncated in the records
+    std::string bytes;
+    {
+        std::stringstream full;
+        SeriStruct::write_frame(full, batch);
+        bytes = full.str();
+    }
+    std::stringstream truncated{bytes.substr(0, bytes.size() - 1)};
+    RecordArray<GenRecordTwo> records;
+    REQUIRE_THROWS_AS(SeriStruct::read_frame(truncated, records), SeriStruct::not_enough_data);
+
+    // truncated in the header
+    std::stringstream short_header{bytes.substr(0, FrameHeader::size / 2)};
+    REQUIRE_THROWS_AS(SeriStruct::read_frame(short_header, records), SeriStruct::not_enough_data);
+
+    // not a frame
+    std::stringstream garbage{std::string(64, 'x')};
+    REQUIRE_THROWS_AS(SeriStruct::read_frame(garbage, records), SeriStruct::invalid_size);
+
+    // a count far beyond the bytes that follow is not allocated up front
+    FrameHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    header.record_count = uint64_t{1} << 40;
+    std::string huge{reinterpret_cast<const char *>(&header), sizeof(header)};
+    huge += bytes.substr(FrameHeader::size);
+    std::stringstream huge_count{huge};
+    REQUIRE_THROWS_AS(SeriStruct::read_frame(huge_count, records), SeriStruct::not_enough_data);
+    REQUIRE(records.empty());
+
+    // a count whose size overflows
+    header.record_count = ~uint64_t{0} / 2;
+    std::stringstream overflow{std::string{reinterpret_cast<const char *>(&header), sizeof(header)}};
+    REQUIRE_THROWS_AS(SeriStruct::read_frame(overflow, records), SeriStruct::invalid_size);
+}
+
+TEST_CASE("Message streams dispatch several record types", "[stream]")
+{
+    using Reader = MessageReader<GenRecordOne, GenRecordTwo, StringRecord>;
+    STATIC_REQUIRE(Reader::types::index<GenRecordTwo> == 1);
+    STATIC_REQUIRE(Reader::types::index_of(GenRecordThree::fingerprint) == Reader::types::count);
+
+    std::stringstream stream;
+    MessageWriter<GenRecordOne, GenRecordTwo, StringRecord> writer{stream};
+    writer.write(make_record(1));
+    writer.write(GenRecordTwo{2, 0, 'x', false});
+    writer.write(StringRecord{true, "hello", "world", 1.0f});
+    RecordArray<GenRecordOne> batch;
+    batch.push_back(make_record(3));
+    batch.push_back(make_record(4));
+    writer.write(batch);
+    const GenRecordOne five = make_record(5);
+    writer.write_view<GenRecordOne>(five.view());
+
+    Recorder recorder;
+    Reader reader{stream};
+    REQUIRE(reader.read_all(recorder) == 5);
+    REQUIRE(recorder.log == "one:1 two:2 str:hello one:3 one:4 one:5 ");
+
+    // zero-copy over a buffer, stopping before an incomplete frame
+    const std::string bytes = stream.str();
+    const auto data = reinterpret_cast<const unsigned char *>(bytes.data());
+    Recorder partial;
+    const size_t whole = Reader::dispatch(data, bytes.size() - 1, partial);
+    REQUIRE(partial.log == "one:1 two:2 str:hello one:3 one:4 ");
+    REQUIRE(whole == bytes.size() - FrameHeader::size - GenRecordOne::buffer_size);
+
+    // a generic visitor works too
+    size_t total = 0;
+    REQUIRE(Reader::dispatch(data, bytes.size(), [&total](const auto &view) { total += view.size(); }) == bytes.size());
+    REQUIRE(total == 4 * GenRecordOne::buffer_size + GenRecordTwo::buffer_size + StringRecord::buffer_size);
+}
+
+TEST_CASE("Message streams reject unknown record types", "[stream]")
+{
+    std::stringstream stream;
+    MessageWriter<GenRecordThree> writer{stream};
+    writer.write(GenRecordThree{1, 2, 'c', true, 3, 4});
+
+    Recorder recorder;
+    MessageReader<GenRecordOne, GenRecordTwo, StringRecord> reader{stream};
+    REQUIRE_THROWS_AS(reader.read(recorder), SeriStruct::schema_mismatch);
+}
+
+TEST_CASE("Message streams reject record counts that overflow", "[stream]")
+{
+    std::stringstream stream;
+    MessageWriter<GenRecordOne> writer{stream};
+    writer.write(make_record(1));
+    std::string bytes = stream.str();
+
+    // 28 * 2^62 records wraps to 0 bytes
+    FrameHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    header.record_count = uint64_t{1} << 62;
+    std::memcpy(&bytes[0], &header, sizeof(header));
+
+    Recorder recorder;
+    const auto data = reinterpret_cast<const unsigned char *>(bytes.data());
+    REQUIRE(MessageReader<GenRecordOne>::dispatch(data, bytes.size(), recorder) == 0);
+    REQUIRE(recorder.log.empty());
+
+    std::stringstream overflow{bytes};
+    MessageReader<GenRecordOne> reader{overflow};
+    REQUIRE_THROWS_AS(reader.read(recorder), SeriStruct::invalid_size);
+    REQUIRE(recorder.log.empty());
+
+    // a count far beyond the bytes that follow is not allocated up front
+    header.record_count = uint64_t{1} << 40;
+    std::memcpy(&bytes[0], &header, sizeof(header));
+    std::stringstream huge_count{bytes};
+    MessageReader<GenRecordOne> huge_reader{huge_count};
+    REQUIRE_THROWS_AS(huge_reader.read(recorder), SeriStruct::not_enough_data);
+    REQUIRE(recorder.log.empty());
+}
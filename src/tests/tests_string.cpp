@@ -9,6 +9,7 @@
 #include "CStringRecord.gen.hpp"
 #include "StringRecord.gen.hpp"
 #include <cstring>
+#include <memory>
 #include <sstream>
 #include <string>
 
@@ -111,4 +112,36 @@ TEST_CASE("String record copy to/from a buffer", "[string][buffer]")
     REQUIRE(record2.str_field_1() == "All your base are belong to us"s);
     REQUIRE(record2.str_field_2() == "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"s);
     REQUIRE(record2.float_field() == 1024.1_a);
-}
\ No newline at end of file
+}
+
+TEST_CASE("String fields encoded without a length are still read", "[string][buffer]")
+{
+    StringRecord record{true, "Hello world", "Goodbye", 1.0f};
+    auto buffer = std::make_unique<unsigned char[]>(record.size());
+    record.copy_to(buffer.get());
+    // clear the length of str_field_1, as in records written before lengths were stored
+    std::memset(buffer.get() + StringRecord::field_info[1].offset + SeriStruct::string_length_offset, 0, 4);
+
+    StringRecord record2{buffer.get(), record.size()};
+    REQUIRE(record2.str_field_1() == "Hello world"s);
+    REQUIRE(record2.str_field_2() == "Goodbye"s);
+}
+
+TEST_CASE("String fields read from damaged bytes stay inside the field", "[string][buffer]")
+{
+    const StringRecord record{true, "Hello world", "Goodbye", 1.0f};
+    auto buffer = std::make_unique<unsigned char[]>(record.size());
+    record.copy_to(buffer.get());
+    unsigned char *field_1 = buffer.get() + StringRecord::field_info[1].offset;
+    unsigned char *field_2 = buffer.get() + StringRecord::field_info[2].offset;
+    // a stored length past the end of the record
+    std::memset(field_1 + SeriStruct::string_length_offset, 0xFF, 4);
+    // no stored length and no NUL in the field
+    std::memset(field_2 + SeriStruct::string_length_offset, 0, 4);
+    std::memset(field_2 + SeriStruct::string_header_size, 'x', 1025);
+
+    const StringRecord::View view{buffer.get(), record.size()};
+    REQUIRE(view.str_field_1() == std::string_view{"Hello world\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 30});
+    REQUIRE(view.str_field_2() == std::string(1024, 'x'));
+    REQUIRE(view.float_field() == 1.0f);
+}
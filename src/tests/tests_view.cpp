@@ -0,0 +1,112 @@
+/**
+ * @file tests_view.cpp
+ * @brief Tests for zero-copy views over Record buffers. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ * 
+ */
+#include "SeriStruct.hpp"
+#include "catch.hpp"
+#include "GenRecordOne.gen.hpp"
+#include "GenRecordThree.gen.hpp"
+#include "GenRecordTwo.gen.hpp"
+#include "StringRecord.gen.hpp"
+#include <sstream>
+#include <string>
+
+using namespace Catch::literals;
+using namespace std::string_literals;
+
+TEST_CASE("View reads fields from a caller-owned buffer", "[view]")
+{
+    unsigned char RECORD_BYTES[] = {
+        0x05, 0x00, 0x00, 0x00,                         // uint_field
+        0xff, 0xff, 0xff, 0xff,                         // int_field
+        0x61, 0x01,                                     // char_field, bool_field
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00,             // padding
+        0xa5, 0x83, 0xf5, 0xff, 0xff, 0x69, 0xf8, 0x40, // dbl_field
+        0x00, 0x00, 0xc0, 0xbf,                         // float_field
+    };
+
+    GenRecordOne::View view{RECORD_BYTES, sizeof(RECORD_BYTES)};
+
+    REQUIRE(view.uint_field() == 5);
+    REQUIRE(view.int_field() == -1);
+    REQUIRE(view.char_field() == 'a');
+    REQUIRE(view.bool_field());
+    REQUIRE(view.dbl_field() == 99999.99999_a);
+    REQUIRE(view.float_field() == -1.5_a);
+    REQUIRE(view.size() == sizeof(RECORD_BYTES));
+
+    // the view does not copy, so changes to the buffer are visible
+    RECORD_BYTES[0] = 0x06;
+    REQUIRE(view.uint_field() == 6);
+    REQUIRE(view.data() == RECORD_BYTES);
+}
+
+TEST_CASE("View reads records at any alignment", "[view]")
+{
+    GenRecordOne record{7, -7, 'v', true, 0.125, 2.5f};
+    alignas(8) unsigned char bytes[GenRecordOne::buffer_size + 1];
+    record.copy_to(bytes + 1);
+
+    GenRecordOne::View view{bytes + 1, GenRecordOne::buffer_size};
+    REQUIRE(view.uint_field() == 7);
+    REQUIRE(view.int_field() == -7);
+    REQUIRE(view.dbl_field() == 0.125);
+    REQUIRE(view.float_field() == 2.5f);
+}
+
+TEST_CASE("View with incorrect size throws an exception", "[view]")
+{
+    unsigned char RECORD_BYTES[] = {
+        0x00,
+        0x00,
+        0x00,
+        0x00,
+    };
+
+    REQUIRE_THROWS_AS(GenRecordOne::View(RECORD_BYTES, sizeof(RECORD_BYTES)), SeriStruct::invalid_size);
+}
+
+TEST_CASE("View of a record and its strings", "[view][string]")
+{
+    StringRecord record{true, "Hello world"s, "What's in a name?"s, -99.99f};
+
+    auto buffer = new unsigned char[record.size()];
+    record.copy_to(buffer);
+
+    StringRecord::View view{buffer, record.size()};
+    REQUIRE(view.bool_field());
+    REQUIRE(view.str_field_1() == "Hello world"s);
+    REQUIRE(view.str_field_2() == "What's in a name?"s);
+    REQUIRE(view.float_field() == -99.99_a);
+
+    auto record_view = record.view();
+    REQUIRE(record_view.data() == record.data());
+    REQUIRE(record_view.str_field_1() == "Hello world"s);
+
+    delete[] buffer;
+}
+
+TEST_CASE("View of a forward compatible record", "[view][generated]")
+{
+    GenRecordThree record{1, -1, 'b', true, 0xdead, 0xbeef};
+
+    GenRecordTwo::View view{record.data(), record.size()};
+    REQUIRE(view.size() == record.size());
+    REQUIRE(view.uint_field() == record.uint_field());
+    REQUIRE(view.int_field() == record.int_field());
+    REQUIRE(view.char_field() == record.char_field());
+    REQUIRE(view.bool_field() == record.bool_field());
+
+    // writing a view preserves all of the viewed bytes
+    std::stringstream s;
+    s << view;
+    s.sync();
+    REQUIRE(static_cast<size_t>(s.tellp()) == record.size());
+    s.seekg(0);
+
+    GenRecordThree record2{s, record.size()};
+    REQUIRE(record2.uint_field_2() == 0xdead);
+    REQUIRE(record2.uint_field_3() == 0xbeef);
+}
@@ -0,0 +1,113 @@
+/**
+ * @file tests_vstr.cpp
+ * @brief Tests for variable-length string fields. ssgen.py should be run
+ * on GenRecords.txt before running these tests.
+ *
+ */
+#include "SeriStruct.hpp"
+#include "catch.hpp"
+#include "VarStringRecord.gen.hpp"
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+
+using namespace Catch::literals;
+using namespace std::string_literals;
+
+TEST_CASE("Variable-length strings follow the fixed layout", "[vstr]")
+{
+    STATIC_REQUIRE_FALSE(VarStringRecord::has_fixed_size);
+    const std::string description(5000, 'd');
+    VarStringRecord record{7, "widget", 2.5, description};
+
+    REQUIRE(record.id() == 7);
+    REQUIRE(record.name() == "widget"s);
+    REQUIRE(record.score() == 2.5_a);
+    REQUIRE(record.description() == description);
+    REQUIRE(record.size() == VarStringRecord::buffer_size + 6 + 5000);
+    // the text lives in the record's buffer, right after the fixed part
+    REQUIRE(reinterpret_cast<const unsigned char *>(record.name().data()) == record.data() + VarStringRecord::buffer_size);
+
+    const VarStringRecord empty{1, ""s, 0.0, ""s};
+    REQUIRE(empty.size() == VarStringRecord::buffer_size);
+    REQUIRE(empty.name().empty());
+    REQUIRE(empty.description().empty());
+}
+
+TEST_CASE("Variable-length strings are copied with the record", "[vstr]")
+{
+    const VarStringRecord record{42, "gadget", -1.0, "a description that is much longer than the name"s};
+
+    std::unique_ptr<unsigned char[]> bytes{new unsigned char[record.size()]};
+    record.copy_to(bytes.get());
+    const VarStringRecord::View view{bytes.get(), record.size()};
+    REQUIRE(view.id() == 42);
+    REQUIRE(view.name() == "gadget"s);
+    REQUIRE(view.description() == "a description that is much longer than the name"s);
+
+    const VarStringRecord copy{bytes.get(), record.size()};
+    REQUIRE(copy.description() == record.description());
+
+    std::stringstream stream;
+    stream << record;
+    REQUIRE(stream.str().size() == record.size());
+    const VarStringRecord read{stream, record.size()};
+    REQUIRE(read.name() == "gadget"s);
+    REQUIRE(read.score() == -1.0_a);
+
+    // a buffer shorter than the fixed part, or one that cuts off the text of the strings
+    REQUIRE_THROWS_AS((VarStringRecord::View{bytes.get(), VarStringRecord::buffer_size - 1}), SeriStruct::invalid_size);
+    REQUIRE_THROWS_AS((VarStringRecord::View{bytes.get(), VarStringRecord::buffer_size}), SeriStruct::invalid_size);
+    REQUIRE_THROWS_AS((VarStringRecord{bytes.get(), record.size() - 1}), SeriStruct::invalid_size);
+}
+
+TEST_CASE("Variable-length strings outside the record are rejected", "[vstr]")
+{
+    const VarStringRecord record{5, "name", 0.5, "description"s};
+    std::string bytes(record.size(), '\0');
+    record.copy_to(reinterpret_cast<unsigned char *>(&bytes[0]));
+    const auto set_slot = [&bytes](const uint32_t offset, const uint32_t length) {
+        // the slot of the name follows the 4-byte id
+        std::string damaged = bytes;
+        std::memcpy(&damaged[4], &offset, sizeof(offset));
+        std::memcpy(&damaged[8], &length, sizeof(length));
+        return damaged;
+    };
+    const auto view_of = [](const std::string &damaged) {
+        return VarStringRecord::View{reinterpret_cast<const unsigned char *>(damaged.data()), damaged.size()};
+    };
+
+    REQUIRE_NOTHROW(view_of(set_slot(VarStringRecord::buffer_size, 4)));
+    // text in the fixed part
+    REQUIRE_THROWS_AS(view_of(set_slot(0, 4)), SeriStruct::invalid_size);
+    // text past the end
+    REQUIRE_THROWS_AS(view_of(set_slot(VarStringRecord::buffer_size, 1000)), SeriStruct::invalid_size);
+    REQUIRE_THROWS_AS(view_of(set_slot(0xFFFFFFF0u, 0x20)), SeriStruct::invalid_size);
+
+    std::stringstream stream{set_slot(VarStringRecord::buffer_size + 10, 10)};
+    REQUIRE_THROWS_AS((VarStringRecord{stream, bytes.size()}), SeriStruct::invalid_size);
+}
+
+TEST_CASE("Setting a variable-length string resizes the record", "[vstr][mutable]")
+{
+    VarStringRecord record{3, "short", 1.0, "first"s};
+    record.name("a considerably longer name"s);
+    REQUIRE(record.name() == "a considerably longer name"s);
+    REQUIRE(record.description() == "first"s);
+    REQUIRE(record.size() == VarStringRecord::buffer_size + 26 + 5);
+
+    record.description(""s);
+    REQUIRE(record.description().empty());
+    REQUIRE(record.size() == VarStringRecord::buffer_size + 26);
+
+    // the value may point into the record itself
+    record.description(record.name());
+    REQUIRE(record.description() == "a considerably longer name"s);
+    REQUIRE(record.name() == "a considerably longer name"s);
+
+    // the layout is the same as a record constructed with the final values
+    const VarStringRecord expected{3, "a considerably longer name", 1.0, "a considerably longer name"s};
+    REQUIRE(record.size() == expected.size());
+    REQUIRE(std::memcmp(record.data(), expected.data(), record.size()) == 0);
+}